@@ -0,0 +1,78 @@
+/*
+ * @file	bench.h
+ * @brief	UART throughput/latency benchmark over a TX->RX loopback
+ * 			Measures polling, interrupt and DMA modes with the DWT cycle counter and
+ * 			prints one JSON object per line (diff two runs with Tools/bench_diff).
+ * 			The SPI suite compares 8-bit and 16-bit frame transfers (MOSI wired to MISO).
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_BENCH_H_
+#define INC_BENCH_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f4xx_hal.h"
+#include "uart.h"
+#include "spi.h"
+#include "dwt.h"
+
+#define BENCH_MAX_PAYLOAD		512U
+#define BENCH_BYTE_TIMEOUT_US	2000U	//Per-byte loopback timeout before a run is declared failed
+
+typedef enum{
+	BENCH_MODE_POLL,	//my_UART_Transmit + polled RXNE
+	BENCH_MODE_IRQ,		//UART_write/UART_read rings
+	BENCH_MODE_DMA		//UART_DMA_write + circular DMA RX
+}BENCH_Mode_t;
+
+typedef struct{
+	BENCH_Mode_t mode;
+	uint32_t baud;
+	uint16_t payload;
+	uint16_t received;		//Bytes looped back (== payload when the run passed)
+	uint16_t mismatches;	//Looped-back bytes that differ from what was sent
+	uint32_t apiCycles;		//Cycles spent inside the driver calls made by the producer
+	uint32_t latencyCycles;	//First byte queued -> last byte received
+	uint16_t cpuPermille;	//CPU busy during the transfer (1000 = fully busy)
+}BENCH_Result_t;
+
+/*
+ * Loopback port (TX wired to RX) and the port the JSON report goes out on
+ */
+typedef struct{
+	UART_Name_t port;
+	GPIO_Pin_t txPin;
+	GPIO_Pin_t rxPin;
+	GPIO_PortName_t gpioPort;
+}BENCH_UARTPins_t;
+
+typedef struct{
+	SPI_DFF_t frameSize;
+	uint32_t sckHz;
+	uint16_t payload;		//Bytes
+	uint16_t mismatches;	//Looped-back bytes that differ (only checked with MOSI wired to MISO)
+	uint32_t cycles;		//Whole transfer, NSS low to NSS high
+	uint32_t bytesPerSec;
+}BENCH_SPIResult_t;
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+bool BENCH_runUART(BENCH_UARTPins_t loopback, BENCH_Mode_t mode, uint32_t baud, uint16_t payload, BENCH_Result_t* result);
+void BENCH_printResult(const BENCH_Result_t* result);
+void BENCH_runUARTSuite(BENCH_UARTPins_t loopback);
+
+bool BENCH_runSPI(SPI_GPIO_Config_t config, SPI_DFF_t frameSize, SPI_BaudRate_t baudRate, uint16_t payload,
+				  bool loopback, BENCH_SPIResult_t* result);
+void BENCH_printSPIResult(const BENCH_SPIResult_t* result, bool loopback);
+void BENCH_runSPISuite(SPI_GPIO_Config_t config, bool loopback);
+
+#endif /* INC_BENCH_H_ */
@@ -0,0 +1,60 @@
+/*
+ * @file	bridge.h
+ * @brief	Zero-copy UART bridge between USART1, USART2 and USART6
+ *
+ * 			Every source port receives by DMA straight into a buffer from a shared pool.
+ * 			When the line goes idle (or the buffer is full) the buffer is queued, not copied,
+ * 			on the TX DMA of every destination port routed from that source; a reference
+ * 			count returns it to the pool once the last destination has sent it.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_BRIDGE_H_
+#define INC_BRIDGE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f4xx_hal.h"
+#include "uart.h"
+#include "dma.h"
+
+#define BRIDGE_BUFFER_SIZE	256U	//Bytes per pool buffer (max burst forwarded in one DMA transfer)
+#define BRIDGE_POOL_COUNT	24U		//Shared by all ports
+#define BRIDGE_TXQ_DEPTH	8U		//Buffers waiting per destination port, power of two
+
+#if (BRIDGE_TXQ_DEPTH & (BRIDGE_TXQ_DEPTH - 1U)) != 0U
+#error "BRIDGE_TXQ_DEPTH must be a power of two"
+#endif
+
+typedef struct{
+	uint32_t bytes;		//Bytes queued on the destination TX DMA
+	uint32_t buffers;	//Buffers queued on the destination TX DMA
+	uint32_t dropped;	//Buffers lost because the destination queue was full
+}BRIDGE_RouteStats_t;
+
+typedef struct{
+	uint16_t freeBuffers;
+	uint16_t minFreeBuffers;	//Low-water mark since BRIDGE_init()/BRIDGE_resetStats()
+	uint32_t rxDroppedBytes;	//Received bytes discarded because the pool was empty
+}BRIDGE_PoolStats_t;
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+void BRIDGE_init(void);
+bool BRIDGE_addRoute(UART_Name_t from, UART_Name_t to);
+void BRIDGE_start(void);
+void BRIDGE_stop(void);
+
+BRIDGE_RouteStats_t BRIDGE_getRouteStats(UART_Name_t from, UART_Name_t to);
+BRIDGE_PoolStats_t BRIDGE_getPoolStats(void);
+void BRIDGE_resetStats(void);
+
+#endif /* INC_BRIDGE_H_ */
@@ -0,0 +1,31 @@
+/*
+ * @file	crc.h
+ * @brief	STM32F411 hardware CRC calculation unit
+ * 			CRC-32 polynomial 0x04C11DB7, init 0xFFFFFFFF, 32-bit words, no reflection, no final XOR
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_CRC_H_
+#define INC_CRC_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f4xx_hal.h"
+#include "registerAddress.h"
+#include "rcc.h"
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+void CRC_init(void);
+void CRC_reset(void);
+uint32_t CRC_accumulateWords(const uint32_t* words, uint32_t count);
+uint32_t CRC_computeBytes(const uint8_t* data, uint32_t len);
+
+#endif /* INC_CRC_H_ */
@@ -0,0 +1,139 @@
+/*
+ * @file	dma.h
+ * @brief	DMA1/DMA2 stream helpers for STM32F411VET6
+ * 			Stream setup, start/stop and per-stream IRQ callback dispatch
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_DMA_H_
+#define INC_DMA_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "registerAddress.h"
+#include "exti.h"
+#include "rcc.h"
+
+#define DMA_STOP_TIMEOUT	0x1000U //Max polling loops while waiting for EN to read back 0
+
+/*
+ * ---------------------------------------------------
+ * Enumerations
+ * ---------------------------------------------------
+ */
+typedef enum{
+	my_DMA1,
+	my_DMA2,
+
+	my_DMA_COUNT
+}DMA_Name_t;
+
+typedef enum{
+	DMA_STREAM0,
+	DMA_STREAM1,
+	DMA_STREAM2,
+	DMA_STREAM3,
+	DMA_STREAM4,
+	DMA_STREAM5,
+	DMA_STREAM6,
+	DMA_STREAM7,
+
+	DMA_STREAM_COUNT
+}DMA_Stream_t;
+
+typedef enum{
+	DMA_PERIPH_TO_MEM = 0b00,
+	DMA_MEM_TO_PERIPH = 0b01,
+	DMA_MEM_TO_MEM = 0b10
+}DMA_Direction_t;
+
+typedef enum{
+	DMA_SIZE_8BITS = 0b00,
+	DMA_SIZE_16BITS = 0b01,
+	DMA_SIZE_32BITS = 0b10
+}DMA_DataSize_t;
+
+typedef enum{
+	my_DMA_PRIORITY_LOW = 0b00,
+	my_DMA_PRIORITY_MEDIUM = 0b01,
+	my_DMA_PRIORITY_HIGH = 0b10,
+	my_DMA_PRIORITY_VERY_HIGH = 0b11
+}DMA_Priority_t;
+
+/*
+ * Events handed to a stream callback (bit mask)
+ */
+typedef enum{
+	DMA_EVENT_HALF = 0x01,		//Half transfer (HTIF)
+	DMA_EVENT_COMPLETE = 0x02,	//Transfer complete (TCIF)
+	DMA_EVENT_ERROR = 0x04		//Transfer, direct-mode or FIFO error
+}DMA_Event_t;
+
+/*
+ * Raw per-stream flags, already shifted down to bit 0 (same layout for every stream)
+ */
+#define DMA_FLAG_FEIF	(1U << 0)
+#define DMA_FLAG_DMEIF	(1U << 2)
+#define DMA_FLAG_TEIF	(1U << 3)
+#define DMA_FLAG_HTIF	(1U << 4)
+#define DMA_FLAG_TCIF	(1U << 5)
+#define DMA_FLAG_ALL	(DMA_FLAG_FEIF | DMA_FLAG_DMEIF | DMA_FLAG_TEIF | DMA_FLAG_HTIF | DMA_FLAG_TCIF)
+
+typedef void (*DMA_Callback_t)(uint8_t events, void* context);
+
+/*
+ * @struct	DMA_Config_t
+ * @brief	Static description of one DMA stream/channel pairing
+ */
+typedef struct{
+	DMA_Name_t dma;
+	DMA_Stream_t stream;
+	uint8_t channel;			//CHSEL (0-7), see RM0383 DMA request mapping
+	DMA_Direction_t direction;
+	DMA_DataSize_t dataSize;	//Used for both peripheral and memory side
+	DMA_Priority_t priority;
+	bool memIncrement;
+	bool circular;
+	bool halfTransferIrq;
+}DMA_Config_t;
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+void DMA_streamInit(const DMA_Config_t* config, volatile void* periphAddr, DMA_Callback_t callback, void* context);
+void DMA_streamStart(DMA_Name_t dma, DMA_Stream_t stream, const volatile void* memAddr, uint16_t count);
+void DMA_streamStop(DMA_Name_t dma, DMA_Stream_t stream);
+bool DMA_streamIsEnabled(DMA_Name_t dma, DMA_Stream_t stream);
+uint16_t DMA_getRemaining(DMA_Name_t dma, DMA_Stream_t stream);
+
+uint8_t DMA_getFlags(DMA_Name_t dma, DMA_Stream_t stream);
+void DMA_clearFlags(DMA_Name_t dma, DMA_Stream_t stream, uint8_t flags);
+
+IRQn_Pos_t DMA_getIRQn(DMA_Name_t dma, DMA_Stream_t stream);
+
+void DMA1_Stream0_IRQHandler(void);
+void DMA1_Stream1_IRQHandler(void);
+void DMA1_Stream2_IRQHandler(void);
+void DMA1_Stream3_IRQHandler(void);
+void DMA1_Stream4_IRQHandler(void);
+void DMA1_Stream5_IRQHandler(void);
+void DMA1_Stream6_IRQHandler(void);
+void DMA1_Stream7_IRQHandler(void);
+
+void DMA2_Stream0_IRQHandler(void);
+void DMA2_Stream1_IRQHandler(void);
+void DMA2_Stream2_IRQHandler(void);
+void DMA2_Stream3_IRQHandler(void);
+void DMA2_Stream4_IRQHandler(void);
+void DMA2_Stream5_IRQHandler(void);
+void DMA2_Stream6_IRQHandler(void);
+void DMA2_Stream7_IRQHandler(void);
+
+#endif /* INC_DMA_H_ */
@@ -0,0 +1,61 @@
+/*
+ * @file	dwt.h
+ * @brief	Cortex-M4 DWT cycle counter helpers for timing measurements
+ * 			CYCCNT counts HCLK cycles and wraps every 2^32 cycles (~43s at 100MHz),
+ * 			so differences of two readings stay valid across one wrap.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_DWT_H_
+#define INC_DWT_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f4xx.h"
+#include "rcc.h"
+
+/*
+ * @brief	Enable trace and start CYCCNT if it is not already running
+ *
+ * 			CYCCNT is a shared time base: it is never written here, so modules already
+ * 			holding cycle stamps are not disturbed. Measure from your own DWT_getCycles() stamp.
+ *
+ * @return	true if the counter really advances (false under emulators without a DWT, e.g. QEMU)
+ */
+static inline bool DWT_init(void){
+	if((CoreDebug -> DEMCR & CoreDebug_DEMCR_TRCENA_Msk) == 0){
+		CoreDebug -> DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; //Trace must be on for the DWT to count
+	}
+	if((DWT -> CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0){
+		DWT -> CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+
+	uint32_t start = DWT -> CYCCNT;
+	for(volatile uint8_t i = 0; i < 8; i++);
+	return DWT -> CYCCNT != start;
+}
+
+static inline uint32_t DWT_getCycles(void){
+	return DWT -> CYCCNT;
+}
+
+/*
+ * @brief	Cycles elapsed since @p start (wrap-safe)
+ */
+static inline uint32_t DWT_elapsed(uint32_t start){
+	return DWT -> CYCCNT - start;
+}
+
+/*
+ * @brief	Convert a cycle count to microseconds using the live HCLK frequency
+ */
+static inline uint32_t DWT_cyclesToUs(uint32_t cycles){
+	uint32_t mhz = RCC_getHCLKFreq() / 1000000U;
+	return (mhz == 0) ? 0 : cycles / mhz;
+}
+
+#endif /* INC_DWT_H_ */
@@ -107,6 +107,12 @@ typedef enum{
 }EXTI_Trigger_t;
 
 
+/*
+ * Called from the EXTI IRQ after the pending bit of @p line has been cleared
+ */
+typedef void (*EXTI_Callback_t)(uint8_t line);
+
+
 /*
  * List of function declarations
  */
@@ -116,6 +122,18 @@ void NVIC_writeIPR(IRQn_Pos_t irqNumber, uint8_t priority);
 void writeEXTI(uint8_t bitPosition, EXTI_Mode_t mode, FlagStatus state);
 void EXTI_init(char bitPosition, EXTI_Trigger_t triggerMode, IRQn_Pos_t irqNumber);
 
+void EXTI_selectPort(uint8_t line, uint8_t port); //port: GPIO_PortName_t (exti.h is pulled in by gpio_write_read.h)
+IRQn_Pos_t EXTI_getIRQn(uint8_t line);
+void EXTI_setCallback(uint8_t line, EXTI_Callback_t callback);
+
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+void EXTI2_IRQHandler(void);
+void EXTI3_IRQHandler(void);
+void EXTI4_IRQHandler(void);
+void EXTI9_5_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+
 void vectorTableOffset(volatile uint32_t* vectorTableOffsetAddr);
 void user_IRQHandler(void (*functionCallBack)(void), uint32_t byteOffset);
 
@@ -14,12 +14,24 @@
 #include "gpio_write_read.h"
 #include "registerAddress.h"
 #include "rcc.h"
+#include "dma.h"
 
 
 #define GET_I2C1_REG(mode) (&(I2C1_REG -> mode))
 #define GET_I2C2_REG(mode) (&(I2C2_REG -> mode))
 #define GET_I2C3_REG(mode) (&(I2C3_REG -> mode))
 
+#define I2C_ANALOG_FILTER	true	//FLTR: keep the 50ns analog spike filter (ANOFF = 0)
+#define I2C_DIGITAL_FILTER	0U		//FLTR DNF: digital filter length in PCLK1 periods (0 = off, max 15)
+
+#define I2C_FLAG_TIMEOUT	0x10000U	//Max polling loops per bus event (~one byte at 100kHz is far below this)
+
+/*
+ * Sub-address auto-increment (LSM303DLHC and similar ST sensors): MSB of the register address set
+ * means the slave advances its register pointer after every byte of a multi-byte access
+ */
+#define I2C_SUBADDR_AUTO_INCREMENT	((uint8_t)0x80)
+
 /*
  * -----------------------------------------
  * Enumeration
@@ -65,6 +77,40 @@ typedef enum{
 	I2C_BUSY
 }I2C_Status_t;
 
+/*
+ * Raised from the I2Cx event/error IRQ once the transaction has ended
+ * status = I2C_OK, I2C_NACK (address or data refused), I2C_ERROR (bus error, lost arbitration, overrun)
+ * or I2C_TIMEOUT (ended by I2C_IT_abort)
+ */
+typedef void (*I2C_Callback_t)(I2C_Name_t i2cBus, I2C_Status_t status, void* context);
+
+
+/*
+ * Interrupt-driven register transaction
+ * 		START, <addr+W>, regAddr, txBuf[0..txLen-1]						(rxLen = 0)
+ * 		START, <addr+W>, regAddr, repeated START, <addr+R>, rxBuf[...]	(rxLen > 0, txLen = 0)
+ * 		then STOP. regAddr is sent as given; with autoIncrement it gets I2C_SUBADDR_AUTO_INCREMENT
+ * 		when more than one data byte follows. Only set it for slaves that use the register MSB that
+ * 		way (LSM303DLHC accelerometer); on others (its magnetometer, EEPROMs) bit 7 is address.
+ *
+ * With chainStart the STOP is replaced by a repeated START and the bus stays with this master:
+ * after an I2C_OK callback the next I2C_IT_start() (or I2C_readDMA()) sends its address straight
+ * away, and whoever set chainStart must otherwise call I2C_IT_release(). On any error a STOP goes
+ * out as usual and the next start begins from idle.
+ */
+typedef struct{
+	uint8_t slaveAddr;			//7-bit address
+	uint8_t regAddr;
+	const uint8_t* txBuf;
+	uint16_t txLen;
+	uint8_t* rxBuf;
+	uint16_t rxLen;
+	I2C_Callback_t callback;	//Called from the IRQ, may be NULL
+	void* context;
+	bool chainStart;			//End with a repeated START instead of STOP (see I2C_IT_release)
+	bool autoIncrement;			//OR I2C_SUBADDR_AUTO_INCREMENT into regAddr for multi-byte transfers
+}I2C_Transaction_t;
+
 typedef struct{
 	I2C_Name_t i2cBus;
 
@@ -82,11 +128,28 @@ typedef struct{
  */
 void writeI2C(uint8_t bitPosition, I2C_Name_t i2cBus, I2C_Mode_t mode, uint32_t value);
 uint32_t readI2C(uint8_t bitPosition, I2C_Name_t i2cBus, I2C_Mode_t mode);
-void I2C_basicConfigInit(I2C_GPIO_Config_t config,
-						 I2C_CCR_Mode_t ccrMode,
-						 uint32_t sclFreq,
-						 uint32_t sysClkFreq);
+uint32_t I2C_basicConfigInit(I2C_GPIO_Config_t config,
+							 I2C_CCR_Mode_t ccrMode,
+							 uint32_t sclFreq);
 I2C_Status_t I2C_singleByteRead(I2C_GPIO_Config_t config, uint8_t slaveAddr, uint8_t slaveRegAddr);
 I2C_Status_t I2C_singleByteWrite(I2C_GPIO_Config_t config, uint8_t slaveAddr, uint8_t slaveRegAddr, uint8_t value);
+I2C_Status_t I2C_burstRead(I2C_GPIO_Config_t config, uint8_t slaveAddr, uint8_t startRegAddr, uint8_t* buffer, uint16_t len);
+I2C_Status_t I2C_burstWrite(I2C_GPIO_Config_t config, uint8_t slaveAddr, uint8_t startRegAddr, const uint8_t* data, uint16_t len);
+
+bool I2C_IT_start(I2C_Name_t i2cBus, const I2C_Transaction_t* transaction);
+bool I2C_IT_busy(I2C_Name_t i2cBus);
+bool I2C_IT_stopPending(I2C_Name_t i2cBus);
+void I2C_IT_abort(I2C_Name_t i2cBus);
+void I2C_IT_release(I2C_Name_t i2cBus);
+
+bool I2C_readDMA(I2C_Name_t i2cBus, uint8_t slaveAddr, uint8_t regAddr, bool autoIncrement, uint8_t* rxBuf, uint16_t len,
+				 I2C_Callback_t callback, void* context);
+
+void I2C1_EV_IRQHandler(void);
+void I2C1_ER_IRQHandler(void);
+void I2C2_EV_IRQHandler(void);
+void I2C2_ER_IRQHandler(void);
+void I2C3_EV_IRQHandler(void);
+void I2C3_ER_IRQHandler(void);
 
 #endif /* INC_I2C_H_ */
@@ -0,0 +1,89 @@
+/*
+ * @file	i2c_sched.h
+ * @brief	Per-bus I2C transaction queue on top of the interrupt-driven master (I2C_IT_start)
+ * 			Requests carry a priority and an optional start deadline. The next one is launched
+ * 			from the completion callback of the previous, so the bus never waits on thread mode;
+ * 			while the previous STOP is still going out the launch is retried from a timer
+ * 			instead of spinning in the IRQ.
+ * 			consecutive requests to the same device are joined with a repeated START instead
+ * 			of STOP + START. Latency and bus load are tracked per device and per bus.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_I2C_SCHED_H_
+#define INC_I2C_SCHED_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f4xx_hal.h"
+#include "i2c.h"
+#include "dwt.h"
+#include "timer.h"
+
+#define I2C_SCHED_QUEUE_LEN		16U		//Requests waiting per bus
+#define I2C_SCHED_MAX_DEVICES	8U		//Slave addresses with statistics per bus
+#define I2C_SCHED_MAX_CHAIN		4U		//Repeated-START transactions in a row before the bus is let go
+#define I2C_SCHED_RETRY_HZ		200000U	//Launch retry while a STOP is pending (one timer IRQ every 5us)
+
+/*
+ * Longest deadlineUs accepted by I2C_SCHED_submit(). Deadlines are compared as signed CYCCNT
+ * differences, so they must stay under 2^31 cycles (~21s at 100MHz).
+ */
+#define I2C_SCHED_MAX_DEADLINE_US	10000000U
+
+/*
+ * Served HIGH first; inside one level the earliest deadline, then submission order
+ */
+typedef enum{
+	I2C_SCHED_PRIO_HIGH,
+	I2C_SCHED_PRIO_NORMAL,
+	I2C_SCHED_PRIO_LOW,
+
+	I2C_SCHED_PRIO_COUNT
+}I2C_SCHED_Priority_t;
+
+typedef struct{
+	I2C_Transaction_t transaction;	//As for I2C_IT_start(); chainStart is set by the scheduler
+	I2C_SCHED_Priority_t priority;
+	uint32_t deadlineUs;			//Latest start after submit, else dropped with I2C_TIMEOUT (0 = none, max I2C_SCHED_MAX_DEADLINE_US)
+}I2C_SCHED_Request_t;
+
+typedef struct{
+	uint8_t slaveAddr;
+	uint32_t completed;		//Ended with I2C_OK
+	uint32_t failed;		//Ended with NACK, bus error or abort
+	uint32_t expired;		//Dropped before starting, deadline passed
+	uint32_t late;			//Started past the deadline, already committed as a repeated-START successor
+	uint32_t waitMax;		//Submit -> start on the bus (cycles)
+	uint32_t latencyMin;	//Submit -> callback (cycles)
+	uint32_t latencyMax;
+	uint32_t latencyMean;
+}I2C_SCHED_DeviceStats_t;
+
+typedef struct{
+	uint32_t transactions;	//Started on the bus
+	uint32_t chained;		//Of those, started with a repeated START
+	uint32_t rejected;		//Submits refused: queue full, invalid request or deadline too long
+	uint8_t queuePeak;		//Most requests waiting at once
+	uint32_t busyCycles;	//Time with a transaction on the bus
+	uint32_t windowCycles;	//Time since I2C_SCHED_resetStats(); busyCycles / windowCycles = bus load
+}I2C_SCHED_BusStats_t;
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+void I2C_SCHED_init(TIM_Name_t retryTimer);
+bool I2C_SCHED_submit(I2C_Name_t i2cBus, const I2C_SCHED_Request_t* request);
+uint8_t I2C_SCHED_pending(I2C_Name_t i2cBus);
+I2C_SCHED_BusStats_t I2C_SCHED_getBusStats(I2C_Name_t i2cBus);
+bool I2C_SCHED_getDeviceStats(I2C_Name_t i2cBus, uint8_t slaveAddr, I2C_SCHED_DeviceStats_t* stats);
+void I2C_SCHED_resetStats(I2C_Name_t i2cBus);
+
+#endif /* INC_I2C_SCHED_H_ */
@@ -0,0 +1,43 @@
+/*
+ * @file	i2c_timing.h
+ * @brief	I2C master timing solver (RM0383 section 18.6: CR2 FREQ, CCR, TRISE, FLTR)
+ * 			Pure arithmetic on the PCLK1 frequency, no register access, so the same code
+ * 			runs in I2C_basicConfigInit() and in the host checks (Tools/host_sim).
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_I2C_TIMING_H_
+#define INC_I2C_TIMING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "i2c.h"
+
+#define I2C_TIMING_MIN_PCLK1_SM		2000000U	//FREQ >= 2MHz in standard mode
+#define I2C_TIMING_MIN_PCLK1_FM		4000000U	//FREQ >= 4MHz in fast mode
+#define I2C_TIMING_MAX_PCLK1		50000000U	//FREQ <= 50MHz
+#define I2C_TIMING_MAX_RISE_SM_NS	1000U		//I2C-bus spec tr(max), standard mode
+#define I2C_TIMING_MAX_RISE_FM_NS	300U		//I2C-bus spec tr(max), fast mode
+#define I2C_TIMING_MAX_DNF			15U
+
+/*
+ * Register values for one bus, all written with PE = 0
+ */
+typedef struct{
+	uint8_t freq;			//CR2 FREQ[5:0], PCLK1 in MHz
+	uint16_t ccr;			//CCR[11:0]
+	bool fastMode;			//CCR F/S
+	bool duty;				//CCR DUTY (fast mode: 0 = Tlow/Thigh 2, 1 = 16/9)
+	uint8_t trise;			//TRISE[5:0]
+	bool analogFilterOff;	//FLTR ANOFF
+	uint8_t digitalFilter;	//FLTR DNF[3:0], in PCLK1 periods
+	uint32_t sclFreq;		//Achieved SCL in Hz from Thigh + Tlow (bus rise/fall and filter delay not included)
+}I2C_Timing_t;
+
+I2C_Status_t I2C_computeTiming(uint32_t pclk1Freq, I2C_CCR_Mode_t mode, uint32_t sclFreq,
+							   bool analogFilter, uint8_t digitalFilter, I2C_Timing_t* timing);
+
+#endif /* INC_I2C_TIMING_H_ */
@@ -8,7 +8,11 @@
 #ifndef INC_L3GD20_H_
 #define INC_L3GD20_H_
 #include <stdint.h>
+#include <stdbool.h>
 #include "registerAddress.h"
+#include "spi.h"
+#include "exti.h"
+#include "dwt.h"
 
 #define WHO_AM_I		0x0F //Device ID register
 #define CTRL_REG1		0x20 //Power mode, data rate, bandwidth, axis enable
@@ -49,10 +53,26 @@
 
 
 
+/*
+ * SPI address byte
+ * bit 7 = 1 -> read, bit 6 = 1 -> auto-increment the address after every byte (multi-byte access)
+ */
+#define L3GD20_SPI_READ			((uint8_t)0x80)
+#define L3GD20_SPI_MULTIBYTE	((uint8_t)0x40)
+#define L3GD20_SPI_ADDR_MASK	((uint8_t)0x3F)
+
+#define L3GD20_BURST_READ_ADDR(reg)	((uint8_t)(((reg) & L3GD20_SPI_ADDR_MASK) | L3GD20_SPI_READ | L3GD20_SPI_MULTIBYTE))
+
+#define L3GD20_XYZ_BURST_LEN		6U //OUT_X_L..OUT_Z_H
+#define L3GD20_STATUS_XYZ_BURST_LEN	7U //STATUS_REG + OUT_X_L..OUT_Z_H, starting at STATUS_REG
+
+
+
 /*
  * WHO_AM_I (default: 1101 0100) (read only)
  */
 #define I_AM_L3GD20		((uint8_t)0xD4) //Default value
+#define I_AM_I3G4250D	((uint8_t)0xD3) //Pin-compatible successor fitted on newer discovery boards
 
 
 
@@ -287,10 +307,42 @@
 
 
 
+/*
+ * FIFO STREAM DRIVER
+ * The FIFO keeps up to 32 XYZ samples. INT2 raises the watermark flag, the EXTI handler drains
+ * the whole FIFO with one burst read and stores timestamped samples in a ring for the application.
+ */
+#define L3GD20_FIFO_DEPTH		32U
+#define L3GD20_SAMPLE_BYTES		6U		//X_L, X_H, Y_L, Y_H, Z_L, Z_H
+#define L3GD20_RING_SIZE		128U	//Samples, power of 2
+#define L3GD20_DRAIN_PASSES		3U		//Extra FIFO reads while INT2 stays high after a drain
+
+typedef struct{
+	int16_t x;
+	int16_t y;
+	int16_t z;
+	uint32_t timestamp;		//DWT cycles, back-dated from the drain time by the ODR period
+}L3GD20_Sample_t;
+
+typedef struct{
+	uint32_t samples;		//Samples pushed into the ring
+	uint32_t dropped;		//Samples lost because the ring was full
+	uint32_t drains;		//Burst reads (one per watermark interrupt unless INT2 stayed high)
+	uint32_t fifoOverruns;	//FIFO was full when drained, the sensor overwrote old samples
+}L3GD20_Stats_t;
+
+
+
 /*
  * FUNCTION DECLARATIONS
  */
-void L3GD20_Init();
+bool L3GD20_init(SPI_GPIO_Config_t config, uint8_t odrBandwidth, uint8_t fullScale);
+bool L3GD20_streamStart(uint8_t watermark, GPIO_Pin_t int2Pin, GPIO_PortName_t int2Port);
+void L3GD20_streamStop(void);
+
+uint16_t L3GD20_available(void);
+uint16_t L3GD20_read(L3GD20_Sample_t* samples, uint16_t maxSamples);
+L3GD20_Stats_t L3GD20_getStats(void);
 
 
 #endif /* INC_L3GD20_H_ */
@@ -0,0 +1,79 @@
+/*
+ * @file	log.h
+ * @brief	Deferred binary logging over UART
+ * 			Format strings live in the non-loaded .binlog_fmt section (never flashed),
+ * 			only {string ID, timestamp, raw 32-bit arguments} go on the wire.
+ * 			Tools/binlog_decode turns a captured stream back into text using the ELF.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_LOG_H_
+#define INC_LOG_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f4xx_hal.h"
+#include "uart.h"
+#include "dwt.h"
+
+/*
+ * Wire record (little-endian, 8 + 4*nargs bytes):
+ * 		[0]     LOG_SYNC_BYTE
+ * 		[1]     nargs (0..LOG_MAX_ARGS)
+ * 		[2..3]  string ID = address of the format string inside .binlog_fmt
+ * 		[4..7]  timestamp (LOG_timestamp(), DWT cycle counter by default)
+ * 		[8..]   nargs x uint32_t arguments
+ */
+#define LOG_SYNC_BYTE		0xA5U
+#define LOG_MAX_ARGS		8U
+#define LOG_HEADER_SIZE		8U
+#define LOG_RECORD_MAX		(LOG_HEADER_SIZE + 4U * LOG_MAX_ARGS)
+
+/*
+ * .binlog_fmt is an INFO section starting at address 0 in both linker scripts,
+ * so the address of a format string is directly its offset in the ELF section
+ */
+#define LOG_FMT_SECTION		__attribute__((section(".binlog_fmt"), used))
+
+/*
+ * @brief	Log a printf-style message without formatting it on the target
+ *
+ * 			Arguments must be integers (or pointers/floats wrapped in LOG_PTR()/LOG_F32()),
+ * 			each one is sent as a raw 32-bit word. %s is printed as an address by the decoder.
+ *
+ * 			LOG("adc=%u ch=%d", value, channel);
+ */
+#define LOG(fmt, ...)																	\
+	do{																					\
+		static const char LOG_FMT_SECTION logFmt_[] = fmt;								\
+		const uint32_t logArgs_[] = { 0U, ##__VA_ARGS__ };								\
+		_Static_assert(sizeof(logArgs_) / sizeof(logArgs_[0]) - 1U <= LOG_MAX_ARGS,		\
+					   "LOG: too many arguments");										\
+		LOG_write((uint16_t)(uintptr_t)logFmt_, &logArgs_[1],							\
+				  (uint8_t)(sizeof(logArgs_) / sizeof(logArgs_[0]) - 1U));				\
+	}while(0)
+
+#define LOG_PTR(p)	((uint32_t)(uintptr_t)(p))
+#define LOG_F32(f)	(((union{ float f_; uint32_t u_; }){ .f_ = (float)(f) }).u_)
+
+typedef struct{
+	uint32_t records;		//Records queued
+	uint32_t dropped;		//Records discarded because the UART TX ring was full
+}LOG_Stats_t;
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+void LOG_init(UART_Name_t UARTx);
+void LOG_write(uint16_t id, const uint32_t* args, uint8_t nargs);
+LOG_Stats_t LOG_getStats(void);
+uint32_t LOG_timestamp(void);
+
+#endif /* INC_LOG_H_ */
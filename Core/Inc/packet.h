@@ -0,0 +1,60 @@
+/*
+ * @file	packet.h
+ * @brief	COBS-framed packet link over UART DMA with hardware CRC32
+ *
+ * 			Raw packet:	[seq][type][payload 0..PACKET_MAX_PAYLOAD][crc32 LE]
+ * 			Wire frame:	COBS(raw packet) followed by a single 0x00 delimiter
+ *
+ * 			The CRC covers seq, type and payload and is computed by the CRC unit
+ * 			(see crc.h for the word packing rule). Tools/packet_ref is the host reference.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_PACKET_H_
+#define INC_PACKET_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "uart.h"
+#include "crc.h"
+#include "packet_cobs.h"
+
+typedef enum{
+	PACKET_OK,
+	PACKET_ERROR,		//Port not initialized / NULL payload
+	PACKET_BUSY,		//Not enough room in the DMA TX buffer right now, retry later
+	PACKET_TOO_LONG		//Payload above PACKET_MAX_PAYLOAD
+}PACKET_Status_t;
+
+/*
+ * Called from the UART/DMA IRQ for every packet that passed the CRC check.
+ * The payload pointer is only valid during the call.
+ */
+typedef void (*PACKET_RxCallback_t)(UART_Name_t UARTx, uint8_t type, uint8_t seq, const uint8_t* payload, uint16_t len);
+
+typedef struct{
+	uint32_t txPackets;
+	uint32_t txBusy;		//PACKET_send() calls refused for lack of buffer space
+	uint32_t rxPackets;
+	uint32_t crcErrors;
+	uint32_t framingErrors;	//Invalid COBS or frame shorter than the header + CRC
+	uint32_t overflows;		//Frames longer than PACKET_ENCODED_MAX (discarded)
+	uint32_t seqGaps;		//Packets missing according to the sequence number
+	uint32_t outOfOrder;	//Duplicate or reordered packets (seq behind the expected one), still delivered
+}PACKET_Stats_t;
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+void PACKET_init(UART_Name_t UARTx, PACKET_RxCallback_t callback);
+PACKET_Status_t PACKET_send(UART_Name_t UARTx, uint8_t type, const uint8_t* payload, uint16_t len);
+PACKET_Stats_t PACKET_getStats(UART_Name_t UARTx);
+
+#endif /* INC_PACKET_H_ */
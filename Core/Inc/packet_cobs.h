@@ -0,0 +1,37 @@
+/*
+ * @file	packet_cobs.h
+ * @brief	COBS codec and frame size limits of the packet link (packet.h)
+ * 			No hardware access, so Tools/packet_ref builds this same file on the host.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_PACKET_COBS_H_
+#define INC_PACKET_COBS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PACKET_MAX_PAYLOAD	250U
+#define PACKET_OVERHEAD		6U	//seq + type + crc32
+#define PACKET_RAW_MAX		(PACKET_MAX_PAYLOAD + PACKET_OVERHEAD)
+
+/*
+ * COBS adds one code byte per started 254-byte block, plus the 0x00 delimiter
+ */
+#define PACKET_COBS_MAX(rawLen)	((rawLen) + ((rawLen) / 254U) + 1U)
+#define PACKET_ENCODED_MAX		(PACKET_COBS_MAX(PACKET_RAW_MAX) + 1U)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint16_t PACKET_cobsEncode(const uint8_t* in, uint16_t len, uint8_t* out);
+bool PACKET_cobsDecode(const uint8_t* in, uint16_t len, uint8_t* out, uint16_t outCap, uint16_t* outLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PACKET_COBS_H_ */
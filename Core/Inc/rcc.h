@@ -34,6 +34,9 @@
 #define PLLRDY_TIMEOUT	0x4000U //Max pollong loops while waiting for the main PLL
 #define	SWS_TIMEOUT		0x4000U //Max polling loops while verifying SYSCLK switch
 
+#define HSI_CLK_FREQ	16000000U	//Internal RC oscillator
+#define HSE_CLK_FREQ	8000000U	//External crystal on the board (see RCC_init)
+
 #define GET_RCC_REG(mode) (&(RCC_REG -> mode)) //Obtain a pointer to an RCC register ftom 'RCC_Name_t'
 
 
@@ -98,6 +101,14 @@ void RCC_init(void);
 void writeRCC(uint8_t bitPosition, RCC_Mode_t mode, uint32_t value);
 uint32_t readRCC(uint8_t bitPosition, RCC_Mode_t mode);
 
+/*
+ * @brief	Decode the live clock tree (integer Hz)
+ */
+uint32_t RCC_getSysClkFreq(void);
+uint32_t RCC_getHCLKFreq(void);
+uint32_t RCC_getPCLK1Freq(void);
+uint32_t RCC_getPCLK2Freq(void);
+
 /*
  * ----------------------------------------
  * Peripheral Clock Control - TIM
@@ -210,6 +221,33 @@ void my_RCC_I2C3_CLK_DISABLE();
 void my_RCC_ADC1_CLK_ENABLE();
 void my_RCC_ADC1_CLK_DISABLE();
 
+/*
+ * ----------------------------------------
+ * Peripheral Clock Control - DMA
+ * ----------------------------------------
+ */
+void my_RCC_DMA1_CLK_ENABLE();
+void my_RCC_DMA1_CLK_DISABLE();
+
+void my_RCC_DMA2_CLK_ENABLE();
+void my_RCC_DMA2_CLK_DISABLE();
+
+/*
+ * ----------------------------------------
+ * Peripheral Clock Control - CRC
+ * ----------------------------------------
+ */
+void my_RCC_CRC_CLK_ENABLE();
+void my_RCC_CRC_CLK_DISABLE();
+
+/*
+ * ----------------------------------------
+ * Peripheral Clock Control - SYSCFG
+ * ----------------------------------------
+ */
+void my_RCC_SYSCFG_CLK_ENABLE();
+void my_RCC_SYSCFG_CLK_DISABLE();
+
 
 
 #endif /* INC_RCC_H_ */
@@ -61,6 +61,11 @@
  */
 #define EXTI_BASE_ADDR 0x40013C00UL
 
+/*
+ * SYSCFG base address (EXTI line to GPIO port routing)
+ */
+#define SYSCFG_BASE_ADDR 0x40013800UL
+
 /*
  * NVIC Registers (Cortex-M4 Ref Manual)
  */
@@ -94,8 +99,42 @@
  */
 #define ADC1_BASE_ADDR 0x40012000U
 #define ADC_COMMON_BASE_ADDR 0x40012300U
+
+/*
+ * DMA controllers
+ */
+#define DMA1_BASE_ADDR 0x40026000UL
+#define DMA2_BASE_ADDR 0x40026400UL
+
+/*
+ * CRC calculation unit
+ */
+#define CRC_BASE_ADDR 0x40023000UL
 ////////////END OF BASE ADDRESSES////////////
 
+/*
+ * Host build (Tools/host_sim, -DHOST_SIM)
+ * Peripheral (0x4000 0000 - 0x4007 FFFF) and Cortex-M system (0xE000 E000 - 0xE000 EFFF) addresses
+ * land in two byte arrays owned by the simulator at the same offsets as on the chip. The drivers
+ * report DR/SR/ODR/BSRR accesses through SIM_REG_READ/SIM_REG_WRITTEN so the simulator can model
+ * side effects (shift register, flags, pin edges). Both compile to nothing on the target.
+ */
+#ifdef HOST_SIM
+extern uint8_t hostSimPeriph[];
+extern uint8_t hostSimCore[];
+void HOST_SIM_regRead(volatile void* block, volatile uint32_t* reg);
+void HOST_SIM_regWritten(volatile void* block, volatile uint32_t* reg);
+
+#define REG_ADDR(addr)	(((addr) >= 0xE0000000UL) ? (uintptr_t)&hostSimCore[(addr) - 0xE000E000UL] \
+											  : (uintptr_t)&hostSimPeriph[(addr) - 0x40000000UL])
+#define SIM_REG_READ(block, reg)		HOST_SIM_regRead((block), (reg))
+#define SIM_REG_WRITTEN(block, reg)		HOST_SIM_regWritten((block), (reg))
+#else
+#define REG_ADDR(addr)	(addr)
+#define SIM_REG_READ(block, reg)		((void)0)
+#define SIM_REG_WRITTEN(block, reg)		((void)0)
+#endif
+
 
 /*
  * GPIO Registers Offsets
@@ -338,79 +377,138 @@ typedef struct {
 	volatile uint32_t ADC_CCR; //Offset:0x04
 	volatile uint32_t ADC_CDR; //Offset:0x08
 }ADC_Common_Register_Offset_t;
+
+/*
+ * DMA Stream Register Offsets (0x10 + 0x18 * stream)
+ */
+typedef struct{
+	volatile uint32_t DMA_SxCR;		//0x00 (Stream Config Reg)
+	volatile uint32_t DMA_SxNDTR;	//0x04 (Stream Number of Data Reg)
+	volatile uint32_t DMA_SxPAR;	//0x08 (Stream Peripheral Addr Reg)
+	volatile uint32_t DMA_SxM0AR;	//0x0C (Stream Memory 0 Addr Reg)
+	volatile uint32_t DMA_SxM1AR;	//0x10 (Stream Memory 1 Addr Reg)
+	volatile uint32_t DMA_SxFCR;	//0x14 (Stream FIFO Control Reg)
+}DMA_Stream_Register_Offset_t;
+
+/*
+ * DMA Controller Register Offsets
+ */
+typedef struct{
+	volatile uint32_t DMA_LISR;		//0x00 (Low Interrupt Status Reg, streams 0-3)
+	volatile uint32_t DMA_HISR;		//0x04 (High Interrupt Status Reg, streams 4-7)
+	volatile uint32_t DMA_LIFCR;	//0x08 (Low Interrupt Flag Clear Reg)
+	volatile uint32_t DMA_HIFCR;	//0x0C (High Interrupt Flag Clear Reg)
+	DMA_Stream_Register_Offset_t DMA_STREAM[8];	//0x10 (Stream 0 to 7)
+}DMA_Register_Offset_t;
+
+/*
+ * CRC Register Offsets
+ */
+typedef struct{
+	volatile uint32_t CRC_DR;		//0x00 (Data Reg: write to feed, read for the current CRC)
+	volatile uint32_t CRC_IDR;		//0x04 (Independent Data Reg, 8-bit scratch)
+	volatile uint32_t CRC_CR;		//0x08 (Control Reg, bit 0 RESET)
+}CRC_Register_Offset_t;
+
+/*
+ * SYSCFG Register Offsets
+ */
+typedef struct{
+	volatile uint32_t SYSCFG_MEMRMP;	//0x00 (Memory Remap Reg)
+	volatile uint32_t SYSCFG_PMC;		//0x04 (Peripheral Mode Config Reg)
+	volatile uint32_t SYSCFG_EXTICR[4];	//0x08 - 0x14 (EXTI Config Reg 1-4, 4 bits per line)
+	volatile uint32_t RESERVED0[2];
+	volatile uint32_t SYSCFG_CMPCR;		//0x20 (Compensation Cell Control Reg)
+}SYSCFG_Register_Offset_t;
 ////////////END OF REGISTER OFFSET STRUCTS////////////
 
 /*
  * GPIOs Reg Pointers
  */
-#define GPIOA_REG ((volatile GPIO_Register_Offset_t*)GPIOA_BASE_ADDR)
-#define GPIOB_REG ((volatile GPIO_Register_Offset_t*)GPIOB_BASE_ADDR)
-#define GPIOC_REG ((volatile GPIO_Register_Offset_t*)GPIOC_BASE_ADDR)
-#define GPIOD_REG ((volatile GPIO_Register_Offset_t*)GPIOD_BASE_ADDR)
-#define GPIOE_REG ((volatile GPIO_Register_Offset_t*)GPIOE_BASE_ADDR)
-#define GPIOH_REG ((volatile GPIO_Register_Offset_t*)GPIOH_BASE_ADDR)
+#define GPIOA_REG ((volatile GPIO_Register_Offset_t*)REG_ADDR(GPIOA_BASE_ADDR))
+#define GPIOB_REG ((volatile GPIO_Register_Offset_t*)REG_ADDR(GPIOB_BASE_ADDR))
+#define GPIOC_REG ((volatile GPIO_Register_Offset_t*)REG_ADDR(GPIOC_BASE_ADDR))
+#define GPIOD_REG ((volatile GPIO_Register_Offset_t*)REG_ADDR(GPIOD_BASE_ADDR))
+#define GPIOE_REG ((volatile GPIO_Register_Offset_t*)REG_ADDR(GPIOE_BASE_ADDR))
+#define GPIOH_REG ((volatile GPIO_Register_Offset_t*)REG_ADDR(GPIOH_BASE_ADDR))
 
 /*
  * EXTI Reg Pointers
  */
-#define EXTI_REG ((volatile EXTI_Register_Offset_t*)EXTI_BASE_ADDR)
+#define EXTI_REG ((volatile EXTI_Register_Offset_t*)REG_ADDR(EXTI_BASE_ADDR))
 
 /*
  * UART Reg Pointers
  */
-#define UART1_REG ((volatile UART_Register_Offset_t*)UART1_BASE_ADDR)
-#define UART2_REG ((volatile UART_Register_Offset_t*)UART2_BASE_ADDR)
-#define UART6_REG ((volatile UART_Register_Offset_t*)UART6_BASE_ADDR)
+#define UART1_REG ((volatile UART_Register_Offset_t*)REG_ADDR(UART1_BASE_ADDR))
+#define UART2_REG ((volatile UART_Register_Offset_t*)REG_ADDR(UART2_BASE_ADDR))
+#define UART6_REG ((volatile UART_Register_Offset_t*)REG_ADDR(UART6_BASE_ADDR))
 
 /*
  * I2C Reg Pointers
  */
-#define I2C1_REG ((volatile I2C_Register_Offset_t*)I2C1_BASE_ADDR)
-#define I2C2_REG ((volatile I2C_Register_Offset_t*)I2C2_BASE_ADDR)
-#define I2C3_REG ((volatile I2C_Register_Offset_t*)I2C3_BASE_ADDR)
+#define I2C1_REG ((volatile I2C_Register_Offset_t*)REG_ADDR(I2C1_BASE_ADDR))
+#define I2C2_REG ((volatile I2C_Register_Offset_t*)REG_ADDR(I2C2_BASE_ADDR))
+#define I2C3_REG ((volatile I2C_Register_Offset_t*)REG_ADDR(I2C3_BASE_ADDR))
 
 /*
  * SPI Reg Pointers
  */
-#define SPI1_REG ((volatile SPI_Register_Offset_t*)SPI1_BASE_ADDR)
-#define SPI2_REG ((volatile SPI_Register_Offset_t*)SPI2_BASE_ADDR)
-#define SPI3_REG ((volatile SPI_Register_Offset_t*)SPI3_BASE_ADDR)
-#define SPI4_REG ((volatile SPI_Register_Offset_t*)SPI4_BASE_ADDR)
-#define SPI5_REG ((volatile SPI_Register_Offset_t*)SPI5_BASE_ADDR)
+#define SPI1_REG ((volatile SPI_Register_Offset_t*)REG_ADDR(SPI1_BASE_ADDR))
+#define SPI2_REG ((volatile SPI_Register_Offset_t*)REG_ADDR(SPI2_BASE_ADDR))
+#define SPI3_REG ((volatile SPI_Register_Offset_t*)REG_ADDR(SPI3_BASE_ADDR))
+#define SPI4_REG ((volatile SPI_Register_Offset_t*)REG_ADDR(SPI4_BASE_ADDR))
+#define SPI5_REG ((volatile SPI_Register_Offset_t*)REG_ADDR(SPI5_BASE_ADDR))
 
 /*
  * TIMER1 Reg Pointers
  */
-#define TIM1_REG ((volatile TIM_Register_Offset_t*)TIM1_BASE_ADDR)
-#define TIM2_REG ((volatile TIM_Register_Offset_t*)TIM2_BASE_ADDR)
-#define TIM3_REG ((volatile TIM_Register_Offset_t*)TIM3_BASE_ADDR)
-#define TIM4_REG ((volatile TIM_Register_Offset_t*)TIM4_BASE_ADDR)
-#define TIM5_REG ((volatile TIM_Register_Offset_t*)TIM5_BASE_ADDR)
+#define TIM1_REG ((volatile TIM_Register_Offset_t*)REG_ADDR(TIM1_BASE_ADDR))
+#define TIM2_REG ((volatile TIM_Register_Offset_t*)REG_ADDR(TIM2_BASE_ADDR))
+#define TIM3_REG ((volatile TIM_Register_Offset_t*)REG_ADDR(TIM3_BASE_ADDR))
+#define TIM4_REG ((volatile TIM_Register_Offset_t*)REG_ADDR(TIM4_BASE_ADDR))
+#define TIM5_REG ((volatile TIM_Register_Offset_t*)REG_ADDR(TIM5_BASE_ADDR))
 
-#define TIM9_REG ((volatile TIM_Register_Offset_t*)TIM9_BASE_ADDR)
-#define TIM10_REG ((volatile TIM_Register_Offset_t*)TIM10_BASE_ADDR)
-#define TIM11_REG ((volatile TIM_Register_Offset_t*)TIM11_BASE_ADDR)
+#define TIM9_REG ((volatile TIM_Register_Offset_t*)REG_ADDR(TIM9_BASE_ADDR))
+#define TIM10_REG ((volatile TIM_Register_Offset_t*)REG_ADDR(TIM10_BASE_ADDR))
+#define TIM11_REG ((volatile TIM_Register_Offset_t*)REG_ADDR(TIM11_BASE_ADDR))
 
 /*
  * Flash Reg Pointers
  */
-#define FLASH_REG ((Flash_IntF_Register_Offset_t*) FLASH_INTF_REG_ADDR)
+#define FLASH_REG ((Flash_IntF_Register_Offset_t*) REG_ADDR(FLASH_INTF_REG_ADDR))
 
 /*
  * NVIC Reg Pointers
  */
-#define NVIC_REG ((volatile NVIC_t*) NVIC_BASE_ADDR)
+#define NVIC_REG ((volatile NVIC_t*) REG_ADDR(NVIC_BASE_ADDR))
 
 /*
  * RCC Reg Pointers
  */
-#define RCC_REG ((volatile RCC_Register_Offset_t*) RCC_BASE_ADDR)
+#define RCC_REG ((volatile RCC_Register_Offset_t*) REG_ADDR(RCC_BASE_ADDR))
 
 /*
  * ADC Reg Pointers
  */
-#define ADC_REG ((volatile ADC_Register_Offset_t*)ADC1_BASE_ADDR)
-#define ADC_COMMON_REG ((volatile ADC_Common_Register_Offset_t*)ADC_COMMON_BASE_ADDR)
+#define ADC_REG ((volatile ADC_Register_Offset_t*)REG_ADDR(ADC1_BASE_ADDR))
+#define ADC_COMMON_REG ((volatile ADC_Common_Register_Offset_t*)REG_ADDR(ADC_COMMON_BASE_ADDR))
+
+/*
+ * DMA Reg Pointers
+ */
+#define DMA1_REG ((volatile DMA_Register_Offset_t*)REG_ADDR(DMA1_BASE_ADDR))
+#define DMA2_REG ((volatile DMA_Register_Offset_t*)REG_ADDR(DMA2_BASE_ADDR))
+
+/*
+ * CRC Reg Pointers
+ */
+#define CRC_REG ((volatile CRC_Register_Offset_t*)REG_ADDR(CRC_BASE_ADDR))
+
+/*
+ * SYSCFG Reg Pointers
+ */
+#define SYSCFG_REG ((volatile SYSCFG_Register_Offset_t*)REG_ADDR(SYSCFG_BASE_ADDR))
 ////////////END OF REGISTER POINTERS////////////
 
 
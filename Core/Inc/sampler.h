@@ -0,0 +1,65 @@
+/*
+ * @file	sampler.h
+ * @brief	Timer-paced SPI sensor sampling
+ * 			A TIM2 - TIM5 update interrupt starts one SPI burst read per period on the DMA
+ * 			engine, so sample spacing no longer depends on what the main loop is doing.
+ * 			Every sample carries the DWT cycle count of the tick that started it, and the
+ * 			tick-to-tick spacing is tracked against the nominal period (min/max/mean jitter).
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_SAMPLER_H_
+#define INC_SAMPLER_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f4xx_hal.h"
+#include "spi.h"
+#include "timer.h"
+#include "dwt.h"
+
+#define SAMPLER_MAX_READ	15U		//Data bytes per burst read (after the command byte)
+#define SAMPLER_RING_SIZE	64U		//Samples buffered for the main loop, power of 2
+
+typedef struct{
+	uint32_t timestamp;		//DWT cycles at the timer tick that started the read
+	uint8_t data[SAMPLER_MAX_READ];
+}SAMPLER_Sample_t;
+
+typedef struct{
+	uint32_t ticks;			//Timer update events
+	uint32_t samples;		//Reads completed
+	uint32_t overruns;		//Ticks skipped because the previous read was still on the bus
+	uint32_t dropped;		//Completed reads lost to a full ring
+	uint32_t errors;		//Reads the DMA engine refused or aborted
+
+	uint32_t periodCycles;	//Nominal tick spacing in CPU cycles
+	int32_t jitterMin;		//Shortest spacing - nominal (cycles, <= 0 once measured)
+	int32_t jitterMax;		//Longest spacing - nominal (cycles, >= 0 once measured)
+	uint32_t jitterMean;	//Mean |spacing - nominal| (cycles)
+}SAMPLER_Stats_t;
+
+/*
+ * @brief	Optional per-sample hook, runs in the DMA IRQ right after the read completes
+ */
+typedef void (*SAMPLER_Callback_t)(const SAMPLER_Sample_t* sample, void* context);
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+uint32_t SAMPLER_start(SPI_GPIO_Config_t config, TIM_Name_t timer, uint32_t rateHz,
+					   uint8_t command, uint8_t len, SAMPLER_Callback_t callback, void* context);
+void SAMPLER_stop(void);
+uint16_t SAMPLER_available(void);
+uint16_t SAMPLER_read(SAMPLER_Sample_t* samples, uint16_t maxSamples);
+SAMPLER_Stats_t SAMPLER_getStats(void);
+void SAMPLER_resetStats(void);
+
+#endif /* INC_SAMPLER_H_ */
@@ -13,6 +13,17 @@
 #include "stm32f4xx_hal.h"
 #include "gpio_write_read.h"
 #include "registerAddress.h"
+#include "dma.h"
+#include "exti.h"
+
+
+/*
+ * Slave receiver sizes
+ * The circular buffer must hold at least two maximum frames (a frame may straddle the wrap)
+ */
+#define SPI_SLAVE_RX_BUFFER_SIZE	1024U
+#define SPI_SLAVE_MAX_FRAME			256U
+#define SPI_SLAVE_QUEUE_DEPTH		8U		//Frames, power of 2
 
 
 /*
@@ -73,6 +84,12 @@ typedef enum {
 }SPI_DFF_t; //Data frame format
 
 
+typedef enum{
+	SPI_PACK_BIG_ENDIAN,	//buf[0] = high byte of the first frame (same wire order as 8-bit frames)
+	SPI_PACK_LITTLE_ENDIAN	//buf holds native uint16_t words
+}SPI_PackOrder_t; //Byte packing for 16-bit frame transfers
+
+
 typedef struct{
 	SPI_Name_t SPIx;
 
@@ -90,6 +107,45 @@ typedef struct{
 }SPI_GPIO_Config_t;
 
 
+/*
+ * Raised when a DMA transfer has finished and NSS is high again
+ * ok = false when a DMA stream reported an error (received data is incomplete)
+ */
+typedef void (*SPI_TransferCallback_t)(SPI_Name_t SPIx, bool ok, void* context);
+
+
+/*
+ * Interrupt-driven transaction descriptor (8-bit frames)
+ */
+typedef struct{
+	const uint8_t* txBuf;				//NULL clocks out 0xFF
+	uint8_t* rxBuf;						//NULL discards the received bytes
+	uint16_t len;
+	GPIO_Pin_t nssPin;
+	GPIO_PortName_t nssPort;
+	SPI_TransferCallback_t callback;	//Called from the SPIx IRQ after NSS is released, may be NULL
+	void* context;
+}SPI_Transaction_t;
+
+
+/*
+ * Hardware CRC counters, per SPI peripheral
+ */
+typedef struct{
+	uint32_t transfers;		//CRC-protected transfers completed (polled and DMA)
+	uint32_t errors;		//Of those, transfers that ended with SR.CRCERR set
+}SPI_CRCStats_t;
+
+
+typedef struct{
+	uint32_t frames;		//Frames queued
+	uint32_t bytes;			//Payload bytes queued
+	uint32_t droppedFull;	//Frames lost because the application did not release slots in time
+	uint32_t oversize;		//Frames longer than SPI_SLAVE_MAX_FRAME (or than the ring), dropped
+	uint32_t dmaErrors;
+}SPI_SlaveStats_t;
+
+
 
 /*
  * Function Declarations
@@ -111,8 +167,55 @@ char SPI_readReceivedData(SPI_GPIO_Config_t config,
 						  char slaveDeviceAddr);
 
 void SPI_write2Device(SPI_GPIO_Config_t config, char slaveDeviceAddr, char writeValue);
+void SPI_burstRead(SPI_GPIO_Config_t config, uint8_t startAddr, uint8_t* buffer, uint16_t len);
+
+void SPI_transfer8(SPI_GPIO_Config_t config, const uint8_t* txBuf, uint8_t* rxBuf, uint16_t len);
+void SPI_transfer16(SPI_GPIO_Config_t config, const uint8_t* txBuf, uint8_t* rxBuf, uint16_t len, SPI_PackOrder_t order);
+
+/*
+ * Full-duplex DMA transfers (master, 8 or 16-bit frames following CR1.DFF)
+ */
+void SPI_DMA_init(SPI_GPIO_Config_t config);
+bool SPI_DMA_transfer(SPI_Name_t SPIx, const void* txBuf, void* rxBuf, uint16_t len,
+					  SPI_TransferCallback_t callback, void* context);
+void SPI_DMA_setChipSelect(SPI_Name_t SPIx, GPIO_Pin_t nssPin, GPIO_PortName_t nssPort);
+bool SPI_DMA_busy(SPI_Name_t SPIx);
+
+/*
+ * Hardware CRC (CRC8 with 8-bit frames, CRC16 with 16-bit frames). While enabled, every polled
+ * SPI_transferCRC() and every SPI_DMA_transfer() restarts the CRC, appends it after the last
+ * data frame and checks the one received from the peer.
+ */
+bool SPI_CRC_enable(SPI_Name_t SPIx, uint16_t polynomial);
+void SPI_CRC_disable(SPI_Name_t SPIx);
+bool SPI_transferCRC(SPI_GPIO_Config_t config, const void* txBuf, void* rxBuf, uint16_t len);
+SPI_CRCStats_t SPI_CRC_getStats(SPI_Name_t SPIx);
 
 uint16_t readSPI(uint8_t bitPosition, SPI_Name_t userSPIx, SPI_Mode_t mode);
 void writeSPI(uint8_t bitPosition, SPI_Name_t userSPIx, SPI_Mode_t mode, uint32_t value);
 
+/*
+ * Interrupt-driven transfers (short transactions, main loop keeps running)
+ */
+bool SPI_IT_start(SPI_Name_t SPIx, const SPI_Transaction_t* transaction);
+bool SPI_IT_busy(SPI_Name_t SPIx);
+
+/*
+ * Slave mode: circular DMA receive, frames delimited by hardware NSS (one instance)
+ */
+bool SPI_slaveRxInit(SPI_GPIO_Config_t config);
+void SPI_slaveRxStop(void);
+const uint8_t* SPI_slavePeekFrame(uint16_t* len);
+void SPI_slaveReleaseFrame(void);
+SPI_SlaveStats_t SPI_slaveGetStats(void);
+
+void SPI1_IRQHandler(void);
+void SPI2_IRQHandler(void);
+void SPI3_IRQHandler(void);
+void SPI4_IRQHandler(void);
+void SPI5_IRQHandler(void);
+
+void SPI_writeRegister(SPI_Name_t SPIx, SPI_Mode_t mode, uint32_t value);
+uint32_t SPI_readRegister(SPI_Name_t SPIx, SPI_Mode_t mode);
+
 #endif /* INC_SPI_H_ */
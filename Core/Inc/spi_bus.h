@@ -0,0 +1,81 @@
+/*
+ * @file	spi_bus.h
+ * @brief	Shared SPI bus manager: several chip selects on one SPI peripheral
+ * 			Every device keeps its own clock prescaler, CPOL/CPHA and frame size. Transactions
+ * 			from any context are queued and run back to back on the DMA engine; CR1 is only
+ * 			rewritten when the next device needs different settings than the current one.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef INC_SPI_BUS_H_
+#define INC_SPI_BUS_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f4xx_hal.h"
+#include "spi.h"
+
+#define SPI_BUS_MAX_DEVICES		8U
+#define SPI_BUS_QUEUE_DEPTH		8U	//Pending transactions per bus, power of 2
+
+/*
+ * Clock polarity / phase (CR1 CPOL = bit 1, CPHA = bit 0)
+ */
+typedef enum{
+	SPI_CLOCK_MODE0 = 0b00,	//CPOL 0, CPHA 0
+	SPI_CLOCK_MODE1 = 0b01,	//CPOL 0, CPHA 1
+	SPI_CLOCK_MODE2 = 0b10,	//CPOL 1, CPHA 0
+	SPI_CLOCK_MODE3 = 0b11	//CPOL 1, CPHA 1 (L3GD20)
+}SPI_ClockMode_t;
+
+/*
+ * Static description of one device on the bus
+ */
+typedef struct{
+	GPIO_Pin_t nssPin;
+	GPIO_PortName_t nssPort;
+	SPI_BaudRate_t baudRate;
+	SPI_ClockMode_t clockMode;
+	SPI_DFF_t frameSize;
+}SPI_BusDevice_t;
+
+/*
+ * One queued transfer. Buffers are uint8_t or uint16_t frames depending on the device
+ * frame size and must stay valid until the callback.
+ */
+typedef struct{
+	int8_t device;					//Handle returned by SPI_BUS_addDevice()
+	const void* txBuf;				//NULL clocks out all ones
+	void* rxBuf;					//NULL discards the received frames
+	uint16_t len;					//Frames
+	SPI_TransferCallback_t callback;	//From the DMA IRQ, may be NULL
+	void* context;
+}SPI_BusTransaction_t;
+
+typedef struct{
+	uint32_t transactions;		//Completed transfers
+	uint32_t errors;			//Transfers that ended with a DMA error
+	uint32_t cr1Writes;			//Device switches that needed a new CR1 image
+	uint32_t cr1Skipped;		//Transfers that reused the current CR1 as is
+	uint32_t queueFull;			//SPI_BUS_submit() calls rejected
+	uint8_t queueHighWater;
+}SPI_BusStats_t;
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+bool SPI_BUS_init(SPI_GPIO_Config_t pins);
+int8_t SPI_BUS_addDevice(SPI_Name_t SPIx, const SPI_BusDevice_t* device);
+bool SPI_BUS_submit(SPI_Name_t SPIx, const SPI_BusTransaction_t* transaction);
+bool SPI_BUS_idle(SPI_Name_t SPIx);
+SPI_BusStats_t SPI_BUS_getStats(SPI_Name_t SPIx);
+void SPI_BUS_resetStats(SPI_Name_t SPIx);
+
+#endif /* INC_SPI_BUS_H_ */
@@ -112,6 +112,11 @@ typedef struct{
 	uint32_t actualHz;	//Achieved frequency
 }TIM_Cal_t;
 
+/*
+ * @brief	Update event hook for TIM_startPeriodic(), runs in the timer IRQ
+ */
+typedef void (*TIM_UpdateCallback_t)(TIM_Name_t userTIMx);
+
 
 /*
  * --------------------------------------------------------
@@ -123,6 +128,16 @@ void delay(int msec);
 
 void TIM1_UP_TIM10_IRQHandler();
 
+TIM_Cal_t timerCalculation(uint32_t sysClkFreq, uint32_t targetHz, uint32_t maxArr);
+uint32_t TIM_getAPB1TimerClock(void);
+uint32_t TIM_startPeriodic(TIM_Name_t userTIMx, uint32_t rateHz, TIM_UpdateCallback_t callback);
+void TIM_stopPeriodic(TIM_Name_t userTIMx);
+
+void TIM2_IRQHandler(void);
+void TIM3_IRQHandler(void);
+void TIM4_IRQHandler(void);
+void TIM5_IRQHandler(void);
+
 void writeTimer(uint8_t bitPosition, TIM_Name_t userTIMx, TIM_Mode_t mode, uint32_t value);
 
 uint32_t readTimer (uint8_t bitPosiion, TIM_Name_t userTIMx, TIM_Mode_t mode);
@@ -10,13 +10,40 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <math.h>
 
 #include "stm32f4xx_hal.h"
 #include "gpio_write_read.h"
 #include "registerAddress.h"
+#include "exti.h"
+#include "dma.h"
+#include "rcc.h"
+#include "dwt.h"
 
 
+/*
+ * Interrupt-driven ring buffer sizes (per UART port)
+ * Both sizes must be a power of two so the index wrap is a single AND mask
+ */
+#define UART_TX_RING_SIZE	256U
+#define UART_RX_RING_SIZE	256U
+
+/*
+ * DMA transmit ping-pong buffer size (per buffer, two buffers per UART port)
+ */
+#define UART_DMA_TX_BUFFER_SIZE	1024U
+
+/*
+ * DMA circular receive buffer size (per UART port)
+ * Half/full-transfer events fire every UART_DMA_RX_BUFFER_SIZE/2 bytes during long bursts
+ */
+#define UART_DMA_RX_BUFFER_SIZE	512U
+
+#if ((UART_TX_RING_SIZE & (UART_TX_RING_SIZE - 1U)) != 0U) || ((UART_RX_RING_SIZE & (UART_RX_RING_SIZE - 1U)) != 0U)
+#error "UART ring buffer sizes must be a power of two"
+#endif
+
 /*
  * Collections of UART Offset Register Name
  */
@@ -48,6 +75,85 @@ typedef enum{
 	WORDLENGTH_9B
 }UART_WordLength_t;
 
+/*
+ * @struct	UART_BaudCal_t
+ * @brief	Result of the integer BRR computation
+ */
+typedef struct{
+	uint32_t pclkFreq;		//Peripheral clock feeding the USART (Hz)
+	uint32_t targetBaud;	//Requested baud rate
+	uint32_t actualBaud;	//Baud rate produced by the programmed BRR
+	int32_t errorPpm;		//(actual - target) / target, in parts per million
+	uint16_t brr;			//Value written to USART_BRR
+	bool over8;				//true = 8x oversampling (CR1.OVER8 = 1)
+	bool valid;				//false if the target cannot be reached from pclkFreq
+}UART_BaudCal_t;
+
+/*
+ * Single-producer / single-consumer byte ring
+ * 		head: next free slot (written by the producer only)
+ * 		tail: next byte to consume (written by the consumer only)
+ * Indices run freely and are masked on access, so (head - tail) is always the fill level
+ */
+typedef struct{
+	uint8_t* buffer;
+	uint16_t mask;
+	volatile uint16_t head;
+	volatile uint16_t tail;
+}UART_RingBuffer_t;
+
+/*
+ * Hardware flow control lines (bit mask)
+ */
+typedef enum{
+	UART_FLOW_NONE = 0x0,
+	UART_FLOW_RTS = 0x1,		//We drive nRTS high when our receive register is full
+	UART_FLOW_CTS = 0x2,		//The USART holds transmission while the peer drives nCTS high
+	UART_FLOW_RTS_CTS = 0x3
+}UART_FlowControl_t;
+
+/*
+ * Called from the USART IRQ when the peer pauses (nCTS high) or resumes the stream
+ */
+typedef void (*UART_StreamCallback_t)(UART_Name_t UARTx, bool paused);
+
+typedef struct{
+	uint32_t pauseCount;	//nCTS high transitions since UART_streamInit()
+	uint32_t pausedUs;		//Total time spent paused (wraps after ~71 min)
+	bool paused;
+}UART_StreamStats_t;
+
+/*
+ * What the stdout retarget does when the TX ring cannot take the whole printf() output
+ */
+typedef enum{
+	UART_RETARGET_DROP,		//Queue what fits and discard the rest (never stalls the caller)
+	UART_RETARGET_BLOCK		//Wait for the ISR to drain the ring (falls back to DROP inside IRQs)
+}UART_RetargetPolicy_t;
+
+typedef struct{
+	uint32_t droppedBytes;	//Bytes discarded because the ring was full or printf() ran in an IRQ
+	uint16_t highWater;		//Highest TX ring fill level seen right after a write
+}UART_RetargetStats_t;
+
+/*
+ * Called from the DMA stream IRQ each time a ping-pong buffer has been handed to the USART
+ */
+typedef void (*UART_TxCompleteCallback_t)(UART_Name_t UARTx);
+
+/*
+ * Called with consecutive chunks of received data straight out of the circular DMA buffer.
+ * A frame is every chunk up to and including the one flagged with frameEnd (IDLE line seen).
+ * A frame that wraps around the buffer end arrives as two chunks; a frameEnd chunk may have len == 0.
+ * The data pointer is only valid during the call.
+ */
+typedef void (*UART_RxFrameCallback_t)(UART_Name_t UARTx, const uint8_t* data, uint16_t len, bool frameEnd);
+
+/*
+ * Called from the USART IRQ when the RX line goes idle (see UART_setIdleCallback)
+ */
+typedef void (*UART_IdleCallback_t)(UART_Name_t UARTx);
+
 
 
 /*
@@ -61,12 +167,72 @@ void UART_Init(GPIO_Pin_t TXPin,
 			   GPIO_Pin_t RXPin,
 			   GPIO_PortName_t portName,
 			   UART_Name_t UARTx,
-			   uint16_t baudRate,
+			   uint32_t baudRate,
 			   UART_Parity_t parity,
 			   UART_WordLength_t wordLength);
 
+bool UART_calculateBRR(uint32_t pclkFreq, uint32_t baudRate, UART_BaudCal_t* result);
+UART_BaudCal_t UART_getBaudInfo(UART_Name_t UARTx);
+
 char my_UART_Receive(UART_Name_t UARTx);
 
 void my_UART_Transmit(UART_Name_t UARTx, uint8_t inputData);
 
+/*
+ * Interrupt-driven (non-blocking) mode
+ */
+void UART_interruptInit(UART_Name_t UARTx);
+uint16_t UART_write(UART_Name_t UARTx, const uint8_t* buf, uint16_t len);
+uint16_t UART_read(UART_Name_t UARTx, uint8_t* buf, uint16_t len);
+uint16_t UART_txPending(UART_Name_t UARTx);
+uint16_t UART_rxAvailable(UART_Name_t UARTx);
+uint32_t UART_getRxOverrunCount(UART_Name_t UARTx);
+
+/*
+ * stdout/stderr retarget (used by _write in syscalls.c)
+ */
+void UART_retargetInit(UART_Name_t UARTx, UART_RetargetPolicy_t policy);
+int UART_retargetWrite(const char* ptr, int len);
+UART_RetargetStats_t UART_retargetGetStats(void);
+uint16_t UART_retargetGetPending(void);
+void UART_retargetResetStats(void);
+
+/*
+ * DMA transmit mode (double-buffered)
+ */
+void UART_DMA_txInit(UART_Name_t UARTx, UART_TxCompleteCallback_t callback);
+uint16_t UART_DMA_write(UART_Name_t UARTx, const uint8_t* buf, uint16_t len);
+uint8_t* UART_DMA_getTxBuffer(UART_Name_t UARTx, uint16_t* space);
+void UART_DMA_commitTx(UART_Name_t UARTx, uint16_t len);
+bool UART_DMA_txBusy(UART_Name_t UARTx);
+uint16_t UART_DMA_txSpace(UART_Name_t UARTx);
+
+/*
+ * RTS/CTS hardware flow control and back-pressure aware streaming (DMA TX)
+ */
+bool UART_flowControlInit(UART_Name_t UARTx, UART_FlowControl_t flow, GPIO_Pin_t ctsPin, GPIO_Pin_t rtsPin, GPIO_PortName_t portName);
+void UART_streamInit(UART_Name_t UARTx, UART_StreamCallback_t callback);
+uint16_t UART_streamWrite(UART_Name_t UARTx, const uint8_t* buf, uint16_t len);
+uint16_t UART_streamWritable(UART_Name_t UARTx);
+bool UART_streamPaused(UART_Name_t UARTx);
+UART_StreamStats_t UART_streamGetStats(UART_Name_t UARTx);
+
+/*
+ * DMA receive mode (circular buffer + IDLE line frame detection)
+ */
+void UART_DMA_rxInit(UART_Name_t UARTx, UART_RxFrameCallback_t callback);
+void UART_DMA_rxStop(UART_Name_t UARTx);
+
+/*
+ * Raw DMA access for modules that bring their own buffers
+ */
+const DMA_Config_t* UART_DMA_getTxConfig(UART_Name_t UARTx);
+const DMA_Config_t* UART_DMA_getRxConfig(UART_Name_t UARTx);
+volatile uint32_t* UART_getDataRegister(UART_Name_t UARTx);
+void UART_setIdleCallback(UART_Name_t UARTx, UART_IdleCallback_t callback);
+
+void USART1_IRQHandler(void);
+void USART2_IRQHandler(void);
+void USART6_IRQHandler(void);
+
 #endif /* INC_UART_H_ */
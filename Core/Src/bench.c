@@ -0,0 +1,399 @@
+/*
+ * @file	bench.c
+ * @brief	UART throughput/latency benchmark over a TX->RX loopback
+ *
+ * 			Wire the TX pin of the port under test to its own RX pin. Every run sends a
+ * 			known pattern, checks what comes back and records:
+ * 				apiCycles		cycles spent inside the driver calls made by the producer
+ * 				latencyCycles	first byte queued -> last byte received
+ * 				cpuPermille		CPU busy share, estimated from how many idle-loop iterations
+ * 								were lost compared to a calibrated idle loop
+ *
+ * 			Under QEMU the DWT does not count: runs still check the data path, timeouts fall
+ * 			back to loop counts and every line carries "cycles_valid":false so the host diff
+ * 			ignores the timing columns.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "bench.h"
+
+#define BENCH_IDLE_CALIBRATION	4096U
+#define BENCH_FALLBACK_LOOPS	200000U	//Per-byte loop budget when the DWT is not available
+
+/*
+ * ------------------------------------------------------------
+ * Globals
+ * ------------------------------------------------------------
+ */
+static uint8_t benchTx[BENCH_MAX_PAYLOAD];
+static uint8_t benchRx[64];
+static uint8_t benchSpiRx[BENCH_MAX_PAYLOAD];
+
+static volatile uint16_t benchRxCount;
+static volatile uint16_t benchMismatches;
+static volatile uint32_t benchLastRxCycle;
+static uint16_t benchExpected;
+
+static bool benchCyclesValid;
+static uint32_t benchIdleCost16;	//Cycles per idle-loop iteration, x16
+
+static const char* const BENCH_MODE_NAME[] = {
+		[BENCH_MODE_POLL] = "poll",
+		[BENCH_MODE_IRQ] = "irq",
+		[BENCH_MODE_DMA] = "dma",
+};
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Compare looped-back bytes with the pattern, from thread mode or the DMA RX callback
+ */
+static void BENCH_checkRx(const uint8_t* data, uint16_t len){
+	for(uint16_t i = 0; i < len; i++){
+		uint16_t idx = benchRxCount;
+		if(idx >= benchExpected) return; //Stray bytes after the run
+		if(data[i] != benchTx[idx]) benchMismatches++;
+		benchRxCount = (uint16_t)(idx + 1U);
+	}
+	benchLastRxCycle = DWT_getCycles();
+}
+
+
+static void BENCH_dmaRxCallback(UART_Name_t UARTx, const uint8_t* data, uint16_t len, bool frameEnd){
+	(void)UARTx;
+	(void)frameEnd;
+	BENCH_checkRx(data, len);
+}
+
+
+/*
+ * @brief	true once the run has used up its time budget
+ */
+static bool BENCH_timedOut(uint32_t start, uint32_t limitCycles, uint32_t loops, uint32_t limitLoops){
+	if(benchCyclesValid) return DWT_elapsed(start) > limitCycles;
+	return loops > limitLoops;
+}
+
+
+/*
+ * @brief	Idle loop with the same shape as the waiting loops below, used as the 0% CPU reference
+ */
+static void BENCH_calibrateIdle(void){
+	uint32_t idle = 0;
+	uint32_t loops = 0;
+
+	benchExpected = 1;
+	benchRxCount = 0;
+	uint32_t start = DWT_getCycles();
+	while(benchRxCount < benchExpected){
+		if(BENCH_timedOut(start, 0xFFFFFFFFU, ++loops, 0xFFFFFFFFU) || idle >= BENCH_IDLE_CALIBRATION) break;
+		idle++;
+	}
+	benchIdleCost16 = (DWT_elapsed(start) * 16U) / BENCH_IDLE_CALIBRATION;
+}
+
+
+/*
+ * @brief	Put the port back into plain polling mode between runs
+ */
+static void BENCH_resetPort(UART_Name_t port){
+	UART_DMA_rxStop(port);
+	writeUART(7, port, CR3, 0); //DMAT off
+	const DMA_Config_t* txCfg = UART_DMA_getTxConfig(port);
+	if(txCfg != NULL) DMA_streamStop(txCfg -> dma, txCfg -> stream);
+
+	writeUART(5, port, CR1, 0); //RXNEIE off
+	writeUART(7, port, CR1, 0); //TXEIE off
+	(void)readUART(0, port, DR); //Flush a stale byte / clear ORE
+}
+
+
+static uint16_t BENCH_cpuPermille(uint32_t elapsed, uint32_t idleLoops){
+	if(!benchCyclesValid || elapsed == 0) return 1000;
+	uint64_t idleCycles = ((uint64_t)idleLoops * benchIdleCost16) / 16U;
+	if(idleCycles >= elapsed) return 0;
+	return (uint16_t)(((uint64_t)(elapsed - idleCycles) * 1000U) / elapsed);
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	One benchmark run
+ *
+ * @param	loopback	Port under test, TX wired to RX
+ * @param	payload		1..BENCH_MAX_PAYLOAD bytes
+ * @param	result		Filled even when the run fails
+ *
+ * @return	true if every byte came back unchanged before the timeout
+ */
+bool BENCH_runUART(BENCH_UARTPins_t loopback, BENCH_Mode_t mode, uint32_t baud, uint16_t payload, BENCH_Result_t* result){
+	if(result == NULL || payload == 0 || payload > BENCH_MAX_PAYLOAD) return false;
+	UART_Name_t port = loopback.port;
+
+	*result = (BENCH_Result_t){ .mode = mode, .baud = baud, .payload = payload };
+
+	for(uint16_t i = 0; i < payload; i++) benchTx[i] = (uint8_t)(i * 7U + 1U); //Walks through every byte value
+
+	BENCH_resetPort(port);
+	UART_Init(loopback.txPin, loopback.rxPin, loopback.gpioPort, port, baud, PARITY_NONE, WORDLENGTH_8B);
+	(void)readUART(0, port, DR);
+
+	//10 bits per byte on the wire, plus the per-byte timeout budget
+	uint32_t limitCycles = (uint32_t)(((uint64_t)RCC_getHCLKFreq() * payload * 10U) / baud) +
+						   (uint32_t)payload * BENCH_BYTE_TIMEOUT_US * (RCC_getHCLKFreq() / 1000000U);
+	uint32_t limitLoops = (uint32_t)payload * BENCH_FALLBACK_LOOPS;
+
+	benchExpected = payload;
+	benchRxCount = 0;
+	benchMismatches = 0;
+
+	uint32_t idle = 0;
+	uint32_t loops = 0;
+	uint32_t start = DWT_getCycles();
+	benchLastRxCycle = start;
+
+	switch(mode){
+		case BENCH_MODE_POLL:
+			for(uint16_t i = 0; i < payload; i++){
+				uint32_t t0 = DWT_getCycles();
+				my_UART_Transmit(port, benchTx[i]);
+				result -> apiCycles += DWT_elapsed(t0);
+
+				while(readUART(5, port, SR) == 0){ //RXNE
+					if(BENCH_timedOut(start, limitCycles, ++loops, limitLoops)) break;
+				}
+				if(readUART(5, port, SR) == 0) break;
+
+				uint8_t byte = (uint8_t)readUART(0, port, DR);
+				BENCH_checkRx(&byte, 1);
+			}
+			break;
+
+		case BENCH_MODE_IRQ: {
+			UART_interruptInit(port);
+			uint16_t sent = 0;
+
+			while(benchRxCount < payload){
+				if(BENCH_timedOut(start, limitCycles, ++loops, limitLoops)) break;
+				bool worked = false;
+
+				if(sent < payload){
+					uint32_t t0 = DWT_getCycles();
+					uint16_t queued = UART_write(port, &benchTx[sent], (uint16_t)(payload - sent));
+					result -> apiCycles += DWT_elapsed(t0);
+					sent = (uint16_t)(sent + queued);
+					worked = (queued > 0);
+				}
+
+				if(UART_rxAvailable(port) > 0){
+					uint32_t t0 = DWT_getCycles();
+					uint16_t n = UART_read(port, benchRx, sizeof(benchRx));
+					result -> apiCycles += DWT_elapsed(t0);
+					BENCH_checkRx(benchRx, n);
+					worked = true;
+				}
+
+				if(!worked) idle++;
+			}
+			break;
+		}
+
+		case BENCH_MODE_DMA: {
+			UART_DMA_rxInit(port, BENCH_dmaRxCallback);
+			UART_DMA_txInit(port, NULL);
+
+			uint32_t t0 = DWT_getCycles();
+			uint16_t sent = UART_DMA_write(port, benchTx, payload); //Fits in one ping-pong buffer
+			result -> apiCycles += DWT_elapsed(t0);
+			if(sent != payload) break;
+
+			while(benchRxCount < payload){
+				if(BENCH_timedOut(start, limitCycles, ++loops, limitLoops)) break;
+				idle++;
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	uint32_t elapsed = DWT_elapsed(start);
+	result -> received = benchRxCount;
+	result -> mismatches = benchMismatches;
+	result -> latencyCycles = benchLastRxCycle - start;
+	result -> cpuPermille = (mode == BENCH_MODE_POLL) ? 1000 : BENCH_cpuPermille(elapsed, idle);
+
+	BENCH_resetPort(port);
+	return result -> received == payload && result -> mismatches == 0;
+}
+
+
+/*
+ * @brief	Print one result as a single JSON line on stdout
+ */
+void BENCH_printResult(const BENCH_Result_t* result){
+	if(result == NULL) return;
+
+	bool ok = (result -> received == result -> payload) && (result -> mismatches == 0);
+	printf("{\"suite\":\"uart\",\"mode\":\"%s\",\"baud\":%lu,\"payload\":%u,\"ok\":%s,"
+		   "\"received\":%u,\"mismatches\":%u,\"cycles_valid\":%s,"
+		   "\"api_cycles\":%lu,\"cycles_per_byte\":%lu,\"latency_us\":%lu,\"cpu_permille\":%u}\r\n",
+		   BENCH_MODE_NAME[result -> mode], (unsigned long)result -> baud, result -> payload, ok ? "true" : "false",
+		   result -> received, result -> mismatches, benchCyclesValid ? "true" : "false",
+		   (unsigned long)result -> apiCycles, (unsigned long)(result -> apiCycles / result -> payload),
+		   (unsigned long)DWT_cyclesToUs(result -> latencyCycles), result -> cpuPermille);
+}
+
+
+/*
+ * @brief	Full matrix: every mode x baud rate x payload size
+ *
+ * 			Waits for stdout (printf retarget) to drain before each run so the report
+ * 			traffic does not steal cycles from the measurement.
+ */
+void BENCH_runUARTSuite(BENCH_UARTPins_t loopback){
+	static const uint32_t BAUDS[] = {115200U, 921600U, 2000000U};
+	static const uint16_t PAYLOADS[] = {1U, 16U, 64U, 256U, 512U};
+
+	benchCyclesValid = DWT_init();
+	BENCH_calibrateIdle();
+
+	printf("{\"suite\":\"uart\",\"event\":\"start\",\"hclk\":%lu,\"cycles_valid\":%s,\"idle_cost_x16\":%lu}\r\n",
+		   (unsigned long)RCC_getHCLKFreq(), benchCyclesValid ? "true" : "false", (unsigned long)benchIdleCost16);
+
+	uint16_t runs = 0, failures = 0;
+	for(uint8_t b = 0; b < sizeof(BAUDS) / sizeof(BAUDS[0]); b++){
+		for(uint8_t p = 0; p < sizeof(PAYLOADS) / sizeof(PAYLOADS[0]); p++){
+			for(uint8_t m = BENCH_MODE_POLL; m <= BENCH_MODE_DMA; m++){
+				while(UART_retargetGetPending() > 0); //Let the previous report line leave first
+
+				BENCH_Result_t result;
+				if(!BENCH_runUART(loopback, (BENCH_Mode_t)m, BAUDS[b], PAYLOADS[p], &result)) failures++;
+				runs++;
+				BENCH_printResult(&result);
+			}
+		}
+	}
+
+	printf("{\"suite\":\"uart\",\"event\":\"end\",\"runs\":%u,\"failures\":%u}\r\n", runs, failures);
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * SPI Frame Size Benchmark
+ * ------------------------------------------------------------
+ * Same polled loop for both frame sizes (SPI_transfer8 / SPI_transfer16), so the difference
+ * is the number of DR accesses and flag polls per byte. At low SCK the wire dominates and both
+ * modes converge; at high SCK the per-frame CPU work decides the throughput.
+ */
+
+/*
+ * @brief	SCK frequency for a prescaler on this SPI (SPI1/4/5 on APB2, SPI2/3 on APB1)
+ */
+static uint32_t BENCH_spiSckHz(SPI_Name_t SPIx, SPI_BaudRate_t baudRate){
+	uint32_t pclk = (SPIx == my_SPI2 || SPIx == my_SPI3) ? RCC_getPCLK1Freq() : RCC_getPCLK2Freq();
+	return pclk >> ((uint32_t)baudRate + 1U);
+}
+
+
+/*
+ * @brief	One SPI run
+ *
+ * @param	loopback	true when MOSI is wired to MISO, received bytes are then checked
+ *
+ * @return	true if the data came back unchanged (always true without loopback)
+ */
+bool BENCH_runSPI(SPI_GPIO_Config_t config, SPI_DFF_t frameSize, SPI_BaudRate_t baudRate, uint16_t payload,
+				  bool loopback, BENCH_SPIResult_t* result){
+	if(result == NULL || payload == 0 || payload > BENCH_MAX_PAYLOAD) return false;
+
+	*result = (BENCH_SPIResult_t){ .frameSize = frameSize, .sckHz = BENCH_spiSckHz(config.SPIx, baudRate), .payload = payload };
+	for(uint16_t i = 0; i < payload; i++) benchTx[i] = (uint8_t)(i * 7U + 1U);
+
+	//Prescaler changes with SPE = 0
+	uint32_t cr1 = SPI_readRegister(config.SPIx, SPI_CR1);
+	cr1 = (cr1 & ~((0x7U << 3) | (1U << 6))) | ((uint32_t)baudRate << 3);
+	SPI_writeRegister(config.SPIx, SPI_CR1, cr1);
+	SPI_writeRegister(config.SPIx, SPI_CR1, cr1 | (1U << 6));
+
+	uint32_t start = DWT_getCycles();
+	if(frameSize == DFF_16BITS) SPI_transfer16(config, benchTx, benchSpiRx, payload, SPI_PACK_BIG_ENDIAN);
+	else SPI_transfer8(config, benchTx, benchSpiRx, payload);
+	result -> cycles = DWT_elapsed(start);
+
+	if(benchCyclesValid && result -> cycles > 0){
+		result -> bytesPerSec = (uint32_t)(((uint64_t)payload * RCC_getHCLKFreq()) / result -> cycles);
+	}
+
+	if(loopback){
+		for(uint16_t i = 0; i < payload; i++){
+			if(benchSpiRx[i] != benchTx[i]) result -> mismatches++;
+		}
+	}
+	return result -> mismatches == 0;
+}
+
+
+/*
+ * @brief	Print one SPI result as a JSON line (same keys as the UART suite for bench_diff)
+ */
+void BENCH_printSPIResult(const BENCH_SPIResult_t* result, bool loopback){
+	if(result == NULL) return;
+
+	printf("{\"suite\":\"spi\",\"mode\":\"%s\",\"baud\":%lu,\"payload\":%u,\"ok\":%s,"
+		   "\"loopback\":%s,\"mismatches\":%u,\"cycles_valid\":%s,"
+		   "\"cycles_per_byte\":%lu,\"latency_us\":%lu,\"bytes_per_sec\":%lu,\"cpu_permille\":1000}\r\n",
+		   (result -> frameSize == DFF_16BITS) ? "dff16" : "dff8", (unsigned long)result -> sckHz, result -> payload,
+		   (result -> mismatches == 0) ? "true" : "false", loopback ? "true" : "false", result -> mismatches,
+		   benchCyclesValid ? "true" : "false", (unsigned long)(result -> cycles / result -> payload),
+		   (unsigned long)DWT_cyclesToUs(result -> cycles), (unsigned long)result -> bytesPerSec);
+}
+
+
+/*
+ * @brief	8-bit vs 16-bit frames for every prescaler x payload size
+ *
+ * @param	config		SPI already set up as master (SPI_GPIO_init + SPI_basicConfigInit)
+ * @param	loopback	true when MOSI is wired to MISO
+ */
+void BENCH_runSPISuite(SPI_GPIO_Config_t config, bool loopback){
+	static const SPI_BaudRate_t PRESCALERS[] = {FPCLK_DIV2, FPCLK_DIV8, FPCLK_DIV32};
+	static const uint16_t PAYLOADS[] = {16U, 64U, 256U, 512U};
+
+	benchCyclesValid = DWT_init();
+	printf("{\"suite\":\"spi\",\"event\":\"start\",\"hclk\":%lu,\"cycles_valid\":%s}\r\n",
+		   (unsigned long)RCC_getHCLKFreq(), benchCyclesValid ? "true" : "false");
+
+	uint16_t runs = 0, failures = 0;
+	for(uint8_t b = 0; b < sizeof(PRESCALERS) / sizeof(PRESCALERS[0]); b++){
+		for(uint8_t p = 0; p < sizeof(PAYLOADS) / sizeof(PAYLOADS[0]); p++){
+			for(uint8_t f = DFF_8BITS; f <= DFF_16BITS; f++){
+				while(UART_retargetGetPending() > 0);
+
+				BENCH_SPIResult_t result;
+				if(!BENCH_runSPI(config, (SPI_DFF_t)f, PRESCALERS[b], PAYLOADS[p], loopback, &result)) failures++;
+				runs++;
+				BENCH_printSPIResult(&result, loopback);
+			}
+		}
+	}
+
+	printf("{\"suite\":\"spi\",\"event\":\"end\",\"runs\":%u,\"failures\":%u}\r\n", runs, failures);
+}
@@ -0,0 +1,367 @@
+/*
+ * @file	bridge.c
+ * @brief	Zero-copy UART bridge between USART1, USART2 and USART6
+ *
+ * 			DMA streams used (see uart.c request mapping):
+ * 				RX: USART1 DMA2 S2, USART2 DMA1 S5, USART6 DMA2 S1
+ * 				TX: USART1 DMA2 S7, USART2 DMA1 S6, USART6 DMA2 S6
+ * 			The bridge owns both DMA directions of every port it uses, so do not combine
+ * 			it with UART_DMA_txInit()/UART_DMA_rxInit()/PACKET_init() on those ports.
+ *
+ * 			Pool, queues and counters are touched from three IRQ sources per port
+ * 			(USART IDLE, RX DMA, TX DMA) that may have different priorities, so every
+ * 			update runs inside a short PRIMASK critical section.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "bridge.h"
+
+#define BRIDGE_PORT_COUNT	3U
+#define BRIDGE_NO_BUFFER	0xFFU
+
+/*
+ * ------------------------------------------------------------
+ * Buffer pool
+ * ------------------------------------------------------------
+ */
+typedef struct{
+	uint8_t data[BRIDGE_BUFFER_SIZE];
+	uint16_t len;
+	uint8_t refs;		//Owners: the RX DMA while filling, then one per destination queue/TX DMA
+}BRIDGE_Buffer_t;
+
+static BRIDGE_Buffer_t bridgePool[BRIDGE_POOL_COUNT];
+static uint8_t bridgeFreeList[BRIDGE_POOL_COUNT];
+static uint8_t bridgeFreeCount;
+static uint8_t bridgeMinFree;
+static uint32_t bridgeRxDropped;
+
+/*
+ * ------------------------------------------------------------
+ * Per-port state
+ * ------------------------------------------------------------
+ */
+typedef struct{
+	uint8_t routeMask;		//Bit n set: forward what this port receives to UART_Name_t n
+	bool rxActive;
+	uint8_t rxBuf;			//Pool index the RX DMA is writing into
+
+	bool txEnabled;
+	bool txActive;
+	uint8_t txBuf;			//Pool index on the wire
+	uint8_t txQueue[BRIDGE_TXQ_DEPTH];
+	uint8_t txHead;
+	uint8_t txTail;
+}BRIDGE_Port_t;
+
+static BRIDGE_Port_t bridgePort[BRIDGE_PORT_COUNT];
+static BRIDGE_RouteStats_t bridgeRouteStats[BRIDGE_PORT_COUNT][BRIDGE_PORT_COUNT];
+
+
+
+/*
+ * @brief	Take a buffer from the pool with one reference (BRIDGE_NO_BUFFER if empty)
+ * @note	Caller holds the critical section
+ */
+static uint8_t BRIDGE_alloc(void){
+	if(bridgeFreeCount == 0) return BRIDGE_NO_BUFFER;
+
+	uint8_t idx = bridgeFreeList[--bridgeFreeCount];
+	if(bridgeFreeCount < bridgeMinFree) bridgeMinFree = bridgeFreeCount;
+	bridgePool[idx].refs = 1;
+	bridgePool[idx].len = 0;
+	return idx;
+}
+
+
+/*
+ * @brief	Drop one reference, the last one returns the buffer to the pool
+ * @note	Caller holds the critical section
+ */
+static void BRIDGE_release(uint8_t idx){
+	if(idx >= BRIDGE_POOL_COUNT || bridgePool[idx].refs == 0) return;
+	if(--bridgePool[idx].refs == 0) bridgeFreeList[bridgeFreeCount++] = idx;
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Transmit side
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Start the next queued buffer if the TX DMA of @p port is idle
+ * @note	Caller holds the critical section
+ */
+static void BRIDGE_txKick(UART_Name_t port){
+	BRIDGE_Port_t* p = &bridgePort[port];
+	if(p -> txActive || p -> txHead == p -> txTail) return;
+
+	uint8_t idx = p -> txQueue[p -> txTail & (BRIDGE_TXQ_DEPTH - 1U)];
+	p -> txTail++;
+	p -> txBuf = idx;
+	p -> txActive = true;
+
+	const DMA_Config_t* cfg = UART_DMA_getTxConfig(port);
+	DMA_streamStart(cfg -> dma, cfg -> stream, bridgePool[idx].data, bridgePool[idx].len); //Zero copy: DMA reads the pool buffer
+}
+
+
+/*
+ * @brief	TX DMA callback: the buffer has been handed to the USART, release it
+ */
+static void BRIDGE_txEvent(uint8_t events, void* context){
+	UART_Name_t port = (UART_Name_t)(uintptr_t)context;
+	BRIDGE_Port_t* p = &bridgePort[port];
+	if(!(events & (DMA_EVENT_COMPLETE | DMA_EVENT_ERROR))) return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(p -> txActive){
+		p -> txActive = false;
+		BRIDGE_release(p -> txBuf);
+		p -> txBuf = BRIDGE_NO_BUFFER;
+	}
+	BRIDGE_txKick(port);
+	__set_PRIMASK(primask);
+}
+
+
+/*
+ * @brief	Share a filled buffer with one destination (adds a reference)
+ * @note	Caller holds the critical section
+ */
+static void BRIDGE_forward(uint8_t idx, UART_Name_t from, UART_Name_t to){
+	BRIDGE_Port_t* dst = &bridgePort[to];
+	BRIDGE_RouteStats_t* stats = &bridgeRouteStats[from][to];
+
+	if((uint8_t)(dst -> txHead - dst -> txTail) >= BRIDGE_TXQ_DEPTH){
+		stats -> dropped++;
+		return;
+	}
+
+	bridgePool[idx].refs++;
+	dst -> txQueue[dst -> txHead & (BRIDGE_TXQ_DEPTH - 1U)] = idx;
+	dst -> txHead++;
+
+	stats -> bytes += bridgePool[idx].len;
+	stats -> buffers++;
+	BRIDGE_txKick(to);
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Receive side
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Swap the RX DMA onto a fresh buffer and forward the one it filled
+ *
+ * 			Runs on IDLE (end of a burst) and on TC (buffer full mid-burst). The stream is
+ * 			re-armed before any forwarding work, the USART data register holds the next
+ * 			byte meanwhile, so nothing is lost as long as the swap is shorter than one character.
+ */
+static void BRIDGE_rxHarvest(UART_Name_t port){
+	BRIDGE_Port_t* p = &bridgePort[port];
+	const DMA_Config_t* cfg = UART_DMA_getRxConfig(port);
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if(!p -> rxActive){
+		__set_PRIMASK(primask);
+		return;
+	}
+
+	DMA_streamStop(cfg -> dma, cfg -> stream);
+	uint16_t len = (uint16_t)(BRIDGE_BUFFER_SIZE - DMA_getRemaining(cfg -> dma, cfg -> stream));
+	uint8_t filled = p -> rxBuf;
+
+	if(len == 0){
+		DMA_streamStart(cfg -> dma, cfg -> stream, bridgePool[filled].data, BRIDGE_BUFFER_SIZE);
+		__set_PRIMASK(primask);
+		return;
+	}
+
+	uint8_t next = BRIDGE_alloc();
+	if(next == BRIDGE_NO_BUFFER){
+		bridgeRxDropped += len; //Pool exhausted: reuse the same buffer, this burst is lost
+		DMA_streamStart(cfg -> dma, cfg -> stream, bridgePool[filled].data, BRIDGE_BUFFER_SIZE);
+		__set_PRIMASK(primask);
+		return;
+	}
+
+	p -> rxBuf = next;
+	DMA_streamStart(cfg -> dma, cfg -> stream, bridgePool[next].data, BRIDGE_BUFFER_SIZE);
+
+	bridgePool[filled].len = len;
+	for(uint8_t to = 0; to < BRIDGE_PORT_COUNT; to++){
+		if(p -> routeMask & (1U << to)) BRIDGE_forward(filled, port, (UART_Name_t)to);
+	}
+	BRIDGE_release(filled); //Drop the RX reference, destinations hold their own
+
+	__set_PRIMASK(primask);
+}
+
+
+static void BRIDGE_rxEvent(uint8_t events, void* context){
+	if(events & (DMA_EVENT_COMPLETE | DMA_EVENT_ERROR)) BRIDGE_rxHarvest((UART_Name_t)(uintptr_t)context);
+}
+
+
+static void BRIDGE_rxIdle(UART_Name_t UARTx){
+	BRIDGE_rxHarvest(UARTx);
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Reset the pool, routes and counters (bridge must be stopped)
+ */
+void BRIDGE_init(void){
+	for(uint8_t i = 0; i < BRIDGE_POOL_COUNT; i++){
+		bridgePool[i].refs = 0;
+		bridgeFreeList[i] = i;
+	}
+	bridgeFreeCount = BRIDGE_POOL_COUNT;
+
+	for(uint8_t i = 0; i < BRIDGE_PORT_COUNT; i++){
+		bridgePort[i] = (BRIDGE_Port_t){ .rxBuf = BRIDGE_NO_BUFFER, .txBuf = BRIDGE_NO_BUFFER };
+	}
+	BRIDGE_resetStats();
+}
+
+
+/*
+ * @brief	Forward everything received on @p from to @p to (one source may feed several ports)
+ *
+ * @return	false for an invalid port or a loop back onto the same port
+ */
+bool BRIDGE_addRoute(UART_Name_t from, UART_Name_t to){
+	if(from >= BRIDGE_PORT_COUNT || to >= BRIDGE_PORT_COUNT || from == to) return false;
+	bridgePort[from].routeMask |= (uint8_t)(1U << to);
+	return true;
+}
+
+
+/*
+ * @brief	Arm RX DMA on every source port and TX DMA on every destination port
+ *
+ * @note	Ports must already be set up with UART_Init()
+ */
+void BRIDGE_start(void){
+	uint8_t destinations = 0;
+	for(uint8_t i = 0; i < BRIDGE_PORT_COUNT; i++) destinations |= bridgePort[i].routeMask;
+
+	for(uint8_t i = 0; i < BRIDGE_PORT_COUNT; i++){
+		UART_Name_t port = (UART_Name_t)i;
+		BRIDGE_Port_t* p = &bridgePort[i];
+
+		if(destinations & (1U << i)){
+			DMA_streamInit(UART_DMA_getTxConfig(port), UART_getDataRegister(port), BRIDGE_txEvent, (void*)(uintptr_t)port);
+			writeUART(7, port, CR3, 1); //DMAT
+			p -> txEnabled = true;
+		}
+
+		if(p -> routeMask != 0){
+			DMA_Config_t rxCfg = *UART_DMA_getRxConfig(port);
+			rxCfg.circular = false; //One-shot into a pool buffer, swapped on IDLE/TC
+			rxCfg.halfTransferIrq = false;
+			DMA_streamInit(&rxCfg, UART_getDataRegister(port), BRIDGE_rxEvent, (void*)(uintptr_t)port);
+
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			p -> rxBuf = BRIDGE_alloc();
+			__set_PRIMASK(primask);
+			if(p -> rxBuf == BRIDGE_NO_BUFFER) continue;
+
+			writeUART(5, port, CR1, 0); //RXNEIE off, the DMA owns DR reads
+			writeUART(6, port, CR3, 1); //DMAR
+			DMA_streamStart(rxCfg.dma, rxCfg.stream, bridgePool[p -> rxBuf].data, BRIDGE_BUFFER_SIZE);
+			p -> rxActive = true;
+			UART_setIdleCallback(port, BRIDGE_rxIdle);
+		}
+	}
+}
+
+
+/*
+ * @brief	Stop every bridge stream and return all buffers to the pool
+ */
+void BRIDGE_stop(void){
+	for(uint8_t i = 0; i < BRIDGE_PORT_COUNT; i++){
+		UART_Name_t port = (UART_Name_t)i;
+		BRIDGE_Port_t* p = &bridgePort[i];
+
+		if(p -> rxActive){
+			UART_setIdleCallback(port, NULL);
+			writeUART(6, port, CR3, 0); //DMAR off
+			DMA_streamStop(UART_DMA_getRxConfig(port) -> dma, UART_DMA_getRxConfig(port) -> stream);
+			p -> rxActive = false;
+		}
+		if(p -> txEnabled){
+			writeUART(7, port, CR3, 0); //DMAT off
+			DMA_streamStop(UART_DMA_getTxConfig(port) -> dma, UART_DMA_getTxConfig(port) -> stream);
+			p -> txEnabled = false;
+		}
+	}
+
+	uint8_t routes[BRIDGE_PORT_COUNT];
+	for(uint8_t i = 0; i < BRIDGE_PORT_COUNT; i++) routes[i] = bridgePort[i].routeMask;
+	BRIDGE_init();
+	for(uint8_t i = 0; i < BRIDGE_PORT_COUNT; i++) bridgePort[i].routeMask = routes[i]; //Routes survive a restart
+}
+
+
+/*
+ * @brief	Counters of one route
+ */
+BRIDGE_RouteStats_t BRIDGE_getRouteStats(UART_Name_t from, UART_Name_t to){
+	if(from >= BRIDGE_PORT_COUNT || to >= BRIDGE_PORT_COUNT) return (BRIDGE_RouteStats_t){0};
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	BRIDGE_RouteStats_t stats = bridgeRouteStats[from][to];
+	__set_PRIMASK(primask);
+	return stats;
+}
+
+
+/*
+ * @brief	Pool occupancy and RX losses
+ */
+BRIDGE_PoolStats_t BRIDGE_getPoolStats(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	BRIDGE_PoolStats_t stats = { .freeBuffers = bridgeFreeCount, .minFreeBuffers = bridgeMinFree, .rxDroppedBytes = bridgeRxDropped };
+	__set_PRIMASK(primask);
+	return stats;
+}
+
+
+/*
+ * @brief	Clear all route counters and the pool low-water mark
+ */
+void BRIDGE_resetStats(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t from = 0; from < BRIDGE_PORT_COUNT; from++){
+		for(uint8_t to = 0; to < BRIDGE_PORT_COUNT; to++) bridgeRouteStats[from][to] = (BRIDGE_RouteStats_t){0};
+	}
+	bridgeMinFree = bridgeFreeCount;
+	bridgeRxDropped = 0;
+	__set_PRIMASK(primask);
+}
@@ -0,0 +1,77 @@
+/*
+ * @file	crc.c
+ * @brief	STM32F411 hardware CRC calculation unit
+ *
+ * 			The unit only takes whole 32-bit words. Byte streams are packed little-endian
+ * 			(data[0] is bits 7:0 of the first word) and a partial last word is zero-padded.
+ * 			Tools/packet_ref implements the same rule in software for the host side.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "crc.h"
+
+/*
+ * @brief	Clock the CRC unit and reset its data register to 0xFFFFFFFF
+ */
+void CRC_init(void){
+	my_RCC_CRC_CLK_ENABLE();
+	CRC_reset();
+}
+
+
+
+/*
+ * @brief	Restart the running CRC at 0xFFFFFFFF
+ */
+void CRC_reset(void){
+	CRC_REG -> CRC_CR = 1U; //RESET bit, cleared by hardware
+}
+
+
+
+/*
+ * @brief	Feed words into the running CRC (one AHB write = 4 cycles per word)
+ *
+ * @return	CRC after the last word
+ */
+uint32_t CRC_accumulateWords(const uint32_t* words, uint32_t count){
+	for(uint32_t i = 0; i < count; i++){
+		CRC_REG -> CRC_DR = words[i];
+	}
+	return CRC_REG -> CRC_DR;
+}
+
+
+
+/*
+ * @brief	CRC of a byte buffer from a fresh 0xFFFFFFFF start
+ *
+ * 			Runs with interrupts masked so a caller in an IRQ (packet RX) cannot
+ * 			interleave its words with a caller in thread mode (packet TX).
+ *
+ * @param	data	Any alignment
+ * @param	len		Number of bytes, the tail is zero-padded to a whole word
+ */
+uint32_t CRC_computeBytes(const uint8_t* data, uint32_t len){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	CRC_reset();
+	uint32_t i = 0;
+	for(; i + 4U <= len; i += 4U){
+		CRC_REG -> CRC_DR = (uint32_t)data[i] | ((uint32_t)data[i + 1] << 8) |
+							((uint32_t)data[i + 2] << 16) | ((uint32_t)data[i + 3] << 24);
+	}
+
+	if(i < len){
+		uint32_t tail = 0;
+		for(uint8_t shift = 0; i < len; i++, shift += 8) tail |= (uint32_t)data[i] << shift;
+		CRC_REG -> CRC_DR = tail;
+	}
+
+	uint32_t crc = CRC_REG -> CRC_DR;
+	__set_PRIMASK(primask);
+	return crc;
+}
@@ -0,0 +1,247 @@
+/*
+ * @file	dma.c
+ * @brief	DMA1/DMA2 stream helpers for STM32F411VET6
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ *
+ *	The module provides:
+ *		Stream configuration from a ::DMA_Config_t (direct mode, FIFO disabled)
+ *		Start/stop helpers that respect the "EN must read back 0" rule before reprogramming
+ *		One IRQ handler per stream which clears the flags and forwards the events to
+ *		the callback registered by the driver that owns the stream (UART, SPI, I2C, ...)
+ */
+
+#include "dma.h"
+
+/*
+ * ------------------------------------------------------------
+ * Globals
+ * ------------------------------------------------------------
+ */
+static DMA_Callback_t dmaCallbacks[my_DMA_COUNT][DMA_STREAM_COUNT];
+static void* dmaCallbackContext[my_DMA_COUNT][DMA_STREAM_COUNT];
+
+/*
+ * @brief	NVIC line of every stream (index: [dma][stream])
+ */
+static const IRQn_Pos_t DMA_IRQ_TABLE[my_DMA_COUNT][DMA_STREAM_COUNT] = {
+		[my_DMA1] = {DMA1_S0, DMA1_S1, DMA1_S2, DMA1_S3, DMA1_S4, DMA1_S5, DMA1_S6, DMA1_S7},
+		[my_DMA2] = {DMA2_S0, DMA2_S1, DMA2_S2, DMA2_S3, DMA2_S4, DMA2_S5, DMA2_S6, DMA2_S7},
+};
+
+/*
+ * @brief	Bit offset of a stream's flag group inside LISR/HISR (LIFCR/HIFCR)
+ * 			Streams 0-3 live in the low reg, 4-7 in the high reg with the same offsets
+ */
+static const uint8_t DMA_FLAG_SHIFT[4] = {0, 6, 16, 22};
+
+
+/*
+ * ------------------------------------------------------------
+ * Private Helpers
+ * ------------------------------------------------------------
+ */
+static volatile DMA_Register_Offset_t* getDMAReg(DMA_Name_t dma){
+	switch(dma){
+		case my_DMA1: return DMA1_REG;
+		case my_DMA2: return DMA2_REG;
+		default: return NULL;
+	}
+}
+
+static volatile DMA_Stream_Register_Offset_t* getDMAStream(DMA_Name_t dma, DMA_Stream_t stream){
+	volatile DMA_Register_Offset_t* dmaReg = getDMAReg(dma);
+	if(dmaReg == NULL || stream >= DMA_STREAM_COUNT) return NULL;
+	return &dmaReg -> DMA_STREAM[stream];
+}
+
+
+/*
+ * ------------------------------------------------------------
+ * Flag Helpers
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Read the 6-bit flag group of a stream, shifted down to bit 0
+ * 			(see DMA_FLAG_xxx)
+ */
+uint8_t DMA_getFlags(DMA_Name_t dma, DMA_Stream_t stream){
+	volatile DMA_Register_Offset_t* dmaReg = getDMAReg(dma);
+	if(dmaReg == NULL || stream >= DMA_STREAM_COUNT) return 0;
+
+	uint32_t isr = (stream < DMA_STREAM4) ? dmaReg -> DMA_LISR : dmaReg -> DMA_HISR;
+	return (uint8_t)((isr >> DMA_FLAG_SHIFT[stream & 0x3]) & DMA_FLAG_ALL);
+}
+
+
+/*
+ * @brief	Clear the selected flags of a stream (write-1-to-clear)
+ */
+void DMA_clearFlags(DMA_Name_t dma, DMA_Stream_t stream, uint8_t flags){
+	volatile DMA_Register_Offset_t* dmaReg = getDMAReg(dma);
+	if(dmaReg == NULL || stream >= DMA_STREAM_COUNT) return;
+
+	uint32_t mask = (uint32_t)(flags & DMA_FLAG_ALL) << DMA_FLAG_SHIFT[stream & 0x3];
+	if(stream < DMA_STREAM4) dmaReg -> DMA_LIFCR = mask;
+	else dmaReg -> DMA_HIFCR = mask;
+}
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+
+/*
+ * @brief	Look up the NVIC line of a stream
+ */
+IRQn_Pos_t DMA_getIRQn(DMA_Name_t dma, DMA_Stream_t stream){
+	return DMA_IRQ_TABLE[dma][stream];
+}
+
+
+/*
+ * @brief	Configure a DMA stream and hook its interrupt
+ *
+ * 			The stream is left disabled; call DMA_streamStart() to arm it.
+ * 			Transfer-complete and error interrupts are always enabled, half-transfer only on request.
+ * 			FIFO is left in direct mode, so peripheral and memory widths are the same.
+ *
+ * @param	config		Stream/channel/direction description
+ * @param	periphAddr	Peripheral data register (e.g. &USARTx->DR)
+ * @param	callback	Called from the stream IRQ with a ::DMA_Event_t mask (may be NULL)
+ * @param	context		Opaque pointer handed back to @p callback
+ */
+void DMA_streamInit(const DMA_Config_t* config, volatile void* periphAddr, DMA_Callback_t callback, void* context){
+	if(config == NULL) return;
+
+	volatile DMA_Stream_Register_Offset_t* streamReg = getDMAStream(config -> dma, config -> stream);
+	if(streamReg == NULL) return;
+
+	if(config -> dma == my_DMA1) my_RCC_DMA1_CLK_ENABLE();
+	else my_RCC_DMA2_CLK_ENABLE();
+
+	DMA_streamStop(config -> dma, config -> stream); //A stream can only be reprogrammed while EN = 0
+
+	uint32_t cr = ((uint32_t)(config -> channel & 0x7) << 25)	//CHSEL
+				| ((uint32_t)config -> priority << 16)		//PL
+				| ((uint32_t)config -> dataSize << 13)		//MSIZE
+				| ((uint32_t)config -> dataSize << 11)		//PSIZE
+				| ((uint32_t)config -> direction << 6)		//DIR
+				| DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE;
+
+	if(config -> memIncrement) cr |= DMA_SxCR_MINC;
+	if(config -> circular) cr |= DMA_SxCR_CIRC;
+	if(config -> halfTransferIrq) cr |= DMA_SxCR_HTIE;
+
+	streamReg -> DMA_SxCR = cr;
+	streamReg -> DMA_SxPAR = (uint32_t)(uintptr_t)periphAddr;
+	streamReg -> DMA_SxFCR = 0; //Direct mode
+
+	dmaCallbacks[config -> dma][config -> stream] = callback;
+	dmaCallbackContext[config -> dma][config -> stream] = context;
+
+	NVIC_enableIRQ(DMA_IRQ_TABLE[config -> dma][config -> stream]);
+}
+
+
+/*
+ * @brief	Arm a previously configured stream
+ *
+ * @param	memAddr		Memory side address (source for M2P, destination for P2M)
+ * @param	count		Number of data items (not bytes when dataSize > 8 bits)
+ */
+void DMA_streamStart(DMA_Name_t dma, DMA_Stream_t stream, const volatile void* memAddr, uint16_t count){
+	volatile DMA_Stream_Register_Offset_t* streamReg = getDMAStream(dma, stream);
+	if(streamReg == NULL || count == 0) return;
+
+	DMA_clearFlags(dma, stream, DMA_FLAG_ALL); //Stale TCIF/HTIF would prevent the stream from starting
+	streamReg -> DMA_SxM0AR = (uint32_t)(uintptr_t)memAddr;
+	streamReg -> DMA_SxNDTR = count;
+	streamReg -> DMA_SxCR |= DMA_SxCR_EN;
+}
+
+
+/*
+ * @brief	Disable a stream and wait until the hardware has really released it
+ */
+void DMA_streamStop(DMA_Name_t dma, DMA_Stream_t stream){
+	volatile DMA_Stream_Register_Offset_t* streamReg = getDMAStream(dma, stream);
+	if(streamReg == NULL) return;
+
+	streamReg -> DMA_SxCR &= ~DMA_SxCR_EN;
+	for(uint32_t t = 0; (streamReg -> DMA_SxCR & DMA_SxCR_EN) != 0; ){
+		if(++t > DMA_STOP_TIMEOUT) break;
+	}
+	DMA_clearFlags(dma, stream, DMA_FLAG_ALL);
+}
+
+
+/*
+ * @brief	true while the stream is armed
+ */
+bool DMA_streamIsEnabled(DMA_Name_t dma, DMA_Stream_t stream){
+	volatile DMA_Stream_Register_Offset_t* streamReg = getDMAStream(dma, stream);
+	if(streamReg == NULL) return false;
+	return (streamReg -> DMA_SxCR & DMA_SxCR_EN) != 0;
+}
+
+
+/*
+ * @brief	Items left to transfer (NDTR)
+ */
+uint16_t DMA_getRemaining(DMA_Name_t dma, DMA_Stream_t stream){
+	volatile DMA_Stream_Register_Offset_t* streamReg = getDMAStream(dma, stream);
+	if(streamReg == NULL) return 0;
+	return (uint16_t)(streamReg -> DMA_SxNDTR & 0xFFFF);
+}
+
+
+/*
+ * ------------------------------------------------------------
+ * Interrupt Handlers
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Common stream IRQ body
+ *
+ * 			Only flags whose interrupt is enabled in SxCR are reported, so a driver that did not
+ * 			ask for half-transfer events never sees DMA_EVENT_HALF.
+ */
+static void DMA_IRQDispatch(DMA_Name_t dma, DMA_Stream_t stream){
+	volatile DMA_Stream_Register_Offset_t* streamReg = getDMAStream(dma, stream);
+	uint32_t cr = streamReg -> DMA_SxCR;
+	uint8_t flags = DMA_getFlags(dma, stream);
+	DMA_clearFlags(dma, stream, flags);
+
+	uint8_t events = 0;
+	if((flags & DMA_FLAG_HTIF) && (cr & DMA_SxCR_HTIE)) events |= DMA_EVENT_HALF;
+	if((flags & DMA_FLAG_TCIF) && (cr & DMA_SxCR_TCIE)) events |= DMA_EVENT_COMPLETE;
+	if(((flags & DMA_FLAG_TEIF) && (cr & DMA_SxCR_TEIE)) ||
+	   ((flags & DMA_FLAG_DMEIF) && (cr & DMA_SxCR_DMEIE))) events |= DMA_EVENT_ERROR;
+
+	DMA_Callback_t callback = dmaCallbacks[dma][stream];
+	if(events != 0 && callback != NULL) callback(events, dmaCallbackContext[dma][stream]);
+}
+
+void DMA1_Stream0_IRQHandler(void){ DMA_IRQDispatch(my_DMA1, DMA_STREAM0); }
+void DMA1_Stream1_IRQHandler(void){ DMA_IRQDispatch(my_DMA1, DMA_STREAM1); }
+void DMA1_Stream2_IRQHandler(void){ DMA_IRQDispatch(my_DMA1, DMA_STREAM2); }
+void DMA1_Stream3_IRQHandler(void){ DMA_IRQDispatch(my_DMA1, DMA_STREAM3); }
+void DMA1_Stream4_IRQHandler(void){ DMA_IRQDispatch(my_DMA1, DMA_STREAM4); }
+void DMA1_Stream5_IRQHandler(void){ DMA_IRQDispatch(my_DMA1, DMA_STREAM5); }
+void DMA1_Stream6_IRQHandler(void){ DMA_IRQDispatch(my_DMA1, DMA_STREAM6); }
+void DMA1_Stream7_IRQHandler(void){ DMA_IRQDispatch(my_DMA1, DMA_STREAM7); }
+
+void DMA2_Stream0_IRQHandler(void){ DMA_IRQDispatch(my_DMA2, DMA_STREAM0); }
+void DMA2_Stream1_IRQHandler(void){ DMA_IRQDispatch(my_DMA2, DMA_STREAM1); }
+void DMA2_Stream2_IRQHandler(void){ DMA_IRQDispatch(my_DMA2, DMA_STREAM2); }
+void DMA2_Stream3_IRQHandler(void){ DMA_IRQDispatch(my_DMA2, DMA_STREAM3); }
+void DMA2_Stream4_IRQHandler(void){ DMA_IRQDispatch(my_DMA2, DMA_STREAM4); }
+void DMA2_Stream5_IRQHandler(void){ DMA_IRQDispatch(my_DMA2, DMA_STREAM5); }
+void DMA2_Stream6_IRQHandler(void){ DMA_IRQDispatch(my_DMA2, DMA_STREAM6); }
+void DMA2_Stream7_IRQHandler(void){ DMA_IRQDispatch(my_DMA2, DMA_STREAM7); }
@@ -6,6 +6,7 @@
  */
 
 #include "exti.h"
+#include "gpio_write_read.h"
 
 
 /*
@@ -156,6 +157,65 @@ void writeEXTI(uint8_t bitPosition, EXTI_Mode_t mode, FlagStatus state){
 
 
 
+/*
+ * ------------------------------------------------------------
+ * GPIO Line Routing and Callback Dispatch
+ * ------------------------------------------------------------
+ */
+static EXTI_Callback_t extiCallbacks[16]; //GPIO lines 0-15
+
+/*
+ * @brief	Route EXTI line @p line (0-15) to pin @p line of @p port
+ * 			Each line can only listen to one port at a time (PA1 and PE1 share EXTI1)
+ */
+void EXTI_selectPort(uint8_t line, uint8_t port){
+	if(line > 15) return;
+
+	uint32_t portCode = (port == (uint8_t)my_GPIOH) ? 7U : (uint32_t)port; //EXTICR: PA=0 ... PE=4, PH=7
+	uint8_t shift = (line % 4) * 4;
 
+	my_RCC_SYSCFG_CLK_ENABLE();
+	SYSCFG_REG -> SYSCFG_EXTICR[line / 4] = (SYSCFG_REG -> SYSCFG_EXTICR[line / 4] & ~(0xFU << shift)) | (portCode << shift);
+}
+
+
+/*
+ * @brief	NVIC line that serves GPIO EXTI line @p line (0-15)
+ */
+IRQn_Pos_t EXTI_getIRQn(uint8_t line){
+	if(line <= 4) return (IRQn_Pos_t)(EXTI0 + line);
+	if(line <= 9) return EXTI9_5;
+	return EXTI15_10;
+}
 
 
+/*
+ * @brief	Attach a handler to a GPIO EXTI line, NULL detaches it
+ * 			The shared handlers (9_5, 15_10) call every line that is pending
+ */
+void EXTI_setCallback(uint8_t line, EXTI_Callback_t callback){
+	if(line > 15) return;
+	extiCallbacks[line] = callback;
+}
+
+
+/*
+ * @brief	Clear and dispatch every pending line in [first, last]
+ */
+static void EXTI_dispatch(uint8_t first, uint8_t last){
+	uint32_t pending = EXTI_REG -> PR;
+
+	for(uint8_t line = first; line <= last; line++){
+		if((pending & (1U << line)) == 0) continue;
+		EXTI_REG -> PR = (1U << line); //Write 1 to clear, before the callback so a new edge is not lost
+		if(extiCallbacks[line] != NULL) extiCallbacks[line](line);
+	}
+}
+
+void EXTI0_IRQHandler(void){ EXTI_dispatch(0, 0); }
+void EXTI1_IRQHandler(void){ EXTI_dispatch(1, 1); }
+void EXTI2_IRQHandler(void){ EXTI_dispatch(2, 2); }
+void EXTI3_IRQHandler(void){ EXTI_dispatch(3, 3); }
+void EXTI4_IRQHandler(void){ EXTI_dispatch(4, 4); }
+void EXTI9_5_IRQHandler(void){ EXTI_dispatch(5, 9); }
+void EXTI15_10_IRQHandler(void){ EXTI_dispatch(10, 15); }
@@ -54,6 +54,7 @@ void writePin(GPIO_Pin_t pinNum, GPIO_PortName_t port, GPIO_Mode_t mode, GPIO_St
 							?(1U << pinNum)			//set
 							:(1U << (pinNum + 16)); //reset
 			GPIOx -> BSRR = mask;
+			SIM_REG_WRITTEN(GPIOx, &GPIOx -> BSRR);
 			return;
 		}
 
@@ -113,6 +114,7 @@ void writePin(GPIO_Pin_t pinNum, GPIO_PortName_t port, GPIO_Mode_t mode, GPIO_St
 	uint32_t mask = ((1U << bitWidth) - 1U) << bitShift;
 	uint32_t value = ((uint32_t)state << bitShift) & mask; //& mask to zero out anything that accidentally spilled outside the field
 	*reg = (*reg & ~mask) | value; //Clear the old but before OR with value
+	SIM_REG_WRITTEN(GPIOx, reg);
 }
 
 
@@ -156,6 +158,7 @@ char readPin(uint8_t bitPosition, GPIO_PortName_t port, GPIO_Mode_t mode){
 	}
 
 	//Always read the full register and mask the bit you need
+	SIM_REG_READ(GPIOx, reg);
 	return ((*reg >> bitPosition) & 0x1);
 }
 
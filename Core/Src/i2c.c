@@ -11,6 +11,7 @@
  *		Pin initialization helpers for every legal SCL/SDA mapping on STM32F411 including correct pull-up handling
  */
 #include "i2c.h"
+#include "i2c_timing.h"
 
 /*
  * -----------------------------------------------------------------
@@ -312,73 +313,127 @@ static I2C_Status_t I2C_GPIO_init(I2C_GPIO_Config_t config){
 
 
 /*
- * @brief	Calculate the value that must be written into I2C_CCR register so the bus
- * 			clock (SCL) runs at the request speed, then write that value - together with
- * 			Fast/Standard mode and duty cycle bits to the hardware register
+ * @brief	Program the solver output (::I2C_computeTiming) into CR2, CCR, TRISE and FLTR
  *
- * @param	mode	::I2C_CCR_Mode_t
- * 					I2C_SM_100K: Standard-mode 100KHz
- * 					I2C_FM_400K_DUTY_2LOW_1HIGH: Fast-mode 400kHz, Tlow/Thigh = 2/1
- * 					I2C_FM_400k_DUTY_16LOW_9HIGH: Fast-mode 400kHz, TLow/Thigh = 16/9
+ * @note	PE must be 0: CCR, TRISE and FLTR are only writable while the peripheral is disabled
+ */
+static void I2C_applyTiming(I2C_Name_t i2cBus, const I2C_Timing_t* timing){
+	writeI2C(0, i2cBus, I2C_CR2, timing -> freq);
+
+	/* Program bit 14 and 15 of I2C_CCR and write CCR val into I2C_CCR */
+	writeI2C(15, i2cBus, I2C_CCR, timing -> fastMode);
+	writeI2C(14, i2cBus, I2C_CCR, timing -> duty);
+	writeI2C(0, i2cBus, I2C_CCR, timing -> ccr);
+
+	writeI2C(0, i2cBus, I2C_TRISE, timing -> trise);
+
+	writeI2C(4, i2cBus, I2C_FLTR, timing -> analogFilterOff);
+	writeI2C(0, i2cBus, I2C_FLTR, timing -> digitalFilter);
+}
+
+
+/*
+ * -----------------------------------------------------------------
+ * Bus Sequencing Helpers (bounded waits)
+ * -----------------------------------------------------------------
+ * SR1: SB(0) ADDR(1) BTF(2) RXNE(6) TXE(7) BERR(8) ARLO(9) AF(10)
+ * CR1: PE(0) START(8) STOP(9) ACK(10) POS(11)
+ */
+
+/*
+ * @brief	Poll one status bit until it reads @p state
  *
- * @param	sclFreq		Desired SCL frequency in hertz (100k or 400k)
- * @param	sysClkFreq	Peripheral Clock that feeds the I2C unit
- * @param 	config		Structure that hold the I2C pins and i2cBus
+ * 			While waiting on SR1, a NACK (AF) or a bus error / lost arbitration (BERR, ARLO)
+ * 			ends the wait early; the flag is cleared so the next transaction starts clean.
  *
- * @retval	uint32_t crr value (0 to 0x0FFF) on success
- * 			ERROR if something wrong.
+ * @return	I2C_OK, I2C_NACK, I2C_ERROR or I2C_TIMEOUT
  */
-static I2C_Status_t I2C_getCCR(I2C_CCR_Mode_t mode,
-					   uint32_t sclFreq,
-					   uint32_t sysClkFreq,
-					   I2C_GPIO_Config_t config){
+static I2C_Status_t I2C_waitFlag(I2C_Name_t i2cBus, I2C_Mode_t mode, uint8_t bitPosition, uint32_t state){
+	for(uint32_t t = 0; t < I2C_FLAG_TIMEOUT; t++){
+		if(readI2C(bitPosition, i2cBus, mode) == state) return I2C_OK;
+		if(mode != I2C_SR1) continue;
+
+		if(readI2C(10, i2cBus, I2C_SR1) == 1u){
+			writeI2C(10, i2cBus, I2C_SR1, RESET); //AF is rc_w0
+			return I2C_NACK;
+		}
+		if(readI2C(8, i2cBus, I2C_SR1) == 1u || readI2C(9, i2cBus, I2C_SR1) == 1u){
+			writeI2C(8, i2cBus, I2C_SR1, RESET);
+			writeI2C(9, i2cBus, I2C_SR1, RESET);
+			return I2C_ERROR;
+		}
+	}
+	return I2C_TIMEOUT;
+}
 
-	/*
-	 * sclFreq must be non-zero and not greater than 400kHz
-	 * sysClkFreq must be at least 2MHz
-	 */
-	if(sclFreq == 0 || sclFreq > 400000U || sysClkFreq == 0 || sysClkFreq < 2000000U) return I2C_ERROR;
 
-	uint32_t minCcr = 4;
-	uint32_t ccr = 0;
-	uint8_t fsMode = 0;
-	uint8_t dutyMode = 0;
+/*
+ * @brief	Clear ADDR: read SR1 then SR2. SCL is stretched until this happens
+ */
+static inline void I2C_clearADDR(I2C_Name_t i2cBus){
+	(void)readI2C(0, i2cBus, I2C_SR1);
+	(void)readI2C(0, i2cBus, I2C_SR2);
+}
 
-	switch(mode){
-		case I2C_SM_100K:
-			fsMode = 0;
-			dutyMode = 0;
-			ccr = sysClkFreq / (2U * sclFreq);
-			break;
 
-		case I2C_FM_400K_DUTY_2LOW_1HIGH:
-			fsMode = 1;
-			dutyMode = 0;
-			ccr = sysClkFreq / (3U * sclFreq);
-			minCcr = 1; //Fast mode allows minimum CCR value = 1
-			break;
+/*
+ * @brief	Release the bus after a failed step and hand the status back
+ * 			ACK/POS are left cleared so a half-finished read cannot leak into the next one
+ */
+static I2C_Status_t I2C_abort(I2C_Name_t i2cBus, I2C_Status_t status){
+	writeI2C(9, i2cBus, I2C_CR1, SET); //STOP
+	writeI2C(10, i2cBus, I2C_CR1, RESET);
+	writeI2C(11, i2cBus, I2C_CR1, RESET);
+	return status;
+}
 
-		case I2C_FM_400K_DUTY_16LOW_9HIGH:
-			fsMode = 1;
-			dutyMode = 1;
-			ccr = sysClkFreq / (25U * sclFreq);
-			minCcr = 1; //Fast mode allows minimum CCR value = 1
-			break;
 
-		default: return I2C_ERROR;
-	}
-	if(ccr < minCcr) ccr = minCcr;
-	if(ccr > 0x0FFF) return I2C_ERROR;
+/*
+ * @brief	(Repeated) START followed by the address byte, returns with ADDR set and not yet cleared
+ *
+ * 			The caller clears ADDR itself because the read sequences must program ACK/POS/STOP
+ * 			in the window between ADDR and its clearing.
+ */
+static I2C_Status_t I2C_startAddress(I2C_Name_t i2cBus, uint8_t addrByte){
+	writeI2C(8, i2cBus, I2C_CR1, SET); //START
+	I2C_Status_t status = I2C_waitFlag(i2cBus, I2C_SR1, 0, 1u); //SB
+	if(status != I2C_OK) return status;
+
+	writeI2C(0, i2cBus, I2C_DR, addrByte); //Writing DR after reading SR1 clears SB
+	return I2C_waitFlag(i2cBus, I2C_SR1, 1, 1u); //ADDR, or AF if nobody answers
+}
 
-	/* Program bit 14 and 15 of I2C_CCR and write CCR val into I2C_CCR */
-	writeI2C(15, config.i2cBus, I2C_CCR, fsMode);
-	writeI2C(14, config.i2cBus, I2C_CCR, dutyMode);
-	writeI2C(0, config.i2cBus, I2C_CCR, ccr);
 
+/*
+ * @brief	Common head of every register access: wait for an idle bus, address the slave for
+ * 			writing and send the register address
+ *
+ * @param	regAddr		Register address, already carrying I2C_SUBADDR_AUTO_INCREMENT if wanted
+ */
+static I2C_Status_t I2C_sendRegAddress(I2C_Name_t i2cBus, uint8_t slaveAddr, uint8_t regAddr){
+	if(I2C_waitFlag(i2cBus, I2C_SR2, 1, 0u) != I2C_OK) return I2C_BUSY; //BUSY: another master or a stuck slave
+
+	I2C_Status_t status = I2C_startAddress(i2cBus, (uint8_t)(slaveAddr << 1));
+	if(status != I2C_OK) return I2C_abort(i2cBus, status);
+	I2C_clearADDR(i2cBus);
+
+	status = I2C_waitFlag(i2cBus, I2C_SR1, 7, 1u); //TXE
+	if(status != I2C_OK) return I2C_abort(i2cBus, status);
+	writeI2C(0, i2cBus, I2C_DR, regAddr);
 	return I2C_OK;
 }
 
 
+/*
+ * @brief	The STOP bit reads back 0 once the STOP condition is on the wire
+ * 			Issuing a new START before that would be ignored by the peripheral.
+ */
+static I2C_Status_t I2C_waitStop(I2C_Name_t i2cBus){
+	return I2C_waitFlag(i2cBus, I2C_CR1, 9, 0u);
+}
+
+
+
 /*
  * --------------------------------------------------------------------------
  * Public API
@@ -494,38 +549,172 @@ I2C_Status_t I2C_singleByteRead(I2C_GPIO_Config_t config, uint8_t slaveAddr, uin
 	return data;
 }
 
+
+/*
+ * @brief	Read @p len consecutive registers of a 7-bit slave in one transaction
+ *
+ * 			START, <addr+W>, register | auto-increment, repeated START, <addr+R>, data..., STOP.
+ * 			The end of a master receive must be prepared before the last bytes arrive
+ * 			(RM0383 18.3.3), so the sequence depends on the length:
+ * 				1 byte		ACK = 0 before ADDR is cleared, STOP right after, then RXNE
+ * 				2 bytes		ACK = 0 and POS = 1 before ADDR is cleared: the NACK lands on the
+ * 							second byte; wait BTF (both bytes received), STOP, read twice
+ * 				N > 2		ACK = 1 and read on RXNE until 3 bytes are left; wait BTF
+ * 							(N-2 in DR, N-1 in the shift register), ACK = 0, read N-2, STOP,
+ * 							read N-1, then the last byte on RXNE
+ * 			The ADDR-clear/STOP steps run with interrupts masked: an IRQ landing between them
+ * 			would let the peripheral clock out an extra byte.
+ *
+ * @param	config			config.i2cBus (my_I2C1 to my_I2C3)
+ * @param	slaveAddr		7-bit slave address (0x19 for the LSM303DLHC accelerometer)
+ * @param	startRegAddr	First register; I2C_SUBADDR_AUTO_INCREMENT is added when @p len > 1
+ * @param	buffer			Receives @p len bytes, buffer[0] is the register at @p startRegAddr
+ *
+ * @return	I2C_OK, I2C_NACK (no slave / register refused), I2C_BUSY, I2C_TIMEOUT, I2C_ERROR
+ */
+I2C_Status_t I2C_burstRead(I2C_GPIO_Config_t config, uint8_t slaveAddr, uint8_t startRegAddr, uint8_t* buffer, uint16_t len){
+	I2C_Name_t bus = config.i2cBus;
+	if(bus >= my_I2C_COUNT) return I2C_INVALID_BUS;
+	if(buffer == NULL || len == 0) return I2C_ERROR;
+
+	uint8_t regAddr = (len > 1) ? (uint8_t)(startRegAddr | I2C_SUBADDR_AUTO_INCREMENT) : startRegAddr;
+	I2C_Status_t status = I2C_sendRegAddress(bus, slaveAddr, regAddr);
+	if(status != I2C_OK) return status;
+
+	status = I2C_waitFlag(bus, I2C_SR1, 2, 1u); //BTF: register address fully shifted out
+	if(status != I2C_OK) return I2C_abort(bus, status);
+
+	status = I2C_startAddress(bus, (uint8_t)((slaveAddr << 1) | 1u)); //Repeated START, read
+	if(status != I2C_OK) return I2C_abort(bus, status);
+
+	uint32_t primask;
+	uint16_t i = 0;
+
+	if(len == 1){
+		writeI2C(10, bus, I2C_CR1, RESET); //NACK the only byte
+		primask = __get_PRIMASK();
+		__disable_irq();
+		I2C_clearADDR(bus);
+		writeI2C(9, bus, I2C_CR1, SET); //STOP after the byte
+		__set_PRIMASK(primask);
+
+		status = I2C_waitFlag(bus, I2C_SR1, 6, 1u); //RXNE
+		if(status != I2C_OK) return I2C_abort(bus, status);
+		buffer[0] = (uint8_t)readI2C(0, bus, I2C_DR);
+	}
+	else if(len == 2){
+		writeI2C(10, bus, I2C_CR1, RESET);
+		writeI2C(11, bus, I2C_CR1, SET); //POS: ACK bit applies to the next byte in the shift register
+		primask = __get_PRIMASK();
+		__disable_irq();
+		I2C_clearADDR(bus);
+		__set_PRIMASK(primask);
+
+		status = I2C_waitFlag(bus, I2C_SR1, 2, 1u); //BTF: byte 1 in DR, byte 2 in the shift register
+		if(status != I2C_OK) return I2C_abort(bus, status);
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+		writeI2C(9, bus, I2C_CR1, SET);
+		buffer[0] = (uint8_t)readI2C(0, bus, I2C_DR);
+		__set_PRIMASK(primask);
+		buffer[1] = (uint8_t)readI2C(0, bus, I2C_DR);
+		writeI2C(11, bus, I2C_CR1, RESET);
+	}
+	else{
+		writeI2C(10, bus, I2C_CR1, SET); //ACK every byte until told otherwise
+		I2C_clearADDR(bus);
+
+		for(; i < len - 3U; i++){
+			status = I2C_waitFlag(bus, I2C_SR1, 6, 1u); //RXNE
+			if(status != I2C_OK) return I2C_abort(bus, status);
+			buffer[i] = (uint8_t)readI2C(0, bus, I2C_DR);
+		}
+
+		status = I2C_waitFlag(bus, I2C_SR1, 2, 1u); //BTF: N-2 in DR, N-1 in the shift register
+		if(status != I2C_OK) return I2C_abort(bus, status);
+
+		writeI2C(10, bus, I2C_CR1, RESET); //Byte N gets the NACK
+		primask = __get_PRIMASK();
+		__disable_irq();
+		buffer[i++] = (uint8_t)readI2C(0, bus, I2C_DR);
+		writeI2C(9, bus, I2C_CR1, SET);
+		buffer[i++] = (uint8_t)readI2C(0, bus, I2C_DR);
+		__set_PRIMASK(primask);
+
+		status = I2C_waitFlag(bus, I2C_SR1, 6, 1u);
+		if(status != I2C_OK) return I2C_abort(bus, status);
+		buffer[i] = (uint8_t)readI2C(0, bus, I2C_DR);
+	}
+
+	return I2C_waitStop(bus);
+}
+
+
+/*
+ * @brief	Write @p len consecutive registers of a 7-bit slave in one transaction
+ *
+ * 			START, <addr+W>, register | auto-increment, data..., STOP after BTF so the last byte
+ * 			has been acknowledged before the bus is released.
+ *
+ * @return	I2C_OK, I2C_NACK, I2C_BUSY, I2C_TIMEOUT, I2C_ERROR
+ */
+I2C_Status_t I2C_burstWrite(I2C_GPIO_Config_t config, uint8_t slaveAddr, uint8_t startRegAddr, const uint8_t* data, uint16_t len){
+	I2C_Name_t bus = config.i2cBus;
+	if(bus >= my_I2C_COUNT) return I2C_INVALID_BUS;
+	if(data == NULL || len == 0) return I2C_ERROR;
+
+	uint8_t regAddr = (len > 1) ? (uint8_t)(startRegAddr | I2C_SUBADDR_AUTO_INCREMENT) : startRegAddr;
+	I2C_Status_t status = I2C_sendRegAddress(bus, slaveAddr, regAddr);
+	if(status != I2C_OK) return status;
+
+	for(uint16_t i = 0; i < len; i++){
+		status = I2C_waitFlag(bus, I2C_SR1, 7, 1u); //TXE, AF if the slave refused the previous byte
+		if(status != I2C_OK) return I2C_abort(bus, status);
+		writeI2C(0, bus, I2C_DR, data[i]);
+	}
+
+	status = I2C_waitFlag(bus, I2C_SR1, 2, 1u); //BTF: last byte acknowledged
+	if(status != I2C_OK) return I2C_abort(bus, status);
+
+	writeI2C(9, bus, I2C_CR1, SET);
+	return I2C_waitStop(bus);
+}
+
 /*
  * @brief	Initialize basic configurations for I2C
  *
  * 			Enable clock for selected I2C bus
  * 			Then, initialize I2C-related pins
- * 			Must select APB frequency that matches setting in RCC.c which is 50MHz
- * 			Have a helper function (I2C_getCCR) that get automatically get CCR value based on sysClkFreq, desired SCL clock and Sm or Fm mode
- * 			Set TRISE to let MCU know the time limit of getting from low to high so it can keep the timing orrect
+ * 			Read the APB1 clock from RCC and let I2C_computeTiming() derive FREQ, CCR, TRISE
+ * 			and FLTR from it (analog/digital filter from I2C_ANALOG_FILTER / I2C_DIGITAL_FILTER)
  * 			Enable I2C peripheral
  *
  * @param 	config	Pin mapping and bus identifier for this I²C instance.
  * @param	mode	Timing profile (100kHz standard mode or one of the 400kHz fast-mode options).
  * @param	sclFreq 	Desired SCL clock in hertz (100000 or 400000).
- * @param	sysClkFreq 	Peripheral clock frequency driving the I²C hardware, in hertz.
+ *
+ * @return	Achieved SCL frequency in hertz, 0 if the bus is invalid or the timing cannot be met
+ * 			with the current PCLK1 (the peripheral is then left disabled)
  */
-void I2C_basicConfigInit(I2C_GPIO_Config_t config,
-						 I2C_CCR_Mode_t ccrMode,
-						 uint32_t sclFreq,
-						 uint32_t sysClkFreq){
+uint32_t I2C_basicConfigInit(I2C_GPIO_Config_t config,
+							 I2C_CCR_Mode_t ccrMode,
+							 uint32_t sclFreq){
+	I2C_Timing_t timing;
+	if(I2C_computeTiming(RCC_getPCLK1Freq(), ccrMode, sclFreq, I2C_ANALOG_FILTER, I2C_DIGITAL_FILTER, &timing) != I2C_OK) return 0;
+
 	//Flexible enable I2C clock
 	switch(config.i2cBus){
 		case my_I2C1: my_RCC_I2C1_CLK_ENABLE(); break;
 		case my_I2C2: my_RCC_I2C2_CLK_ENABLE(); break;
 		case my_I2C3: my_RCC_I2C3_CLK_ENABLE(); break;
-		default: return;
+		default: return 0;
 	}
 	I2C_GPIO_init(config);
 	writeI2C(0, config.i2cBus, I2C_CR1, RESET); //Disable I2C peripheral before configuring it
-	writeI2C(0, config.i2cBus, I2C_CR2, (sysClkFreq/1000000U)); //Set this I2C's clock freq to 50MHz
-	if(I2C_getCCR(ccrMode, sclFreq, sysClkFreq, config) != I2C_OK) return;
-//	writeI2C(0, config.i2cBus, I2C_TRISE, 51); //1000ns(from I2C spec), 20ns from 50MHz (TRISE = 1 + (1000/20) = 51)
+	I2C_applyTiming(config.i2cBus, &timing);
 	writeI2C(0, config.i2cBus, I2C_CR1, SET); //Enable I2C peripheral
+	return timing.sclFreq;
 }
 
 
@@ -679,7 +868,7 @@ uint32_t readI2C(uint8_t bitPosition, I2C_Name_t i2cBus, I2C_Mode_t mode){
 			break;
 
 		case I2C_FLTR:
-			if(bitPosition == 0) bitWidth = 0;
+			if(bitPosition == 0) bitWidth = 4;
 			break;
 
 		default: return ERROR_FLAG;
@@ -714,3 +903,453 @@ uint32_t readI2C(uint8_t bitPosition, I2C_Name_t i2cBus, I2C_Mode_t mode){
 
 
 
+
+
+
+/*
+ * --------------------------------------------------------------------------
+ * Interrupt-Driven Master
+ * --------------------------------------------------------------------------
+ * CR2: ITERREN(8) ITEVTEN(9) ITBUFEN(10). The event IRQ walks the transaction one bus event at a
+ * time; ITBUFEN (TXE/RXNE interrupts) is switched off whenever the next step has to wait for BTF,
+ * otherwise TXE/RXNE would keep re-entering while the peripheral stretches SCL.
+ * SR1 is read once per interrupt; the read also arms the SR1-then-DR/SR2 clearing sequences.
+ */
+typedef enum{
+	I2C_IT_WRITE,	//START, address+W, regAddr, tx data
+	I2C_IT_READ		//Repeated START, address+R, rx data
+}I2C_ITPhase_t;
+
+typedef struct{
+	I2C_Transaction_t transaction;
+	I2C_ITPhase_t phase;
+	uint16_t txIndex;	//0 = regAddr, then txBuf[txIndex - 1]
+	uint16_t rxIndex;
+	bool addressed;		//ADDR of the read phase seen
+	bool dma;			//Read phase data moved by DMA (I2C_readDMA)
+	bool startHeld;		//Ended with chainStart: repeated START out, the bus is still ours
+	volatile bool busy;
+}I2C_ITState_t;
+
+static I2C_ITState_t i2cIt[my_I2C_COUNT];
+
+
+/*
+ * RX stream per bus (RM0383 table 27, DMA1 request mapping)
+ * I2C1_RX on DMA1 stream 0 is shared with SPI3_RX (channel 0): the two cannot run DMA at the
+ * same time. Stream 5 (the other I2C1_RX option) is taken by USART2_RX.
+ */
+static const DMA_Config_t I2C_DMA_RX_CONFIG[my_I2C_COUNT] = {
+		[my_I2C1] = {.dma = my_DMA1, .stream = DMA_STREAM0, .channel = 1, .direction = DMA_PERIPH_TO_MEM,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true},
+		[my_I2C2] = {.dma = my_DMA1, .stream = DMA_STREAM2, .channel = 7, .direction = DMA_PERIPH_TO_MEM,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true},
+		[my_I2C3] = {.dma = my_DMA1, .stream = DMA_STREAM1, .channel = 1, .direction = DMA_PERIPH_TO_MEM,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true},
+};
+
+
+/*
+ * @brief	Whole-register access for the IRQ path (readI2C/writeI2C work on single fields)
+ */
+static volatile uint32_t* getI2CReg(I2C_Name_t i2cBus, I2C_Mode_t mode){
+	switch(i2cBus){
+		case my_I2C1: return I2C1RegLookupTable[mode];
+		case my_I2C2: return I2C2RegLookupTable[mode];
+		case my_I2C3: return I2C3RegLookupTable[mode];
+		default: return NULL;
+	}
+}
+
+
+static IRQn_Pos_t getI2CEventIRQn(I2C_Name_t i2cBus){
+	switch(i2cBus){
+		case my_I2C1: return I2C1_EV;
+		case my_I2C2: return I2C2_EV;
+		default: return I2C3_EV;
+	}
+}
+
+
+static IRQn_Pos_t getI2CErrorIRQn(I2C_Name_t i2cBus){
+	switch(i2cBus){
+		case my_I2C1: return I2C1_ER;
+		case my_I2C2: return I2C2_ER;
+		default: return I2C3_ER;
+	}
+}
+
+
+/*
+ * @brief	Mask the I2C interrupts, reset ACK/POS and report the result
+ */
+static void I2C_IT_finish(I2C_Name_t i2cBus, I2C_Status_t status){
+	I2C_ITState_t* state = &i2cIt[i2cBus];
+
+	writeI2C(10, i2cBus, I2C_CR2, RESET); //ITBUFEN
+	writeI2C(9, i2cBus, I2C_CR2, RESET); //ITEVTEN
+	writeI2C(8, i2cBus, I2C_CR2, RESET); //ITERREN
+	writeI2C(10, i2cBus, I2C_CR1, RESET); //ACK
+	writeI2C(11, i2cBus, I2C_CR1, RESET); //POS
+
+	if(state -> dma){
+		writeI2C(11, i2cBus, I2C_CR2, RESET); //DMAEN
+		writeI2C(12, i2cBus, I2C_CR2, RESET); //LAST
+		DMA_streamStop(I2C_DMA_RX_CONFIG[i2cBus].dma, I2C_DMA_RX_CONFIG[i2cBus].stream);
+	}
+
+	state -> startHeld = (status == I2C_OK && state -> transaction.chainStart);
+	state -> busy = false;
+	if(state -> transaction.callback != NULL) state -> transaction.callback(i2cBus, status, state -> transaction.context);
+}
+
+
+/*
+ * @brief	Common start of I2C_IT_start() and I2C_readDMA()
+ */
+static bool I2C_IT_begin(I2C_Name_t i2cBus, const I2C_Transaction_t* transaction, bool dma){
+	I2C_ITState_t* state = &i2cIt[i2cBus];
+	if(state -> busy) return false;
+
+	//The previous transaction's repeated START is already on the wire (or going out): its SB starts this one
+	bool chained = state -> startHeld;
+	state -> startHeld = false;
+
+	//A callback may start the next transaction while its STOP is still going out
+	if(!chained){
+		if(I2C_waitStop(i2cBus) != I2C_OK) return false;
+		if(readI2C(1, i2cBus, I2C_SR2) == 1u) return false; //BUSY: another master holds the bus
+	}
+
+	state -> transaction = *transaction;
+	if(transaction -> autoIncrement && transaction -> txLen + transaction -> rxLen > 1){
+		state -> transaction.regAddr |= I2C_SUBADDR_AUTO_INCREMENT;
+	}
+	state -> phase = I2C_IT_WRITE;
+	state -> txIndex = 0;
+	state -> rxIndex = 0;
+	state -> addressed = false;
+	state -> dma = dma;
+	state -> busy = true;
+
+	writeI2C(11, i2cBus, I2C_CR1, RESET); //POS
+	writeI2C(8, i2cBus, I2C_CR2, SET); //ITERREN
+	writeI2C(9, i2cBus, I2C_CR2, SET); //ITEVTEN
+	writeI2C(10, i2cBus, I2C_CR2, SET); //ITBUFEN
+	NVIC_enableIRQ(getI2CEventIRQn(i2cBus));
+	NVIC_enableIRQ(getI2CErrorIRQn(i2cBus));
+
+	if(!chained) writeI2C(8, i2cBus, I2C_CR1, SET); //START, SB raises the first event
+	return true;
+}
+
+
+/*
+ * @brief	Start a register transaction and return at once, the I2Cx IRQs move it forward
+ *
+ * @param	transaction		Copied; its buffers must stay valid until the callback
+ *
+ * @return	false if the bus is busy, the previous STOP is still pending or the descriptor is invalid
+ *
+ * @note	The peripheral must already be configured and enabled (I2C_basicConfigInit)
+ */
+bool I2C_IT_start(I2C_Name_t i2cBus, const I2C_Transaction_t* transaction){
+	if(i2cBus >= my_I2C_COUNT || transaction == NULL) return false;
+	if(transaction -> rxLen > 0 && (transaction -> rxBuf == NULL || transaction -> txLen > 0)) return false;
+	if(transaction -> txLen > 0 && transaction -> txBuf == NULL) return false;
+
+	return I2C_IT_begin(i2cBus, transaction, false);
+}
+
+
+/*
+ * @brief	true while the STOP of the previous transaction is still going out
+ * 			I2C_IT_start() waits for it to clear; callers in an IRQ can poll this and retry later.
+ */
+bool I2C_IT_stopPending(I2C_Name_t i2cBus){
+	if(i2cBus >= my_I2C_COUNT) return false;
+	return readI2C(9, i2cBus, I2C_CR1) == 1u;
+}
+
+
+/*
+ * @brief	true until the callback of the current transaction has run
+ */
+bool I2C_IT_busy(I2C_Name_t i2cBus){
+	if(i2cBus >= my_I2C_COUNT) return false;
+	return i2cIt[i2cBus].busy;
+}
+
+
+/*
+ * @brief	Give up on the current transaction (e.g. a slave holding SCL low past a deadline)
+ * 			Sends STOP and calls the callback with I2C_TIMEOUT.
+ */
+void I2C_IT_abort(I2C_Name_t i2cBus){
+	if(i2cBus >= my_I2C_COUNT) return;
+	if(!i2cIt[i2cBus].busy){
+		I2C_IT_release(i2cBus);
+		return;
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(i2cIt[i2cBus].busy){
+		writeI2C(9, i2cBus, I2C_CR1, SET);
+		I2C_IT_finish(i2cBus, I2C_TIMEOUT);
+	}
+	__set_PRIMASK(primask);
+}
+
+
+/*
+ * @brief	Release a bus left held by a chainStart transaction whose successor will not come
+ * 			Sends STOP right after the pending repeated START; no-op if nothing is held.
+ */
+void I2C_IT_release(I2C_Name_t i2cBus){
+	if(i2cBus >= my_I2C_COUNT) return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(!i2cIt[i2cBus].busy && i2cIt[i2cBus].startHeld){
+		i2cIt[i2cBus].startHeld = false;
+		writeI2C(9, i2cBus, I2C_CR1, SET); //Goes out after the current START condition
+	}
+	__set_PRIMASK(primask);
+}
+
+
+/*
+ * @brief	STOP, or a repeated START when the transaction asked to keep the bus (chainStart)
+ * 			Programmed at the same points of the sequence, RM0383 allows either bit there.
+ */
+static inline void I2C_IT_endCondition(I2C_Name_t i2cBus, const I2C_ITState_t* state){
+	if(state -> transaction.chainStart) writeI2C(8, i2cBus, I2C_CR1, SET);
+	else writeI2C(9, i2cBus, I2C_CR1, SET);
+}
+
+
+/*
+ * @brief	ADDR of the read phase: program the end of the reception before clearing it
+ * 			Same 1 / 2 / N byte rules as I2C_burstRead()
+ */
+static void I2C_IT_readAddressed(I2C_Name_t i2cBus, I2C_ITState_t* state){
+	volatile uint32_t* sr2 = getI2CReg(i2cBus, I2C_SR2);
+	uint16_t len = state -> transaction.rxLen;
+	state -> addressed = true;
+
+	if(state -> dma){
+		/*
+		 * LAST: the I2C NACKs the byte after the DMA's next-to-last request (EOT-1), the STOP
+		 * follows from the DMA transfer-complete. The event IRQ has nothing left to do.
+		 */
+		writeI2C(9, i2cBus, I2C_CR2, RESET); //ITEVTEN
+		writeI2C(10, i2cBus, I2C_CR1, (len > 1) ? SET : RESET);
+		if(len > 1) writeI2C(12, i2cBus, I2C_CR2, SET); //LAST
+		writeI2C(11, i2cBus, I2C_CR2, SET); //DMAEN
+		(void)*sr2;
+		if(len == 1) writeI2C(9, i2cBus, I2C_CR1, SET); //Single byte: STOP now, as without DMA
+		return;
+	}
+
+	if(len == 1){
+		writeI2C(10, i2cBus, I2C_CR1, RESET); //NACK the only byte
+		(void)*sr2; //Clears ADDR
+		I2C_IT_endCondition(i2cBus, state);
+		writeI2C(10, i2cBus, I2C_CR2, SET); //The byte comes in on RXNE
+	}
+	else if(len == 2){
+		writeI2C(10, i2cBus, I2C_CR1, RESET);
+		writeI2C(11, i2cBus, I2C_CR1, SET); //POS
+		(void)*sr2; //Both bytes are collected on BTF
+	}
+	else{
+		writeI2C(10, i2cBus, I2C_CR1, SET); //ACK
+		(void)*sr2;
+		if(len > 3) writeI2C(10, i2cBus, I2C_CR2, SET); //RXNE until 3 are left, then BTF
+	}
+}
+
+
+/*
+ * @brief	Receive side: RXNE while more than 3 bytes are left, BTF for the last three (or two)
+ */
+static void I2C_IT_receive(I2C_Name_t i2cBus, I2C_ITState_t* state, uint32_t sr1){
+	volatile uint32_t* dr = getI2CReg(i2cBus, I2C_DR);
+	uint8_t* rx = state -> transaction.rxBuf;
+	uint16_t len = state -> transaction.rxLen;
+	uint16_t left = (uint16_t)(len - state -> rxIndex);
+
+	if(len == 2){
+		if((sr1 & (1U << 2)) == 0) return; //BTF
+		I2C_IT_endCondition(i2cBus, state);
+		rx[state -> rxIndex++] = (uint8_t)*dr;
+		rx[state -> rxIndex++] = (uint8_t)*dr;
+		I2C_IT_finish(i2cBus, I2C_OK);
+		return;
+	}
+
+	if(left == 3){
+		if((sr1 & (1U << 2)) == 0) return; //BTF: N-2 in DR, N-1 in the shift register
+		writeI2C(10, i2cBus, I2C_CR1, RESET); //NACK byte N
+		rx[state -> rxIndex++] = (uint8_t)*dr;
+		I2C_IT_endCondition(i2cBus, state);
+		rx[state -> rxIndex++] = (uint8_t)*dr;
+		writeI2C(10, i2cBus, I2C_CR2, SET); //Last byte on RXNE
+		return;
+	}
+
+	if((sr1 & (1U << 6)) == 0) return; //RXNE
+	rx[state -> rxIndex++] = (uint8_t)*dr;
+	left--;
+
+	if(left == 3) writeI2C(10, i2cBus, I2C_CR2, RESET); //Wait for BTF, DR must stay full
+	else if(left == 0) I2C_IT_finish(i2cBus, I2C_OK);
+}
+
+
+/*
+ * @brief	Common I2Cx event IRQ body
+ */
+static void I2C_EV_IRQDispatch(I2C_Name_t i2cBus){
+	I2C_ITState_t* state = &i2cIt[i2cBus];
+	uint32_t sr1 = *getI2CReg(i2cBus, I2C_SR1);
+
+	if(!state -> busy){ //Late event after an abort, just silence it
+		writeI2C(10, i2cBus, I2C_CR2, RESET);
+		writeI2C(9, i2cBus, I2C_CR2, RESET);
+		return;
+	}
+
+	const I2C_Transaction_t* t = &state -> transaction;
+	volatile uint32_t* dr = getI2CReg(i2cBus, I2C_DR);
+
+	if(sr1 & (1U << 0)){ //SB: send the address byte
+		*dr = (uint32_t)(t -> slaveAddr << 1) | ((state -> phase == I2C_IT_READ) ? 1U : 0U);
+		return;
+	}
+
+	if(sr1 & (1U << 1)){ //ADDR
+		if(state -> phase == I2C_IT_READ) I2C_IT_readAddressed(i2cBus, state);
+		else (void)*getI2CReg(i2cBus, I2C_SR2);
+		return;
+	}
+
+	if(state -> phase == I2C_IT_READ){
+		//BTF of the write phase stays set until the repeated START is on the wire
+		if(state -> addressed) I2C_IT_receive(i2cBus, state, sr1);
+		return;
+	}
+
+	//Write phase: regAddr then txBuf on TXE, the end on BTF
+	if((sr1 & (1U << 7)) && state -> txIndex <= t -> txLen){
+		*dr = (state -> txIndex == 0) ? t -> regAddr : t -> txBuf[state -> txIndex - 1];
+		state -> txIndex++;
+		if(state -> txIndex > t -> txLen) writeI2C(10, i2cBus, I2C_CR2, RESET); //All queued, wait for BTF
+		return;
+	}
+
+	if(sr1 & (1U << 2)){ //BTF: last byte acknowledged
+		if(t -> rxLen > 0){
+			state -> phase = I2C_IT_READ; //ITBUFEN stays off until ADDR
+			writeI2C(8, i2cBus, I2C_CR1, SET); //Repeated START
+		}
+		else{
+			I2C_IT_endCondition(i2cBus, state);
+			(void)*dr; //Finish the SR1-then-DR sequence that clears BTF
+			I2C_IT_finish(i2cBus, I2C_OK);
+		}
+	}
+}
+
+
+/*
+ * @brief	Common I2Cx error IRQ body: AF, BERR, ARLO and OVR end the transaction
+ */
+static void I2C_ER_IRQDispatch(I2C_Name_t i2cBus){
+	volatile uint32_t* sr1Reg = getI2CReg(i2cBus, I2C_SR1);
+	uint32_t sr1 = *sr1Reg;
+	const uint32_t ERRORS = (1U << 8) | (1U << 9) | (1U << 10) | (1U << 11); //BERR, ARLO, AF, OVR
+
+	*sr1Reg = ~(sr1 & ERRORS) & 0xFFFFU; //rc_w0: write 0 to the flags seen, 1 elsewhere leaves them alone
+
+	if(!i2cIt[i2cBus].busy) return;
+	if((sr1 & (1U << 9)) == 0) writeI2C(9, i2cBus, I2C_CR1, SET); //After lost arbitration the bus is not ours to STOP
+	I2C_IT_finish(i2cBus, (sr1 & (1U << 10)) ? I2C_NACK : I2C_ERROR);
+}
+
+void I2C1_EV_IRQHandler(void){ I2C_EV_IRQDispatch(my_I2C1); }
+void I2C1_ER_IRQHandler(void){ I2C_ER_IRQDispatch(my_I2C1); }
+void I2C2_EV_IRQHandler(void){ I2C_EV_IRQDispatch(my_I2C2); }
+void I2C2_ER_IRQHandler(void){ I2C_ER_IRQDispatch(my_I2C2); }
+void I2C3_EV_IRQHandler(void){ I2C_EV_IRQDispatch(my_I2C3); }
+void I2C3_ER_IRQHandler(void){ I2C_ER_IRQDispatch(my_I2C3); }
+
+
+
+/*
+ * --------------------------------------------------------------------------
+ * DMA Reception
+ * --------------------------------------------------------------------------
+ */
+
+/*
+ * @brief	RX stream event: the last byte is in memory, release the bus
+ */
+static void I2C_DMA_rxEvent(uint8_t events, void* context){
+	I2C_Name_t i2cBus = (I2C_Name_t)(uintptr_t)context;
+	I2C_ITState_t* state = &i2cIt[i2cBus];
+	if(!state -> busy || !state -> dma) return;
+
+	if(events & DMA_EVENT_ERROR){
+		writeI2C(9, i2cBus, I2C_CR1, SET);
+		I2C_IT_finish(i2cBus, I2C_ERROR);
+		return;
+	}
+	if(events & DMA_EVENT_COMPLETE){
+		if(state -> transaction.rxLen > 1) writeI2C(9, i2cBus, I2C_CR1, SET); //The NACK already went out with the last byte
+		state -> rxIndex = state -> transaction.rxLen;
+		I2C_IT_finish(i2cBus, I2C_OK);
+	}
+}
+
+
+/*
+ * @brief	Read @p len consecutive registers with the data phase moved by DMA
+ *
+ * 			The address phase (START, <addr+W>, register, repeated START, <addr+R>) runs on the
+ * 			event IRQ as in I2C_IT_start(); after that the only interrupts are the DMA transfer
+ * 			complete and, on failure, the I2C error IRQ. About 7 interrupts whatever @p len is.
+ *
+ * @param	regAddr			First register, sent as given unless @p autoIncrement
+ * @param	autoIncrement	Add I2C_SUBADDR_AUTO_INCREMENT when @p len > 1 (ST sensors such as the
+ * 							LSM303DLHC accelerometer). Leave false for slaves that advance on their
+ * 							own or use bit 7 as address: the LSM303DLHC magnetometer (0x1E), EEPROMs.
+ * @param	rxBuf			Receives @p len bytes, must stay valid until the callback
+ * @param	callback		Raised from the DMA (or I2C error) IRQ, may be NULL
+ *
+ * @return	false if the bus or its DMA stream is busy, or on invalid arguments
+ */
+bool I2C_readDMA(I2C_Name_t i2cBus, uint8_t slaveAddr, uint8_t regAddr, bool autoIncrement, uint8_t* rxBuf, uint16_t len,
+				 I2C_Callback_t callback, void* context){
+	if(i2cBus >= my_I2C_COUNT || rxBuf == NULL || len == 0 || i2cIt[i2cBus].busy) return false;
+
+	const DMA_Config_t* cfg = &I2C_DMA_RX_CONFIG[i2cBus];
+	if(DMA_streamIsEnabled(cfg -> dma, cfg -> stream)) return false; //Stream in use by another driver
+
+	//Programmed on every call: another driver may have configured the shared stream in between
+	DMA_streamInit(cfg, getI2CReg(i2cBus, I2C_DR), I2C_DMA_rxEvent, (void*)(uintptr_t)i2cBus);
+	DMA_streamStart(cfg -> dma, cfg -> stream, rxBuf, len); //Idle until DMAEN is set at ADDR
+
+	const I2C_Transaction_t transaction = {
+			.slaveAddr = slaveAddr, .regAddr = regAddr,
+			.rxBuf = rxBuf, .rxLen = len,
+			.callback = callback, .context = context,
+			.autoIncrement = autoIncrement
+	};
+	if(!I2C_IT_begin(i2cBus, &transaction, true)){
+		DMA_streamStop(cfg -> dma, cfg -> stream);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,491 @@
+/*
+ * @file	i2c_sched.c
+ * @brief	Prioritised I2C transaction queue with repeated-START chaining and latency statistics
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "i2c_sched.h"
+
+/*
+ * ------------------------------------------------------------
+ * Globals
+ * ------------------------------------------------------------
+ * One queue per bus. Slots are taken and freed with interrupts masked, so requests can be
+ * submitted from thread mode and from any IRQ, including the completion callbacks.
+ * "active" is the request on the bus, "next" the one already promised the repeated START.
+ */
+typedef struct{
+	I2C_SCHED_Request_t request;
+	uint32_t submitted;		//DWT cycles
+	uint32_t deadline;		//DWT cycles, only if request.deadlineUs != 0
+	uint32_t order;			//Submission sequence, breaks ties
+	bool used;
+}I2C_SCHED_Slot_t;
+
+typedef struct{
+	uint8_t slaveAddr;
+	uint64_t latencySum;
+	uint32_t latencyCount;
+	I2C_SCHED_DeviceStats_t stats;
+}I2C_SCHED_Device_t;
+
+typedef struct{
+	I2C_SCHED_Slot_t queue[I2C_SCHED_QUEUE_LEN];
+	uint8_t pending;
+	uint32_t nextOrder;
+
+	I2C_SCHED_Slot_t active;	//used = transaction on the bus
+	I2C_SCHED_Slot_t next;		//used = follows active with a repeated START
+	uint32_t activeStart;
+	uint8_t chainLength;		//Transactions in the current repeated-START run
+	bool startHeld;				//active ended OK with its repeated START: next goes out without STOP
+	bool deferred;				//Launch put off until the previous STOP is out, the retry timer comes back
+
+	I2C_SCHED_BusStats_t stats;
+	uint32_t windowStart;
+	I2C_SCHED_Device_t devices[I2C_SCHED_MAX_DEVICES];
+	uint8_t deviceCount;
+}I2C_SCHED_Bus_t;
+
+static I2C_SCHED_Bus_t schedBus[my_I2C_COUNT];
+static uint32_t schedCyclesPerUs;
+static TIM_Name_t schedRetryTimer;
+static bool schedRetryArmed;
+
+static void I2C_SCHED_dispatch(I2C_Name_t i2cBus);
+static void I2C_SCHED_retry(TIM_Name_t userTIMx);
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	true if @p a must run before @p b: priority, then earliest deadline, then FIFO
+ */
+static bool I2C_SCHED_before(const I2C_SCHED_Slot_t* a, const I2C_SCHED_Slot_t* b){
+	if(a -> request.priority != b -> request.priority) return a -> request.priority < b -> request.priority;
+
+	bool aDeadline = (a -> request.deadlineUs != 0);
+	bool bDeadline = (b -> request.deadlineUs != 0);
+	if(aDeadline != bDeadline) return aDeadline;
+	if(aDeadline && a -> deadline != b -> deadline) return (int32_t)(a -> deadline - b -> deadline) < 0;
+
+	return (int32_t)(a -> order - b -> order) < 0;
+}
+
+
+/*
+ * @brief	Best waiting request, optionally only those for @p slaveAddr
+ *
+ * @return	Queue index, -1 if none
+ */
+static int8_t I2C_SCHED_pick(const I2C_SCHED_Bus_t* bus, bool anyDevice, uint8_t slaveAddr){
+	int8_t best = -1;
+
+	for(uint8_t i = 0; i < I2C_SCHED_QUEUE_LEN; i++){
+		const I2C_SCHED_Slot_t* slot = &bus -> queue[i];
+		if(!slot -> used) continue;
+		if(!anyDevice && slot -> request.transaction.slaveAddr != slaveAddr) continue;
+		if(best < 0 || I2C_SCHED_before(slot, &bus -> queue[best])) best = (int8_t)i;
+	}
+	return best;
+}
+
+
+/*
+ * @brief	First waiting request whose deadline has already passed, -1 if none
+ */
+static int8_t I2C_SCHED_findExpired(const I2C_SCHED_Bus_t* bus, uint32_t now){
+	for(uint8_t i = 0; i < I2C_SCHED_QUEUE_LEN; i++){
+		const I2C_SCHED_Slot_t* slot = &bus -> queue[i];
+		if(slot -> used && slot -> request.deadlineUs != 0 && (int32_t)(now - slot -> deadline) > 0) return (int8_t)i;
+	}
+	return -1;
+}
+
+
+/*
+ * @brief	Statistics entry of a slave address, created on first use (NULL once the table is full)
+ */
+static I2C_SCHED_Device_t* I2C_SCHED_device(I2C_SCHED_Bus_t* bus, uint8_t slaveAddr){
+	for(uint8_t i = 0; i < bus -> deviceCount; i++){
+		if(bus -> devices[i].slaveAddr == slaveAddr) return &bus -> devices[i];
+	}
+	if(bus -> deviceCount >= I2C_SCHED_MAX_DEVICES) return NULL;
+
+	I2C_SCHED_Device_t* device = &bus -> devices[bus -> deviceCount++];
+	device -> slaveAddr = slaveAddr;
+	device -> latencySum = 0;
+	device -> latencyCount = 0;
+	device -> stats = (I2C_SCHED_DeviceStats_t){ .slaveAddr = slaveAddr, .latencyMin = UINT32_MAX };
+	return device;
+}
+
+
+/*
+ * @brief	Come back to @p i2cBus from the retry timer, the caller holds the interrupts off
+ *
+ * 			If the timer cannot be started the bus waits for the next I2C_SCHED_submit().
+ */
+static void I2C_SCHED_defer(I2C_Name_t i2cBus){
+	schedBus[i2cBus].deferred = true;
+	if(!schedRetryArmed){
+		schedRetryArmed = (TIM_startPeriodic(schedRetryTimer, I2C_SCHED_RETRY_HZ, I2C_SCHED_retry) != 0);
+	}
+}
+
+
+/*
+ * @brief	Take a request out of the queue, the caller holds the interrupts off
+ */
+static I2C_SCHED_Slot_t I2C_SCHED_take(I2C_SCHED_Bus_t* bus, int8_t index){
+	I2C_SCHED_Slot_t slot = bus -> queue[index];
+	bus -> queue[index].used = false;
+	bus -> pending--;
+	return slot;
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Interrupt side
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Completion of the active request (I2Cx event/error IRQ, or I2C_IT_abort)
+ *
+ * 			Books the latency, hands the result to the requester, then launches the reserved
+ * 			successor (its repeated START is already on the wire) or whatever is best next.
+ */
+static void I2C_SCHED_done(I2C_Name_t i2cBus, I2C_Status_t status, void* context){
+	(void)context;
+	I2C_SCHED_Bus_t* bus = &schedBus[i2cBus];
+	uint32_t now = DWT_getCycles();
+	I2C_SCHED_Slot_t done = bus -> active;
+
+	bus -> stats.busyCycles += now - bus -> activeStart;
+	bus -> active.used = false;
+	bus -> startHeld = (status == I2C_OK && done.request.transaction.chainStart);
+
+	I2C_SCHED_Device_t* device = I2C_SCHED_device(bus, done.request.transaction.slaveAddr);
+	if(device != NULL){
+		uint32_t latency = now - done.submitted;
+		if(status == I2C_OK) device -> stats.completed++;
+		else device -> stats.failed++;
+		if(latency < device -> stats.latencyMin) device -> stats.latencyMin = latency;
+		if(latency > device -> stats.latencyMax) device -> stats.latencyMax = latency;
+		device -> latencySum += latency;
+		device -> latencyCount++;
+	}
+
+	if(done.request.transaction.callback != NULL){
+		done.request.transaction.callback(i2cBus, status, done.request.transaction.context);
+	}
+	I2C_SCHED_dispatch(i2cBus);
+}
+
+
+/*
+ * @brief	Retry timer: dispatch every deferred bus, stop once none is left waiting
+ */
+static void I2C_SCHED_retry(TIM_Name_t userTIMx){
+	(void)userTIMx;
+
+	for(uint8_t i = 0; i < my_I2C_COUNT; i++){
+		if(!schedBus[i].deferred) continue;
+		schedBus[i].deferred = false;
+		I2C_SCHED_dispatch((I2C_Name_t)i);
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	bool waiting = false;
+	for(uint8_t i = 0; i < my_I2C_COUNT; i++) waiting |= schedBus[i].deferred;
+	if(!waiting && schedRetryArmed){
+		TIM_stopPeriodic(schedRetryTimer);
+		schedRetryArmed = false;
+	}
+	__set_PRIMASK(primask);
+}
+
+
+/*
+ * @brief	Put @p slot on the bus as the active request
+ *
+ * 			Before it goes out, look for a successor to the same device: it is reserved now and
+ * 			this transaction ends with a repeated START instead of STOP. A successor is only taken
+ * 			if nothing more urgent for another device is waiting, and at most I2C_SCHED_MAX_CHAIN
+ * 			transactions run in a row so the other devices are not starved.
+ *
+ * @note	Interrupts are masked by the caller, the first bus event is taken once they are back on.
+ * 			Unless chained, the caller has checked that no STOP is pending: I2C_IT_start() returns at once.
+ */
+static bool I2C_SCHED_launch(I2C_Name_t i2cBus, I2C_SCHED_Slot_t slot, bool chained){
+	I2C_SCHED_Bus_t* bus = &schedBus[i2cBus];
+	uint32_t now = DWT_getCycles();
+	uint8_t slaveAddr = slot.request.transaction.slaveAddr;
+
+	bus -> chainLength = chained ? (uint8_t)(bus -> chainLength + 1U) : 1U;
+	slot.request.transaction.chainStart = false;
+	slot.request.transaction.callback = I2C_SCHED_done;
+	slot.request.transaction.context = NULL;
+
+	int8_t successor = -1;
+	if(bus -> chainLength < I2C_SCHED_MAX_CHAIN){
+		int8_t same = I2C_SCHED_pick(bus, false, slaveAddr);
+		int8_t any = I2C_SCHED_pick(bus, true, 0);
+		if(same >= 0 && bus -> queue[same].request.priority <= bus -> queue[any].request.priority) successor = same;
+	}
+	slot.request.transaction.chainStart = (successor >= 0);
+
+	if(!I2C_IT_start(i2cBus, &slot.request.transaction)) return false; //Bus held by another master
+
+	if(successor >= 0) bus -> next = I2C_SCHED_take(bus, successor);
+	bus -> active = slot;
+	bus -> activeStart = now;
+	bus -> stats.transactions++;
+	if(chained) bus -> stats.chained++;
+
+	I2C_SCHED_Device_t* device = I2C_SCHED_device(bus, slaveAddr);
+	if(device != NULL){
+		uint32_t wait = now - slot.submitted;
+		if(wait > device -> stats.waitMax) device -> stats.waitMax = wait;
+		if(chained && slot.request.deadlineUs != 0 && (int32_t)(now - slot.deadline) > 0) device -> stats.late++;
+	}
+	return true;
+}
+
+
+/*
+ * @brief	Start the next request if the bus is free
+ *
+ * 			Expired requests are dropped first (callback with I2C_TIMEOUT). While the previous STOP
+ * 			is still on the wire nothing is started, the retry timer calls back in a few us.
+ * 			A request the master refuses to start fails with I2C_BUSY. Callbacks run with
+ * 			interrupts enabled again.
+ */
+static void I2C_SCHED_dispatch(I2C_Name_t i2cBus){
+	I2C_SCHED_Bus_t* bus = &schedBus[i2cBus];
+
+	while(1){
+		I2C_SCHED_Slot_t dropped;
+		I2C_Status_t dropStatus = I2C_OK;
+
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+
+		if(bus -> active.used){
+			__set_PRIMASK(primask);
+			return;
+		}
+
+		//A STOP from the last transaction (or a failed chain) is going out: no new START before it clears
+		bool chainReady = (bus -> next.used && bus -> startHeld);
+		if(!chainReady && (bus -> next.used || bus -> pending > 0) && I2C_IT_stopPending(i2cBus)){
+			I2C_SCHED_defer(i2cBus);
+			__set_PRIMASK(primask);
+			return;
+		}
+
+		if(bus -> next.used){
+			//Reserved successor: its repeated START is already out unless the previous one failed
+			I2C_SCHED_Slot_t next = bus -> next;
+			bool chained = bus -> startHeld;
+			bus -> next.used = false;
+			bus -> startHeld = false;
+			if(!I2C_SCHED_launch(i2cBus, next, chained)){
+				dropped = next;
+				dropStatus = I2C_BUSY;
+			}
+		}
+		else{
+			uint32_t now = DWT_getCycles();
+			int8_t index = I2C_SCHED_findExpired(bus, now);
+
+			if(index >= 0){
+				dropped = I2C_SCHED_take(bus, index);
+				dropStatus = I2C_TIMEOUT;
+				I2C_SCHED_Device_t* device = I2C_SCHED_device(bus, dropped.request.transaction.slaveAddr);
+				if(device != NULL) device -> stats.expired++;
+			}
+			else{
+				index = I2C_SCHED_pick(bus, true, 0);
+				if(index < 0){
+					__set_PRIMASK(primask);
+					return;
+				}
+				I2C_SCHED_Slot_t slot = I2C_SCHED_take(bus, index);
+				if(!I2C_SCHED_launch(i2cBus, slot, false)){
+					dropped = slot;
+					dropStatus = I2C_BUSY;
+				}
+			}
+		}
+		__set_PRIMASK(primask);
+
+		if(dropStatus == I2C_OK) return; //Launched, the completion callback carries on
+
+		if(dropStatus == I2C_BUSY){
+			I2C_SCHED_Device_t* device = I2C_SCHED_device(bus, dropped.request.transaction.slaveAddr);
+			if(device != NULL) device -> stats.failed++;
+		}
+		if(dropped.request.transaction.callback != NULL){
+			dropped.request.transaction.callback(i2cBus, dropStatus, dropped.request.transaction.context);
+		}
+	}
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Empty every queue and start the DWT time base
+ *
+ * 			The buses must be configured with I2C_basicConfigInit() and left to the scheduler:
+ * 			no direct I2C_IT_start() / blocking calls on them while requests are queued.
+ *
+ * @param	retryTimer	TIM2 - TIM5, reserved for the scheduler; only runs while a launch waits for a STOP
+ */
+void I2C_SCHED_init(TIM_Name_t retryTimer){
+	(void)DWT_init();
+	schedCyclesPerUs = RCC_getHCLKFreq() / 1000000U;
+
+	if(schedRetryArmed) TIM_stopPeriodic(schedRetryTimer);
+	schedRetryTimer = retryTimer;
+	schedRetryArmed = false;
+
+	for(uint8_t i = 0; i < my_I2C_COUNT; i++){
+		schedBus[i] = (I2C_SCHED_Bus_t){0};
+		I2C_SCHED_resetStats((I2C_Name_t)i);
+	}
+}
+
+
+/*
+ * @brief	Queue a register transaction, starting it at once if the bus is idle
+ *
+ * 			Callable from thread mode and from IRQs (the request callbacks included).
+ * 			The request is copied; its buffers must stay valid until its callback, which runs
+ * 			from the I2C IRQ with the I2C_IT_start() status, I2C_TIMEOUT if the deadline passed
+ * 			before it could start, or I2C_BUSY if the master refused it.
+ *
+ * @return	false if the queue is full, the request is malformed or deadlineUs is above
+ * 			I2C_SCHED_MAX_DEADLINE_US (nothing is queued)
+ */
+bool I2C_SCHED_submit(I2C_Name_t i2cBus, const I2C_SCHED_Request_t* request){
+	if(i2cBus >= my_I2C_COUNT || request == NULL) return false;
+
+	I2C_SCHED_Bus_t* bus = &schedBus[i2cBus];
+	const I2C_Transaction_t* t = &request -> transaction;
+	bool valid = request -> priority < I2C_SCHED_PRIO_COUNT &&
+				 request -> deadlineUs <= I2C_SCHED_MAX_DEADLINE_US &&
+				 !(t -> rxLen > 0 && (t -> rxBuf == NULL || t -> txLen > 0)) &&
+				 !(t -> txLen > 0 && t -> txBuf == NULL);
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	int8_t free = -1;
+	for(uint8_t i = 0; i < I2C_SCHED_QUEUE_LEN && free < 0; i++){
+		if(!bus -> queue[i].used) free = (int8_t)i;
+	}
+	if(!valid || free < 0){
+		bus -> stats.rejected++;
+		__set_PRIMASK(primask);
+		return false;
+	}
+
+	I2C_SCHED_Slot_t* slot = &bus -> queue[free];
+	slot -> request = *request;
+	slot -> submitted = DWT_getCycles();
+	slot -> deadline = slot -> submitted + (uint32_t)((uint64_t)request -> deadlineUs * schedCyclesPerUs);
+	slot -> order = bus -> nextOrder++;
+	slot -> used = true;
+
+	bus -> pending++;
+	if(bus -> pending > bus -> stats.queuePeak) bus -> stats.queuePeak = bus -> pending;
+	__set_PRIMASK(primask);
+
+	I2C_SCHED_dispatch(i2cBus);
+	return true;
+}
+
+
+/*
+ * @brief	Requests waiting (not counting the one on the bus)
+ */
+uint8_t I2C_SCHED_pending(I2C_Name_t i2cBus){
+	if(i2cBus >= my_I2C_COUNT) return 0;
+	return (uint8_t)(schedBus[i2cBus].pending + (schedBus[i2cBus].next.used ? 1U : 0U));
+}
+
+
+I2C_SCHED_BusStats_t I2C_SCHED_getBusStats(I2C_Name_t i2cBus){
+	if(i2cBus >= my_I2C_COUNT) return (I2C_SCHED_BusStats_t){0};
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	I2C_SCHED_BusStats_t stats = schedBus[i2cBus].stats;
+	stats.windowCycles = DWT_getCycles() - schedBus[i2cBus].windowStart;
+	__set_PRIMASK(primask);
+	return stats;
+}
+
+
+/*
+ * @brief	Statistics of one slave address on @p i2cBus
+ *
+ * @return	false if the address has not been seen since the last reset (or the table was full)
+ */
+bool I2C_SCHED_getDeviceStats(I2C_Name_t i2cBus, uint8_t slaveAddr, I2C_SCHED_DeviceStats_t* stats){
+	if(i2cBus >= my_I2C_COUNT || stats == NULL) return false;
+
+	I2C_SCHED_Bus_t* bus = &schedBus[i2cBus];
+	bool found = false;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t i = 0; i < bus -> deviceCount; i++){
+		I2C_SCHED_Device_t* device = &bus -> devices[i];
+		if(device -> slaveAddr != slaveAddr) continue;
+
+		*stats = device -> stats;
+		stats -> latencyMean = (device -> latencyCount == 0) ? 0 : (uint32_t)(device -> latencySum / device -> latencyCount);
+		if(device -> latencyCount == 0) stats -> latencyMin = 0;
+		found = true;
+		break;
+	}
+	__set_PRIMASK(primask);
+	return found;
+}
+
+
+/*
+ * @brief	Clear the bus and device counters and restart the load window
+ * 			CYCCNT wraps, so read the bus stats at least every ~40s at 100MHz.
+ */
+void I2C_SCHED_resetStats(I2C_Name_t i2cBus){
+	if(i2cBus >= my_I2C_COUNT) return;
+
+	I2C_SCHED_Bus_t* bus = &schedBus[i2cBus];
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	bus -> stats = (I2C_SCHED_BusStats_t){ .queuePeak = bus -> pending };
+	bus -> windowStart = DWT_getCycles();
+	if(bus -> active.used) bus -> activeStart = bus -> windowStart;
+	bus -> deviceCount = 0;
+	__set_PRIMASK(primask);
+}
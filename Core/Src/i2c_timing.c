@@ -0,0 +1,75 @@
+/*
+ * @file	i2c_timing.c
+ * @brief	I2C master timing solver
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "i2c_timing.h"
+
+/*
+ * @brief	Work out CR2 FREQ, CCR, TRISE and FLTR for the requested SCL
+ *
+ * 			Standard mode:		Thigh = Tlow = CCR * Tpclk1						(CCR >= 4)
+ * 			Fast mode duty 0:	Thigh = CCR * Tpclk1, Tlow = 2 * CCR * Tpclk1	(CCR >= 1)
+ * 			Fast mode duty 1:	Thigh = 9 * CCR * Tpclk1, Tlow = 16 * CCR * Tpclk1
+ *
+ * 			CCR is rounded up so the SCL never runs faster than asked; with PCLK1 a multiple of
+ * 			10MHz the 16/9 duty lands exactly on 400kHz (50MHz: CCR = 5), the 2/1 duty needs a
+ * 			multiple of 1.2MHz (50MHz: CCR = 42, 396.8kHz).
+ * 			TRISE = tr(max) / Tpclk1 + 1, with tr(max) 1000ns (Sm) or 300ns (Fm).
+ *
+ * @param	pclk1Freq		APB1 clock feeding the I2C in Hz (2 - 50MHz, 4 - 50MHz in fast mode)
+ * @param	mode			::I2C_CCR_Mode_t
+ * @param	sclFreq			Requested SCL in Hz (<= 100k in standard mode, <= 400k in fast mode)
+ * @param	analogFilter	Keep the 50ns analog spike filter on (FLTR ANOFF = 0)
+ * @param	digitalFilter	DNF, spikes shorter than @p digitalFilter PCLK1 periods are suppressed (0 = off)
+ * @param	timing			Filled in on success
+ *
+ * @return	I2C_OK, or I2C_ERROR if the combination cannot be programmed (timing left untouched)
+ */
+I2C_Status_t I2C_computeTiming(uint32_t pclk1Freq, I2C_CCR_Mode_t mode, uint32_t sclFreq,
+							   bool analogFilter, uint8_t digitalFilter, I2C_Timing_t* timing){
+	if(timing == NULL || sclFreq == 0 || digitalFilter > I2C_TIMING_MAX_DNF) return I2C_ERROR;
+	if(pclk1Freq > I2C_TIMING_MAX_PCLK1) return I2C_ERROR;
+
+	uint32_t freqMHz = pclk1Freq / 1000000U; //FREQ takes whole MHz, a fraction is dropped
+	uint32_t divider;	//PCLK1 periods per SCL period for CCR = 1
+	uint32_t minCcr;
+	uint32_t riseNs;
+	bool fastMode = (mode != I2C_SM_100K);
+
+	switch(mode){
+		case I2C_SM_100K:
+			if(sclFreq > 100000U || pclk1Freq < I2C_TIMING_MIN_PCLK1_SM) return I2C_ERROR;
+			divider = 2;
+			minCcr = 4;
+			riseNs = I2C_TIMING_MAX_RISE_SM_NS;
+			break;
+
+		case I2C_FM_400K_DUTY_2LOW_1HIGH:
+		case I2C_FM_400K_DUTY_16LOW_9HIGH:
+			if(sclFreq > 400000U || pclk1Freq < I2C_TIMING_MIN_PCLK1_FM) return I2C_ERROR;
+			divider = (mode == I2C_FM_400K_DUTY_2LOW_1HIGH) ? 3 : 25;
+			minCcr = 1;
+			riseNs = I2C_TIMING_MAX_RISE_FM_NS;
+			break;
+
+		default: return I2C_ERROR;
+	}
+
+	uint32_t ccr = (pclk1Freq + divider * sclFreq - 1U) / (divider * sclFreq);
+	if(ccr < minCcr) ccr = minCcr;
+	if(ccr > 0x0FFF) return I2C_ERROR;
+
+	timing -> freq = (uint8_t)freqMHz;
+	timing -> ccr = (uint16_t)ccr;
+	timing -> fastMode = fastMode;
+	timing -> duty = (mode == I2C_FM_400K_DUTY_16LOW_9HIGH);
+	timing -> trise = (uint8_t)((freqMHz * riseNs) / 1000U + 1U);
+	timing -> analogFilterOff = !analogFilter;
+	timing -> digitalFilter = digitalFilter;
+	timing -> sclFreq = pclk1Freq / (divider * ccr);
+	return I2C_OK;
+}
@@ -8,29 +8,245 @@
 #include "stm32f4xx_hal.h"
 #include "l3gd20.h"
 #include "gpio_write_read.h"
+
 /*
  * SPI 4-wire mode (MOSI, MISO, CLK, CS)
- * Create helper functions: Write Register and Read Register
- * Write Register: Tell the sensor to save a value at some register
- * Read Register: Ask the sensor to send back the value in a register
+ * Register writes go through SPI_transfer8, reads through SPI_burstRead so that a whole
+ * FIFO (up to 32 x 6 bytes) comes back in one chip-select assertion.
+ *
+ * Wiring on the STM32F411E-DISCO: CS = PE3, INT1 = PE0, INT2/DRDY = PE1 (EXTI1)
+ */
+
+/*
+ * ------------------------------------------------------------
+ * Globals
+ * ------------------------------------------------------------
+ * gyroHead is only written by the EXTI handler, gyroTail only by L3GD20_read().
+ */
+static SPI_GPIO_Config_t gyroSpi;
+static bool gyroReady = false;
+static bool gyroStreaming = false;
+
+static GPIO_Pin_t gyroInt2Pin;
+static GPIO_PortName_t gyroInt2Port;
+static uint32_t gyroPeriodCycles; //One ODR period in DWT cycles
+
+static L3GD20_Sample_t gyroRing[L3GD20_RING_SIZE];
+static volatile uint16_t gyroHead;
+static volatile uint16_t gyroTail;
+static volatile L3GD20_Stats_t gyroStats;
+
+static uint8_t gyroBurst[L3GD20_FIFO_DEPTH * L3GD20_SAMPLE_BYTES];
+
+static const uint16_t L3GD20_ODR_HZ[4] = {95, 190, 380, 760}; //CTRL_REG1 DR[1:0]
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------
+ */
+static uint8_t L3GD20_readReg(uint8_t reg){
+	uint8_t value = 0;
+	SPI_burstRead(gyroSpi, reg, &value, 1);
+	return value;
+}
+
+
+/*
+ * Full duplex on purpose: SPI_write2Device never reads DR, so the two bytes clocked in
+ * during the write would leave OVR set for the next SPI_burstRead.
  */
+static void L3GD20_writeReg(uint8_t reg, uint8_t value){
+	uint8_t tx[2] = {(uint8_t)(reg & L3GD20_SPI_ADDR_MASK), value};
+	uint8_t rx[2];
+	SPI_transfer8(gyroSpi, tx, rx, 2);
+}
+
 
 /*
- * Helper function
- * Pull CS LOW before sending SPI to tell the sensor you're talking to it
- * Pull CS HIGH after talking to SPI
+ * @brief	Read every sample the FIFO holds and push them into the ring
+ *
+ * 			FIFO_SRC gives the level, then one burst from OUT_X_L: in FIFO mode the address
+ * 			pointer wraps from OUT_Z_H back to OUT_X_L, so N samples are 6*N consecutive bytes.
+ * 			INT2 is level-triggered on the sensor side; if samples arrived while draining and the
+ * 			level is still above the watermark there is no new rising edge, so drain again.
  */
-//#define CS_LOW 0
-//#define CS_HIGH 1
-//
-//void L3GD20_CS_MODE(uint8_t cs_state){ //cs_state: 0 = LOW, cs_state: 1 = HIGH
-//	if (cs_state == CS_LOW){
-//		GPIO_WritePin(my_GPIOE, my_GPIO_PIN_3, my_GPIO_PIN_RESET); //Set port E pin 3 to low
-//	}
-//	else if (cs_state == CS_HIGH){
-//		GPIO_WritePin(my_GPIOE, my_GPIO_PIN_3, my_GPIO_PIN_SET); //Set port E pin 3 to high
-//	}
-//}
+static void L3GD20_drainFifo(void){
+	for(uint8_t pass = 0; pass < L3GD20_DRAIN_PASSES; pass++){
+		uint8_t src = L3GD20_readReg(FIFO_SRC_REG);
+		uint8_t level = src & L3GD20_FIFO_FSS_MASK;
+
+		if(src & L3GD20_FIFO_OVRN_STT){
+			level = L3GD20_FIFO_DEPTH;
+			gyroStats.fifoOverruns++;
+		}
+		if(level == 0 || (src & L3GD20_FIFO_EMPTY_STT)) return;
+
+		uint32_t now = DWT_getCycles();
+		SPI_burstRead(gyroSpi, OUT_X_L, gyroBurst, (uint16_t)(level * L3GD20_SAMPLE_BYTES));
+		gyroStats.drains++;
+
+		uint16_t head = gyroHead;
+		for(uint8_t i = 0; i < level; i++){
+			uint16_t next = (uint16_t)((head + 1U) & (L3GD20_RING_SIZE - 1U));
+			if(next == gyroTail){
+				gyroStats.dropped += (uint32_t)(level - i);
+				break;
+			}
+
+			const uint8_t* raw = &gyroBurst[i * L3GD20_SAMPLE_BYTES];
+			L3GD20_Sample_t* sample = &gyroRing[head];
+			sample -> x = (int16_t)(raw[0] | (raw[1] << 8));
+			sample -> y = (int16_t)(raw[2] | (raw[3] << 8));
+			sample -> z = (int16_t)(raw[4] | (raw[5] << 8));
+			sample -> timestamp = now - (uint32_t)(level - 1U - i) * gyroPeriodCycles; //Newest sample = now
+
+			head = next;
+			gyroStats.samples++;
+		}
+		gyroHead = head;
+
+		if(readPin(gyroInt2Pin, gyroInt2Port, IDR) == 0) return; //Below watermark, the next edge wakes us
+	}
+}
+
 
+static void L3GD20_int2Event(uint8_t line){
+	(void)line;
+	if(gyroStreaming) L3GD20_drainFifo();
+}
 
 
+
+/*
+ * ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Check the device ID and power the gyro up with all three axes enabled
+ *
+ * @param	config			SPI bus already set up with SPI_GPIO_init() + SPI_basicConfigInit() (8-bit, master)
+ * @param	odrBandwidth	One of the L3GD20_ODRxxxHZ_BWxxHZ values
+ * @param	fullScale		L3GD20_FS_250DPS / 500DPS / 2000DPS
+ *
+ * @return	false if WHO_AM_I does not match an L3GD20 or I3G4250D
+ */
+bool L3GD20_init(SPI_GPIO_Config_t config, uint8_t odrBandwidth, uint8_t fullScale){
+	gyroSpi = config;
+	gyroReady = false;
+
+	uint8_t id = L3GD20_readReg(WHO_AM_I);
+	if(id != I_AM_L3GD20 && id != I_AM_I3G4250D) return false;
+
+	L3GD20_writeReg(CTRL_REG4, fullScale | L3GD20_LITTLE_ENDIAN);
+	L3GD20_writeReg(CTRL_REG1, odrBandwidth | L3GD20_ACTIVE | L3GD20_AXES_ENABLE);
+
+	uint16_t odrHz = L3GD20_ODR_HZ[(odrBandwidth >> 6) & 0x3];
+	gyroPeriodCycles = RCC_getHCLKFreq() / odrHz;
+	(void)DWT_init();
+
+	gyroReady = true;
+	return true;
+}
+
+
+/*
+ * @brief	Run the FIFO in stream mode and drain it from the INT2 watermark interrupt
+ *
+ * 			At 760Hz with a watermark of 24 this is ~32 interrupts per second instead of 760 polls.
+ *
+ * @param	watermark	FIFO level (1-31) that raises INT2
+ * @param	int2Pin		MCU pin wired to the gyro INT2/DRDY output (PE1 on the discovery board)
+ * @param	int2Port	Port of @p int2Pin
+ *
+ * @return	false if L3GD20_init() has not succeeded
+ */
+bool L3GD20_streamStart(uint8_t watermark, GPIO_Pin_t int2Pin, GPIO_PortName_t int2Port){
+	if(!gyroReady) return false;
+	if(watermark == 0) watermark = 1;
+	if(watermark > L3GD20_FIFO_DEPTH - 1U) watermark = L3GD20_FIFO_DEPTH - 1U;
+
+	L3GD20_streamStop();
+
+	gyroHead = 0;
+	gyroTail = 0;
+	gyroStats.samples = 0;
+	gyroStats.dropped = 0;
+	gyroStats.drains = 0;
+	gyroStats.fifoOverruns = 0;
+	gyroInt2Pin = int2Pin;
+	gyroInt2Port = int2Port;
+
+	//Bypass first: switching modes through bypass empties the FIFO
+	L3GD20_writeReg(FIFO_CTRL_REG, L3GD20_FIFO_BYPASS);
+	L3GD20_writeReg(CTRL_REG5, L3GD20_FIFO_ENABLE);
+	L3GD20_writeReg(FIFO_CTRL_REG, L3GD20_FIFO_STREAM | L3GD20_FIFO_WTM(watermark));
+	L3GD20_writeReg(CTRL_REG3, L3GD20_INT2_WATERMARK_ENABLE | L3GD20_PUSHPULL);
+
+	Enable_GPIO_Clock(int2Port);
+	writePin(int2Pin, int2Port, MODER, INPUT_MODE);
+	writePin(int2Pin, int2Port, PUPDR, FLOATING); //Push-pull output on the gyro side
+
+	EXTI_selectPort(int2Pin, int2Port);
+	EXTI_setCallback(int2Pin, L3GD20_int2Event);
+	gyroStreaming = true;
+	EXTI_init(int2Pin, my_EXTI_TRIGGER_RISING, EXTI_getIRQn(int2Pin));
+	return true;
+}
+
+
+/*
+ * @brief	Stop the watermark interrupt and put the FIFO back in bypass mode
+ * 			Samples already in the ring stay readable
+ */
+void L3GD20_streamStop(void){
+	if(!gyroStreaming) return;
+
+	writeEXTI(gyroInt2Pin, IMR, RESET);
+	gyroStreaming = false;
+	EXTI_setCallback(gyroInt2Pin, NULL);
+
+	L3GD20_writeReg(CTRL_REG3, 0x00);
+	L3GD20_writeReg(FIFO_CTRL_REG, L3GD20_FIFO_BYPASS);
+	L3GD20_writeReg(CTRL_REG5, L3GD20_FIFO_DISABLE);
+}
+
+
+/*
+ * @brief	Samples waiting in the ring
+ */
+uint16_t L3GD20_available(void){
+	return (uint16_t)((gyroHead - gyroTail) & (L3GD20_RING_SIZE - 1U));
+}
+
+
+/*
+ * @brief	Copy up to @p maxSamples samples out of the ring, oldest first
+ *
+ * @return	Number of samples copied
+ */
+uint16_t L3GD20_read(L3GD20_Sample_t* samples, uint16_t maxSamples){
+	if(samples == NULL) return 0;
+
+	uint16_t tail = gyroTail;
+	uint16_t count = 0;
+	while(count < maxSamples && tail != gyroHead){
+		samples[count++] = gyroRing[tail];
+		tail = (uint16_t)((tail + 1U) & (L3GD20_RING_SIZE - 1U));
+	}
+	gyroTail = tail;
+	return count;
+}
+
+
+/*
+ * @brief	Counters since L3GD20_streamStart()
+ */
+L3GD20_Stats_t L3GD20_getStats(void){
+	return (L3GD20_Stats_t){ .samples = gyroStats.samples, .dropped = gyroStats.dropped,
+							 .drains = gyroStats.drains, .fifoOverruns = gyroStats.fifoOverruns };
+}
@@ -0,0 +1,96 @@
+/*
+ * @file	log.c
+ * @brief	Deferred binary logging over the interrupt-driven UART TX ring
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "log.h"
+
+/*
+ * ------------------------------------------------------------
+ * Globals
+ * ------------------------------------------------------------
+ */
+static UART_Name_t logPort;
+static bool logReady = false;
+static volatile LOG_Stats_t logStats;
+
+
+
+/*
+ * @brief	Default timestamp source: DWT cycle counter (enabled by LOG_init)
+ * 			Override with a strong definition to use another time base
+ */
+__attribute__((weak)) uint32_t LOG_timestamp(void){
+	return DWT_getCycles();
+}
+
+
+
+/*
+ * @brief	Send log records over a UART already set up by UART_Init()
+ *
+ * @param	UARTx	Port used for the binary stream, switched to interrupt mode here
+ *
+ * @note	Records are queued from IRQs as well, so do not share this port with the
+ * 			printf retarget (its writer is not interrupt-safe).
+ */
+void LOG_init(UART_Name_t UARTx){
+	UART_interruptInit(UARTx);
+
+	(void)DWT_init();
+
+	logPort = UARTx;
+	logStats.records = 0;
+	logStats.dropped = 0;
+	logReady = true;
+}
+
+
+
+/*
+ * @brief	Build one record and queue it as a whole (or drop it as a whole)
+ *
+ * 			Called by the LOG() macro, safe from thread mode and interrupt handlers:
+ * 			the space check and the ring write run with interrupts masked so two
+ * 			records can never interleave. The critical section is at most 40 bytes of copy.
+ */
+void LOG_write(uint16_t id, const uint32_t* args, uint8_t nargs){
+	if(!logReady) return;
+	if(nargs > LOG_MAX_ARGS) nargs = LOG_MAX_ARGS;
+
+	uint8_t record[LOG_RECORD_MAX];
+	uint32_t ts = LOG_timestamp();
+
+	record[0] = LOG_SYNC_BYTE;
+	record[1] = nargs;
+	record[2] = (uint8_t)(id & 0xFF);
+	record[3] = (uint8_t)(id >> 8);
+	for(uint8_t i = 0; i < 4; i++) record[4 + i] = (uint8_t)(ts >> (8 * i));
+
+	for(uint8_t n = 0; n < nargs; n++){
+		for(uint8_t i = 0; i < 4; i++) record[LOG_HEADER_SIZE + 4 * n + i] = (uint8_t)(args[n] >> (8 * i));
+	}
+
+	uint16_t len = (uint16_t)(LOG_HEADER_SIZE + 4U * nargs);
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if((uint16_t)(UART_TX_RING_SIZE - UART_txPending(logPort)) >= len){
+		(void)UART_write(logPort, record, len);
+		logStats.records++;
+	}
+	else logStats.dropped++; //Never send half a record, the decoder would have to resync
+	__set_PRIMASK(primask);
+}
+
+
+
+/*
+ * @brief	Records queued and dropped since LOG_init()
+ */
+LOG_Stats_t LOG_getStats(void){
+	return (LOG_Stats_t){ .records = logStats.records, .dropped = logStats.dropped };
+}
@@ -12,7 +12,12 @@
 #include "exti.h"
 #include "rcc.h"
 #include "i2c.h"
+#include "i2c_sched.h"
 #include "adc.h"
+#include "bridge.h"
+#include "bench.h"
+#include "l3gd20.h"
+#include "sampler.h"
 
 
 char session[15] = "startup";
@@ -67,6 +72,86 @@ int main(void){
 		}
 	}
 
+	else if(strcmp(session, "BRIDGE") == 0){
+		RCC_init();
+		UART_Init(my_GPIO_PIN_6, my_GPIO_PIN_7, my_GPIOB, my_UART1, 921600, PARITY_NONE, WORDLENGTH_8B); //Host
+		UART_Init(my_GPIO_PIN_2, my_GPIO_PIN_3, my_GPIOA, my_UART2, 921600, PARITY_NONE, WORDLENGTH_8B); //Device A
+		UART_Init(my_GPIO_PIN_6, my_GPIO_PIN_7, my_GPIOC, my_UART6, 921600, PARITY_NONE, WORDLENGTH_8B); //Device B
+
+		BRIDGE_init();
+		BRIDGE_addRoute(my_UART1, my_UART2);
+		BRIDGE_addRoute(my_UART1, my_UART6); //Host commands go to both devices from the same buffer
+		BRIDGE_addRoute(my_UART2, my_UART1);
+		BRIDGE_addRoute(my_UART6, my_UART1);
+		BRIDGE_start();
+
+		while(1){
+		}
+	}
+
+	else if(strcmp(session, "UART_BENCH") == 0){
+		RCC_init();
+
+		/* USART1 (PB6/PB7) carries the JSON report, USART2 runs with PA2 wired to PA3 */
+		UART_Init(my_GPIO_PIN_6, my_GPIO_PIN_7, my_GPIOB, my_UART1, 115200, PARITY_NONE, WORDLENGTH_8B);
+		UART_retargetInit(my_UART1, UART_RETARGET_BLOCK);
+
+		BENCH_UARTPins_t loopback = {
+				.port = my_UART2,
+				.txPin = my_GPIO_PIN_2,
+				.rxPin = my_GPIO_PIN_3,
+				.gpioPort = my_GPIOA
+		};
+		BENCH_runUARTSuite(loopback);
+
+		while(1){
+		}
+	}
+
+	else if(strcmp(session, "SPI_BENCH") == 0){
+		RCC_init();
+
+		UART_Init(my_GPIO_PIN_6, my_GPIO_PIN_7, my_GPIOB, my_UART1, 115200, PARITY_NONE, WORDLENGTH_8B);
+		UART_retargetInit(my_UART1, UART_RETARGET_BLOCK);
+
+		/* SPI2 with PB15 (MOSI) wired to PB14 (MISO), PB12 as a spare chip select */
+		SPI_GPIO_Config_t benchSpi = {
+				.SPIx = my_SPI2,
+				.sckPin = my_GPIO_PIN_13, .sckPort = my_GPIOB,
+				.nssPin = my_GPIO_PIN_12, .nssPort = my_GPIOB,
+				.mosiPin = my_GPIO_PIN_15, .mosiPort = my_GPIOB,
+				.misoPin = my_GPIO_PIN_14, .misoPort = my_GPIOB
+		};
+		SPI_GPIO_init(benchSpi);
+		SPI_basicConfigInit(benchSpi, STM32_MASTER, DFF_8BITS, FPCLK_DIV2, SOFTWARE_SLAVE_ENABLE, SPI_ENABLE);
+		BENCH_runSPISuite(benchSpi, true);
+
+		while(1){
+		}
+	}
+
+	else if(strcmp(session, "SPI_SLAVE") == 0){
+		/* SPI2 slave: PB13 SCK, PB15 MOSI, PB14 MISO, PB12 hardware NSS driven by the companion MCU */
+		SPI_GPIO_Config_t slaveConfig = {
+				.SPIx = my_SPI2,
+				.sckPin = my_GPIO_PIN_13, .sckPort = my_GPIOB,
+				.nssPin = my_GPIO_PIN_12, .nssPort = my_GPIOB,
+				.mosiPin = my_GPIO_PIN_15, .mosiPort = my_GPIOB,
+				.misoPin = my_GPIO_PIN_14, .misoPort = my_GPIOB
+		};
+		SPI_slaveRxInit(slaveConfig);
+
+		uint32_t slaveChecksum = 0;
+		while(1){
+			uint16_t frameLen;
+			const uint8_t* frame = SPI_slavePeekFrame(&frameLen);
+			if(frame == NULL) continue;
+
+			for(uint16_t i = 0; i < frameLen; i++) slaveChecksum += frame[i];
+			SPI_slaveReleaseFrame();
+		}
+	}
+
 	else if(strcmp(session, "SPI") == 0){
 
 		SPI_GPIO_Config_t spiConfig = {
@@ -92,6 +177,64 @@ int main(void){
 
 		SPI_write2Device(spiConfig, 0x20, 0x0F);
 		spiRead2 = SPI_readReceivedData(spiConfig, 0x20);
+
+		uint8_t gyroBurst[L3GD20_STATUS_XYZ_BURST_LEN]; //STATUS_REG, X_L, X_H, Y_L, Y_H, Z_L, Z_H
+		SPI_burstRead(spiConfig, STATUS_REG, gyroBurst, L3GD20_STATUS_XYZ_BURST_LEN);
+	}
+
+	else if(strcmp(session, "GYRO") == 0){
+		SPI_GPIO_Config_t gyroConfig = {
+				.SPIx = my_SPI1,
+				.sckPin = my_GPIO_PIN_5, .sckPort = my_GPIOA,
+				.nssPin = my_GPIO_PIN_3, .nssPort = my_GPIOE,
+				.mosiPin = my_GPIO_PIN_7, .mosiPort = my_GPIOA,
+				.misoPin = my_GPIO_PIN_6, .misoPort = my_GPIOA
+		};
+		SPI_GPIO_init(gyroConfig);
+		writePin(gyroConfig.nssPin, gyroConfig.nssPort, BSRR, my_GPIO_PIN_SET); //Deselect before the first transfer
+		SPI_basicConfigInit(gyroConfig, STM32_MASTER, DFF_8BITS, FPCLK_DIV2, SOFTWARE_SLAVE_ENABLE, SPI_ENABLE);
+
+		if(L3GD20_init(gyroConfig, L3GD20_ODR760HZ_BW100HZ, L3GD20_FS_500DPS)){
+			L3GD20_streamStart(24, my_GPIO_PIN_1, my_GPIOE); //INT2 = PE1, ~32 drains/s at 760Hz
+		}
+
+		L3GD20_Sample_t gyroSamples[32];
+		while(1){
+			uint16_t n = L3GD20_read(gyroSamples, 32);
+			(void)n;
+		}
+	}
+
+
+	else if(strcmp(session, "GYRO_TIMED") == 0){
+		SPI_GPIO_Config_t gyroConfig = {
+				.SPIx = my_SPI1,
+				.sckPin = my_GPIO_PIN_5, .sckPort = my_GPIOA,
+				.nssPin = my_GPIO_PIN_3, .nssPort = my_GPIOE,
+				.mosiPin = my_GPIO_PIN_7, .mosiPort = my_GPIOA,
+				.misoPin = my_GPIO_PIN_6, .misoPort = my_GPIOA
+		};
+		SPI_GPIO_init(gyroConfig);
+		writePin(gyroConfig.nssPin, gyroConfig.nssPort, BSRR, my_GPIO_PIN_SET);
+		SPI_basicConfigInit(gyroConfig, STM32_MASTER, DFF_8BITS, FPCLK_DIV2, SOFTWARE_SLAVE_ENABLE, SPI_ENABLE);
+
+		//Sensor at 760Hz ODR, sampled by TIM3 at 500Hz: STATUS_REG + X/Y/Z in one burst
+		if(L3GD20_init(gyroConfig, L3GD20_ODR760HZ_BW100HZ, L3GD20_FS_500DPS)){
+			SAMPLER_start(gyroConfig, my_TIM3, 500, L3GD20_BURST_READ_ADDR(STATUS_REG), L3GD20_STATUS_XYZ_BURST_LEN, NULL, NULL);
+		}
+
+		SAMPLER_Sample_t gyroSamples[16];
+		while(1){
+			uint16_t n = SAMPLER_read(gyroSamples, 16);
+			(void)n;
+
+			SAMPLER_Stats_t stats = SAMPLER_getStats();
+			if(stats.ticks >= 5000){
+				printf("ticks %lu overruns %lu jitter min %ld max %ld mean %lu cycles (period %lu)\r\n",
+						stats.ticks, stats.overruns, stats.jitterMin, stats.jitterMax, stats.jitterMean, stats.periodCycles);
+				SAMPLER_resetStats();
+			}
+		}
 	}
 
 
@@ -135,12 +278,101 @@ int main(void){
 				.sdaPort = my_GPIOB,
 		};
 		RCC_init();
-		I2C_basicConfigInit(i2cConfig, I2C_SM_100K, 100000, 50000000); //Standard mode 100kHz and 50MHz APB peripheral
+		uint32_t sclFreq = I2C_basicConfigInit(i2cConfig, I2C_SM_100K, 100000); //Standard mode 100kHz, timing from PCLK1
+		printf("I2C SCL %lu Hz\r\n", sclFreq);
 		uint8_t dataRead = (uint8_t) I2C_singleByteRead(i2cConfig, 0b0011001, 0x0F);
 		I2C_singleByteWrite(i2cConfig, 0b0011001, 0x1F, 0b11000000);
 		uint8_t tempCfgRegRead = (uint8_t) I2C_singleByteRead(i2cConfig, 0b0011001, 0x1F);
 
+		//Accelerometer OUT_X_L_A..OUT_Z_H_A (0x28-0x2D): six single-register transactions vs one burst
+		uint8_t accelRaw[6];
+		(void)DWT_init();
+		uint32_t start = DWT_getCycles();
+		for(uint8_t i = 0; i < sizeof(accelRaw); i++) accelRaw[i] = (uint8_t) I2C_singleByteRead(i2cConfig, 0b0011001, 0x28 + i);
+		uint32_t singleCycles = DWT_elapsed(start);
+
+		start = DWT_getCycles();
+		I2C_Status_t burstStatus = I2C_burstRead(i2cConfig, 0b0011001, 0x28, accelRaw, sizeof(accelRaw));
+		uint32_t burstCycles = DWT_elapsed(start);
+		printf("6 x single %lu us, burst %lu us (status %d)\r\n",
+			   DWT_cyclesToUs(singleCycles), DWT_cyclesToUs(burstCycles), burstStatus);
+
+		//Same block from the event/error IRQs: the CPU keeps counting while the bytes move
+		const I2C_Transaction_t accelRead = {
+				.slaveAddr = 0b0011001, .regAddr = 0x28,
+				.rxBuf = accelRaw, .rxLen = sizeof(accelRaw), .autoIncrement = true
+		};
+		uint32_t spins = 0;
+		if(I2C_IT_start(i2cConfig.i2cBus, &accelRead)){
+			while(I2C_IT_busy(i2cConfig.i2cBus)) spins++;
+		}
+		printf("IT read done, %lu loop iterations overlapped\r\n", spins);
+
+		//And with the data phase on DMA1: no per-byte interrupt, the NACK/STOP come from LAST and TC
+		spins = 0;
+		if(I2C_readDMA(i2cConfig.i2cBus, 0b0011001, 0x28, true, accelRaw, sizeof(accelRaw), NULL, NULL)){
+			while(I2C_IT_busy(i2cConfig.i2cBus)) spins++;
+		}
+		printf("DMA read done, %lu loop iterations overlapped\r\n", spins);
+
+		//Magnetometer OUT_X_H_M..OUT_Y_L_M: its register pointer advances by itself, bit 7 must stay clear
+		uint8_t magRaw[6];
+		if(I2C_readDMA(i2cConfig.i2cBus, 0b0011110, 0x03, false, magRaw, sizeof(magRaw), NULL, NULL)){
+			while(I2C_IT_busy(i2cConfig.i2cBus));
+		}
+
+		while(1){
+		}
+	}
+
+	else if(strcmp(session, "I2C_SCHED") == 0){
+		I2C_GPIO_Config_t i2cConfig = {
+				.i2cBus = my_I2C1,
+				.sclPin = my_GPIO_PIN_6, .sclPort = my_GPIOB,
+				.sdaPin = my_GPIO_PIN_9, .sdaPort = my_GPIOB,
+		};
+		RCC_init();
+		I2C_basicConfigInit(i2cConfig, I2C_FM_400K_DUTY_16LOW_9HIGH, 400000);
+		I2C_SCHED_init(my_TIM4);
+
+		//LSM303DLHC: accelerometer status + XYZ (urgent, chained with a repeated START), magnetometer status
+		uint8_t accelStatus, accelRaw[6], magStatus;
+		const I2C_SCHED_Request_t accelStatusRead = {
+				.transaction = {.slaveAddr = 0b0011001, .regAddr = 0x27, .rxBuf = &accelStatus, .rxLen = 1},
+				.priority = I2C_SCHED_PRIO_HIGH, .deadlineUs = 2000
+		};
+		const I2C_SCHED_Request_t accelXYZRead = {
+				.transaction = {.slaveAddr = 0b0011001, .regAddr = 0x28, .rxBuf = accelRaw, .rxLen = sizeof(accelRaw),
+								.autoIncrement = true},
+				.priority = I2C_SCHED_PRIO_HIGH, .deadlineUs = 2000
+		};
+		const I2C_SCHED_Request_t magStatusRead = {
+				.transaction = {.slaveAddr = 0b0011110, .regAddr = 0x09, .rxBuf = &magStatus, .rxLen = 1},
+				.priority = I2C_SCHED_PRIO_LOW
+		};
+
+		uint32_t rounds = 0;
 		while(1){
+			if(I2C_SCHED_pending(i2cConfig.i2cBus) < 4){
+				I2C_SCHED_submit(i2cConfig.i2cBus, &magStatusRead);
+				I2C_SCHED_submit(i2cConfig.i2cBus, &accelStatusRead);
+				I2C_SCHED_submit(i2cConfig.i2cBus, &accelXYZRead);
+				rounds++;
+			}
+
+			if(rounds == 1000){
+				I2C_SCHED_BusStats_t busStats = I2C_SCHED_getBusStats(i2cConfig.i2cBus);
+				I2C_SCHED_DeviceStats_t accel;
+				if(I2C_SCHED_getDeviceStats(i2cConfig.i2cBus, 0b0011001, &accel)){
+					printf("accel ok %lu expired %lu latency %lu/%lu/%lu us\r\n", accel.completed, accel.expired,
+						   DWT_cyclesToUs(accel.latencyMin), DWT_cyclesToUs(accel.latencyMean), DWT_cyclesToUs(accel.latencyMax));
+				}
+				uint32_t load = (busStats.windowCycles == 0) ? 0 :
+								(uint32_t)(((uint64_t)busStats.busyCycles * 100U) / busStats.windowCycles);
+				printf("bus load %lu%%, %lu transactions, %lu chained\r\n", load, busStats.transactions, busStats.chained);
+				I2C_SCHED_resetStats(i2cConfig.i2cBus);
+				rounds = 0;
+			}
 		}
 	}
 
@@ -0,0 +1,197 @@
+/*
+ * @file	packet.c
+ * @brief	COBS-framed packet link over UART DMA with hardware CRC32
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "packet.h"
+
+/*
+ * ------------------------------------------------------------
+ * Per-port link state
+ * ------------------------------------------------------------
+ * RX runs entirely in the UART/DMA IRQ (frame accumulation, decode, CRC check),
+ * TX runs in the caller's context and encodes straight into the DMA TX buffer.
+ */
+#define PACKET_PORT_COUNT	3U
+#define PACKET_SEQ_WINDOW	128U	//seq this far ahead of the expected one counts as lost packets, beyond it as out of order
+
+typedef struct{
+	uint8_t rxEncoded[PACKET_ENCODED_MAX];
+	uint8_t rxRaw[PACKET_RAW_MAX];
+	uint16_t rxLen;
+	bool rxOverflow;		//Current frame is too long, drop everything up to the next 0x00
+	uint8_t rxExpectedSeq;
+	bool rxSeqValid;		//false until the first good packet sets rxExpectedSeq
+
+	uint8_t txRaw[PACKET_RAW_MAX];
+	uint8_t txSeq;
+
+	bool ready;
+	PACKET_RxCallback_t callback;
+	PACKET_Stats_t stats;
+}PACKET_Link_t;
+
+static PACKET_Link_t packetLink[PACKET_PORT_COUNT];
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Receive path
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Validate one complete frame and hand it to the application
+ */
+static void PACKET_processFrame(UART_Name_t UARTx){
+	PACKET_Link_t* link = &packetLink[UARTx];
+	uint16_t rawLen = 0;
+
+	if(!PACKET_cobsDecode(link -> rxEncoded, link -> rxLen, link -> rxRaw, sizeof(link -> rxRaw), &rawLen) ||
+	   rawLen < PACKET_OVERHEAD){
+		link -> stats.framingErrors++;
+		return;
+	}
+
+	uint16_t bodyLen = (uint16_t)(rawLen - 4U);
+	const uint8_t* crcBytes = &link -> rxRaw[bodyLen];
+	uint32_t rxCrc = (uint32_t)crcBytes[0] | ((uint32_t)crcBytes[1] << 8) |
+					 ((uint32_t)crcBytes[2] << 16) | ((uint32_t)crcBytes[3] << 24);
+
+	if(CRC_computeBytes(link -> rxRaw, bodyLen) != rxCrc){
+		link -> stats.crcErrors++;
+		return;
+	}
+
+	uint8_t seq = link -> rxRaw[0];
+	uint8_t ahead = (uint8_t)(seq - link -> rxExpectedSeq);
+	if(link -> rxSeqValid && ahead >= PACKET_SEQ_WINDOW){
+		link -> stats.outOfOrder++; //Duplicate or late packet: rxExpectedSeq never moves back
+	}
+	else{
+		if(link -> rxSeqValid) link -> stats.seqGaps += ahead;
+		link -> rxExpectedSeq = (uint8_t)(seq + 1U);
+		link -> rxSeqValid = true;
+	}
+	link -> stats.rxPackets++;
+
+	if(link -> callback != NULL){
+		link -> callback(UARTx, link -> rxRaw[1], seq, &link -> rxRaw[2], (uint16_t)(bodyLen - 2U));
+	}
+}
+
+
+/*
+ * @brief	UART DMA RX callback: split the byte stream on 0x00 delimiters
+ *
+ * 			The IDLE-line frameEnd flag is ignored, COBS framing is self-delimiting
+ */
+static void PACKET_rxChunk(UART_Name_t UARTx, const uint8_t* data, uint16_t len, bool frameEnd){
+	(void)frameEnd;
+	PACKET_Link_t* link = &packetLink[UARTx];
+
+	for(uint16_t i = 0; i < len; i++){
+		uint8_t byte = data[i];
+
+		if(byte == 0){
+			if(link -> rxOverflow) link -> stats.overflows++;
+			else if(link -> rxLen > 0) PACKET_processFrame(UARTx);
+			link -> rxLen = 0;
+			link -> rxOverflow = false;
+		}
+		else if(link -> rxLen < PACKET_ENCODED_MAX){
+			link -> rxEncoded[link -> rxLen++] = byte;
+		}
+		else link -> rxOverflow = true;
+	}
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Start a packet link on a UART already set up by UART_Init()
+ *
+ * 			Takes over both DMA directions of the port (UART_DMA_txInit/UART_DMA_rxInit)
+ *
+ * @param	callback	Raised from the IRQ for every valid packet, may be NULL
+ */
+void PACKET_init(UART_Name_t UARTx, PACKET_RxCallback_t callback){
+	if(UARTx >= PACKET_PORT_COUNT) return;
+
+	PACKET_Link_t* link = &packetLink[UARTx];
+	link -> rxLen = 0;
+	link -> rxOverflow = false;
+	link -> rxSeqValid = false;
+	link -> txSeq = 0;
+	link -> callback = callback;
+	link -> stats = (PACKET_Stats_t){0};
+
+	CRC_init();
+	UART_DMA_txInit(UARTx, NULL);
+	UART_DMA_rxInit(UARTx, PACKET_rxChunk);
+	link -> ready = true;
+}
+
+
+/*
+ * @brief	Send one packet (never blocks)
+ *
+ * 			The frame is COBS-encoded directly into the DMA TX buffer, so it is either
+ * 			queued whole or not at all.
+ *
+ * @note	Call from one context only (thread mode or a single IRQ), like UART_DMA_write()
+ */
+PACKET_Status_t PACKET_send(UART_Name_t UARTx, uint8_t type, const uint8_t* payload, uint16_t len){
+	if(UARTx >= PACKET_PORT_COUNT || !packetLink[UARTx].ready) return PACKET_ERROR;
+	if(payload == NULL && len > 0) return PACKET_ERROR;
+	if(len > PACKET_MAX_PAYLOAD) return PACKET_TOO_LONG;
+
+	PACKET_Link_t* link = &packetLink[UARTx];
+	uint8_t* raw = link -> txRaw;
+
+	raw[0] = link -> txSeq;
+	raw[1] = type;
+	for(uint16_t i = 0; i < len; i++) raw[2 + i] = payload[i];
+
+	uint16_t bodyLen = (uint16_t)(len + 2U);
+	uint32_t crc = CRC_computeBytes(raw, bodyLen);
+	for(uint8_t i = 0; i < 4; i++) raw[bodyLen + i] = (uint8_t)(crc >> (8 * i));
+	uint16_t rawLen = (uint16_t)(bodyLen + 4U);
+
+	uint16_t space = 0;
+	uint8_t* dst = UART_DMA_getTxBuffer(UARTx, &space);
+	if(dst == NULL) return PACKET_ERROR;
+
+	if(space < PACKET_COBS_MAX(rawLen) + 1U){
+		UART_DMA_commitTx(UARTx, 0); //Release the buffer untouched
+		link -> stats.txBusy++;
+		return PACKET_BUSY;
+	}
+
+	uint16_t encodedLen = PACKET_cobsEncode(raw, rawLen, dst);
+	dst[encodedLen++] = 0x00; //Frame delimiter
+	UART_DMA_commitTx(UARTx, encodedLen);
+
+	link -> txSeq++;
+	link -> stats.txPackets++;
+	return PACKET_OK;
+}
+
+
+/*
+ * @brief	Link counters since PACKET_init()
+ */
+PACKET_Stats_t PACKET_getStats(UART_Name_t UARTx){
+	if(UARTx >= PACKET_PORT_COUNT) return (PACKET_Stats_t){0};
+	return packetLink[UARTx].stats;
+}
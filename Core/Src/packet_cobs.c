@@ -0,0 +1,76 @@
+/*
+ * @file	packet_cobs.c
+ * @brief	COBS codec of the packet link
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "packet_cobs.h"
+
+/*
+ * ------------------------------------------------------------
+ * COBS codec
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Consistent Overhead Byte Stuffing: remove every 0x00 from @p in
+ *
+ * @param	out		Needs PACKET_COBS_MAX(len) bytes, may not overlap @p in
+ * @return	Encoded length (no delimiter appended)
+ */
+uint16_t PACKET_cobsEncode(const uint8_t* in, uint16_t len, uint8_t* out){
+	uint16_t codeIdx = 0;	//Where the pending code byte goes
+	uint16_t outIdx = 1;
+	uint8_t code = 1;		//Distance to the next zero (or block end)
+
+	for(uint16_t i = 0; i < len; i++){
+		if(in[i] == 0){
+			out[codeIdx] = code;
+			codeIdx = outIdx++;
+			code = 1;
+		}
+		else{
+			out[outIdx++] = in[i];
+			if(++code == 0xFF && (uint16_t)(i + 1U) < len){ //Full 254-byte block, next one has no implied zero
+				out[codeIdx] = code;
+				codeIdx = outIdx++;
+				code = 1;
+			}
+		}
+	}
+	out[codeIdx] = code;
+	return outIdx;
+}
+
+
+/*
+ * @brief	Undo PACKET_cobsEncode() on one frame (delimiter already stripped)
+ *
+ * @param	out		Receives at most @p outCap bytes
+ * @return	false on a zero byte inside the frame, a code running past the end, or a frame that
+ * 			decodes to more than @p outCap bytes (a peer can send up to PACKET_ENCODED_MAX
+ * 			encoded bytes, which may expand past PACKET_RAW_MAX)
+ */
+bool PACKET_cobsDecode(const uint8_t* in, uint16_t len, uint8_t* out, uint16_t outCap, uint16_t* outLen){
+	uint16_t inIdx = 0;
+	uint16_t outIdx = 0;
+
+	while(inIdx < len){
+		uint8_t code = in[inIdx++];
+		if(code == 0 || (uint16_t)(inIdx + code - 1U) > len) return false;
+
+		for(uint8_t i = 1; i < code; i++){
+			if(in[inIdx] == 0 || outIdx >= outCap) return false;
+			out[outIdx++] = in[inIdx++];
+		}
+		if(code != 0xFF && inIdx < len){ //Implied zero, except after the last block
+			if(outIdx >= outCap) return false;
+			out[outIdx++] = 0;
+		}
+	}
+
+	*outLen = outIdx;
+	return true;
+}
@@ -132,6 +132,39 @@ void my_RCC_ADC1_CLK_DISABLE()	{writeRCC(8, RCC_APB2_ENR, RESET);}
 
 
 
+/*
+ * ------------------------------------------
+ * Peripheral Clock Helper - DMA1/DMA2
+ * ------------------------------------------
+ */
+void my_RCC_DMA1_CLK_ENABLE()	{writeRCC(21, RCC_AHB1_ENR, SET);}
+void my_RCC_DMA1_CLK_DISABLE()	{writeRCC(21, RCC_AHB1_ENR, RESET);}
+
+void my_RCC_DMA2_CLK_ENABLE()	{writeRCC(22, RCC_AHB1_ENR, SET);}
+void my_RCC_DMA2_CLK_DISABLE()	{writeRCC(22, RCC_AHB1_ENR, RESET);}
+
+
+
+/*
+ * ------------------------------------------
+ * Peripheral Clock Helper - CRC
+ * ------------------------------------------
+ */
+void my_RCC_CRC_CLK_ENABLE()	{writeRCC(12, RCC_AHB1_ENR, SET);}
+void my_RCC_CRC_CLK_DISABLE()	{writeRCC(12, RCC_AHB1_ENR, RESET);}
+
+
+
+/*
+ * ------------------------------------------
+ * Peripheral Clock Helper - SYSCFG
+ * ------------------------------------------
+ */
+void my_RCC_SYSCFG_CLK_ENABLE()		{writeRCC(14, RCC_APB2_ENR, SET);}
+void my_RCC_SYSCFG_CLK_DISABLE()	{writeRCC(14, RCC_APB2_ENR, RESET);}
+
+
+
 /*
  * ---------------------------------------
  * Register Lookup Tables
@@ -636,8 +669,69 @@ void RCC_init(void){
 
 
 
+/*
+ * --------------------------------------------------------------
+ * Clock Tree Readback
+ * --------------------------------------------------------------
+ */
+
+/*
+ * @brief	Current SYSCLK in Hz, decoded from SWS and the main PLL settings
+ *
+ * 			SYSCLK = f_src / PLLM * PLLN / PLLP when the PLL is selected
+ */
+uint32_t RCC_getSysClkFreq(void){
+	switch(readRCC(2, RCC_CFGR)){ //SWS[1:0]
+		case 0b00: return HSI_CLK_FREQ;
+		case 0b01: return HSE_CLK_FREQ;
+
+		case 0b10:{
+			uint32_t pllSrcFreq = (readRCC(22, RCC_PLL_CFGR) == 1) ? HSE_CLK_FREQ : HSI_CLK_FREQ;
+			uint32_t pllM = readRCC(0, RCC_PLL_CFGR);
+			uint32_t pllN = readRCC(6, RCC_PLL_CFGR);
+			uint32_t pllP = (readRCC(16, RCC_PLL_CFGR) + 1U) * 2U; //0b00 = 2, 0b01 = 4, ...
+			if(pllM == 0) return HSI_CLK_FREQ;
+
+			return ((pllSrcFreq / pllM) * pllN) / pllP;
+		}
+
+		default: return HSI_CLK_FREQ;
+	}
+}
+
+
+/*
+ * @brief	AHB clock (HCLK) in Hz
+ *
+ * 			HPRE[3:0]: 0xxx = /1, 1000 = /2 ... 1011 = /16, 1100 = /64 ... 1111 = /512 (no /32)
+ */
+uint32_t RCC_getHCLKFreq(void){
+	uint32_t hpre = readRCC(4, RCC_CFGR);
+	if(hpre < 0b1000) return RCC_getSysClkFreq();
 
+	uint32_t shift = (hpre - 0b0111);
+	if(hpre >= 0b1100) shift++; //Skip the missing /32 step
+	return RCC_getSysClkFreq() >> shift;
+}
 
 
+/*
+ * @brief	APB1 (low-speed) peripheral clock in Hz
+ *
+ * 			PPRE1[2:0]: 0xx = /1, 100 = /2, 101 = /4, 110 = /8, 111 = /16
+ */
+uint32_t RCC_getPCLK1Freq(void){
+	uint32_t ppre1 = readRCC(10, RCC_CFGR);
+	if(ppre1 < 0b100) return RCC_getHCLKFreq();
+	return RCC_getHCLKFreq() >> (ppre1 - 0b011);
+}
 
 
+/*
+ * @brief	APB2 (high-speed) peripheral clock in Hz
+ */
+uint32_t RCC_getPCLK2Freq(void){
+	uint32_t ppre2 = readRCC(13, RCC_CFGR);
+	if(ppre2 < 0b100) return RCC_getHCLKFreq();
+	return RCC_getHCLKFreq() >> (ppre2 - 0b011);
+}
@@ -0,0 +1,240 @@
+/*
+ * @file	sampler.c
+ * @brief	Timer-paced SPI sensor sampling with jitter statistics
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "sampler.h"
+
+/*
+ * ------------------------------------------------------------
+ * Globals
+ * ------------------------------------------------------------
+ * Single instance. The ring is written only from the DMA completion (head) and read
+ * only from thread mode (tail).
+ */
+static SPI_Name_t samplerSpi;
+static TIM_Name_t samplerTimer;
+static uint8_t samplerLen;
+static volatile bool samplerRunning = false;
+static volatile bool samplerInFlight = false;
+
+static uint8_t samplerTx[SAMPLER_MAX_READ + 1];
+static uint8_t samplerRx[SAMPLER_MAX_READ + 1];
+static uint32_t samplerPendingStamp;
+
+static SAMPLER_Callback_t samplerCallback;
+static void* samplerContext;
+
+static SAMPLER_Sample_t samplerRing[SAMPLER_RING_SIZE];
+static volatile uint16_t samplerHead = 0;
+static volatile uint16_t samplerTail = 0;
+
+static SAMPLER_Stats_t samplerStats;
+static uint64_t samplerJitterSum;	//Sum of |spacing - nominal| over samplerJitterCount spacings
+static uint32_t samplerJitterCount;
+static uint32_t samplerLastTick;
+static bool samplerHaveTick;
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Interrupt side
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Burst read finished: timestamped sample goes to the hook and the ring
+ */
+static void SAMPLER_readDone(SPI_Name_t SPIx, bool ok, void* context){
+	(void)SPIx;
+	(void)context;
+
+	if(!ok){
+		samplerStats.errors++;
+		samplerInFlight = false;
+		return;
+	}
+
+	SAMPLER_Sample_t sample;
+	sample.timestamp = samplerPendingStamp;
+	for(uint8_t i = 0; i < samplerLen; i++) sample.data[i] = samplerRx[i + 1]; //[0] is clocked in with the command
+	samplerInFlight = false;
+	samplerStats.samples++;
+
+	if(samplerCallback != NULL) samplerCallback(&sample, samplerContext);
+
+	uint16_t next = (uint16_t)((samplerHead + 1U) & (SAMPLER_RING_SIZE - 1U));
+	if(next == samplerTail){
+		samplerStats.dropped++;
+		return;
+	}
+	samplerRing[samplerHead] = sample;
+	samplerHead = next;
+}
+
+
+/*
+ * @brief	Timer update: stamp the tick, fold its spacing into the jitter stats, start the read
+ *
+ * 			The stamp is taken first thing so that what is measured is interrupt entry latency,
+ * 			not the time spent here.
+ */
+static void SAMPLER_tick(TIM_Name_t userTIMx){
+	(void)userTIMx;
+	uint32_t now = DWT_getCycles();
+
+	samplerStats.ticks++;
+	if(samplerHaveTick){
+		int32_t deviation = (int32_t)(now - samplerLastTick - samplerStats.periodCycles);
+
+		if(deviation < samplerStats.jitterMin) samplerStats.jitterMin = deviation;
+		if(deviation > samplerStats.jitterMax) samplerStats.jitterMax = deviation;
+		samplerJitterSum += (uint32_t)((deviation < 0) ? -deviation : deviation);
+		samplerJitterCount++;
+	}
+	samplerLastTick = now;
+	samplerHaveTick = true;
+
+	if(!samplerRunning) return;
+	if(samplerInFlight){
+		samplerStats.overruns++;	//Rate too high for the bus speed, or the DMA IRQ is being held off
+		return;
+	}
+
+	samplerPendingStamp = now;
+	samplerInFlight = true;
+	if(!SPI_DMA_transfer(samplerSpi, samplerTx, samplerRx, (uint16_t)(samplerLen + 1U), SAMPLER_readDone, NULL)){
+		samplerInFlight = false;
+		samplerStats.errors++;
+	}
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Start sampling a register block at a fixed rate
+ *
+ * 			The SPI peripheral must already be configured and enabled (SPI_basicConfigInit()),
+ * 			the DMA engine is set up here. One read is: NSS low, @p command, @p len dummy bytes, NSS high.
+ *
+ * @param	config		SPI peripheral and the sensor chip select
+ * @param	timer		my_TIM2 to my_TIM5, dedicated to the sampler while it runs
+ * @param	rateHz		Sample rate
+ * @param	command		First byte of every read, e.g. L3GD20_BURST_READ_ADDR(OUT_X_L)
+ * @param	len			Data bytes per sample, 1 to SAMPLER_MAX_READ
+ * @param	callback	Per-sample hook from the DMA IRQ (may be NULL)
+ *
+ * @return	Achieved sample rate in Hz, 0 on invalid arguments
+ */
+uint32_t SAMPLER_start(SPI_GPIO_Config_t config, TIM_Name_t timer, uint32_t rateHz,
+					   uint8_t command, uint8_t len, SAMPLER_Callback_t callback, void* context){
+	if(rateHz == 0 || len == 0 || len > SAMPLER_MAX_READ || timer < my_TIM2 || timer > my_TIM5) return 0;
+	if(rateHz > TIM_getAPB1TimerClock() / 10U) return 0; //Same limit as TIM_startPeriodic(), checked before timerCalculation()
+
+	SAMPLER_stop();
+
+	samplerSpi = config.SPIx;
+	samplerTimer = timer;
+	samplerLen = len;
+	samplerCallback = callback;
+	samplerContext = context;
+
+	samplerTx[0] = command;
+	for(uint8_t i = 1; i <= len; i++) samplerTx[i] = 0xFF;
+
+	samplerHead = 0;
+	samplerTail = 0;
+	samplerInFlight = false;
+
+	(void)DWT_init();
+	SPI_DMA_init(config);
+
+	//Nominal spacing from the PSC/ARR the timer will really run with, not the rounded rate
+	TIM_Cal_t timConfig = timerCalculation(TIM_getAPB1TimerClock(), rateHz, 0xFFFF);
+	uint64_t timerTicks = (uint64_t)(timConfig.psc + 1U) * (timConfig.arr + 1U);
+	samplerStats.periodCycles = (uint32_t)((timerTicks * RCC_getHCLKFreq()) / TIM_getAPB1TimerClock());
+	SAMPLER_resetStats();
+
+	samplerRunning = true;
+	uint32_t actualHz = TIM_startPeriodic(timer, rateHz, SAMPLER_tick);
+	if(actualHz == 0) samplerRunning = false;
+	return actualHz;
+}
+
+
+/*
+ * @brief	Stop the timer; a read already on the bus still completes into the ring
+ */
+void SAMPLER_stop(void){
+	if(!samplerRunning) return;
+	samplerRunning = false;
+	TIM_stopPeriodic(samplerTimer);
+}
+
+
+uint16_t SAMPLER_available(void){
+	return (uint16_t)((samplerHead - samplerTail) & (SAMPLER_RING_SIZE - 1U));
+}
+
+
+/*
+ * @brief	Copy up to @p maxSamples samples out of the ring, oldest first
+ *
+ * @return	Number of samples copied
+ */
+uint16_t SAMPLER_read(SAMPLER_Sample_t* samples, uint16_t maxSamples){
+	if(samples == NULL) return 0;
+
+	uint16_t count = 0;
+	while(count < maxSamples && samplerTail != samplerHead){
+		samples[count++] = samplerRing[samplerTail];
+		samplerTail = (uint16_t)((samplerTail + 1U) & (SAMPLER_RING_SIZE - 1U));
+	}
+	return count;
+}
+
+
+SAMPLER_Stats_t SAMPLER_getStats(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	SAMPLER_Stats_t stats = samplerStats;
+	if(samplerJitterCount == 0){
+		stats.jitterMin = 0;
+		stats.jitterMax = 0;
+		stats.jitterMean = 0;
+	}
+	else stats.jitterMean = (uint32_t)(samplerJitterSum / samplerJitterCount);
+	__set_PRIMASK(primask);
+	return stats;
+}
+
+
+/*
+ * @brief	Clear counters and jitter extremes, the nominal period is kept
+ *
+ * 			The next tick only re-arms the spacing measurement, so a reset from a slow
+ * 			main loop does not show up as one long interval.
+ */
+void SAMPLER_resetStats(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t periodCycles = samplerStats.periodCycles;
+	samplerStats = (SAMPLER_Stats_t){0};
+	samplerStats.periodCycles = periodCycles;
+	samplerStats.jitterMin = INT32_MAX;
+	samplerStats.jitterMax = INT32_MIN;
+	samplerJitterSum = 0;
+	samplerJitterCount = 0;
+	samplerHaveTick = false;
+	__set_PRIMASK(primask);
+}
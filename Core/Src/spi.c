@@ -5,7 +5,141 @@
  *      Author: dobao
  */
 
+#include <string.h>
 #include "spi.h"
+#include "l3gd20.h"
+
+#define SPI_PORT_COUNT	5U
+#define SPI_SLAVE_DRAIN_LOOPS	64U	//Bound on the wait for the DMA to pick up the last byte of a frame
+
+
+/*
+ * ------------------------------------------------------------
+ * DMA Full-Duplex Transfer
+ * ------------------------------------------------------------
+ * Every transfer runs both streams: TX feeds DR, RX empties it. RX is the last one to finish,
+ * so its transfer-complete IRQ ends the transfer, releases NSS and raises the callback.
+ * A NULL tx buffer clocks out 0xFF, a NULL rx buffer sinks into one dummy byte (MINC off).
+ * The stream data size follows CR1.DFF, so 16-bit frames move one half-word per request.
+ */
+typedef struct{
+	SPI_GPIO_Config_t config;
+	volatile bool busy;
+	bool ready;
+	bool txMemIncrement;
+	bool rxMemIncrement;
+	DMA_DataSize_t dataSize;
+	SPI_TransferCallback_t callback;
+	void* context;
+}SPI_DMAState_t;
+
+static SPI_DMAState_t spiDma[SPI_PORT_COUNT];
+static SPI_CRCStats_t spiCrcStats[SPI_PORT_COUNT];
+
+static const uint16_t spiDmaDummyTx = 0xFFFF;
+static uint16_t spiDmaDummyRx;
+
+/*
+ * @brief	SPIx_RX / SPIx_TX request mapping (RM0383 Table 27/28)
+ * 			SPI1: RX DMA2 S0 ch3, TX DMA2 S3 ch3
+ * 			SPI2: RX DMA1 S3 ch0, TX DMA1 S4 ch0
+ * 			SPI3: RX DMA1 S0 ch0, TX DMA1 S7 ch0
+ * 			SPI4: RX DMA2 S0 ch4, TX DMA2 S1 ch4
+ * 			SPI5: RX DMA2 S3 ch2, TX DMA2 S4 ch2
+ *
+ * @note	SPI1/SPI4 share DMA2 S0 and SPI1/SPI5 share DMA2 S3, so only one of each pair can use
+ * 			DMA at a time. SPI4 TX (DMA2 S1) collides with USART6 DMA RX.
+ */
+static const DMA_Config_t SPI_DMA_RX_CONFIG[SPI_PORT_COUNT] = {
+		[my_SPI1] = {.dma = my_DMA2, .stream = DMA_STREAM0, .channel = 3, .direction = DMA_PERIPH_TO_MEM,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true},
+		[my_SPI2] = {.dma = my_DMA1, .stream = DMA_STREAM3, .channel = 0, .direction = DMA_PERIPH_TO_MEM,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true},
+		[my_SPI3] = {.dma = my_DMA1, .stream = DMA_STREAM0, .channel = 0, .direction = DMA_PERIPH_TO_MEM,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true},
+		[my_SPI4] = {.dma = my_DMA2, .stream = DMA_STREAM0, .channel = 4, .direction = DMA_PERIPH_TO_MEM,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true},
+		[my_SPI5] = {.dma = my_DMA2, .stream = DMA_STREAM3, .channel = 2, .direction = DMA_PERIPH_TO_MEM,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true},
+};
+
+static const DMA_Config_t SPI_DMA_TX_CONFIG[SPI_PORT_COUNT] = {
+		[my_SPI1] = {.dma = my_DMA2, .stream = DMA_STREAM3, .channel = 3, .direction = DMA_MEM_TO_PERIPH,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_MEDIUM, .memIncrement = true},
+		[my_SPI2] = {.dma = my_DMA1, .stream = DMA_STREAM4, .channel = 0, .direction = DMA_MEM_TO_PERIPH,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_MEDIUM, .memIncrement = true},
+		[my_SPI3] = {.dma = my_DMA1, .stream = DMA_STREAM7, .channel = 0, .direction = DMA_MEM_TO_PERIPH,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_MEDIUM, .memIncrement = true},
+		[my_SPI4] = {.dma = my_DMA2, .stream = DMA_STREAM1, .channel = 4, .direction = DMA_MEM_TO_PERIPH,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_MEDIUM, .memIncrement = true},
+		[my_SPI5] = {.dma = my_DMA2, .stream = DMA_STREAM4, .channel = 2, .direction = DMA_MEM_TO_PERIPH,
+					 .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_MEDIUM, .memIncrement = true},
+};
+
+
+/*
+ * ------------------------------------------------------------
+ * Interrupt-Driven Transfer
+ * ------------------------------------------------------------
+ * One frame in flight: the start call writes frame 0, every RXNE interrupt stores the received
+ * frame and writes the next one. TXE is set long before RXNE, so the next write never waits and
+ * the receiver can never overrun, whatever the interrupt latency.
+ */
+typedef struct{
+	SPI_Transaction_t transaction;
+	volatile uint16_t txIndex;
+	volatile uint16_t rxIndex;
+	volatile bool busy;
+}SPI_ITState_t;
+
+static SPI_ITState_t spiIt[SPI_PORT_COUNT];
+
+
+/*
+ * ------------------------------------------------------------
+ * Slave Circular DMA Receive
+ * ------------------------------------------------------------
+ * The RX stream runs circular and never stops. The master frames its data with NSS: the NSS
+ * rising edge (EXTI on the same pin) marks the end of a frame, whose bytes are copied out of the
+ * circular buffer into the next free slot of a single-producer/single-consumer queue.
+ * head is only written by the EXTI handler, tail only by SPI_slaveReleaseFrame().
+ * Half/full-transfer interrupts count buffer halves so a frame longer than the ring is detected.
+ */
+typedef struct{
+	uint8_t data[SPI_SLAVE_MAX_FRAME];
+	uint16_t len;
+}SPI_SlaveFrame_t;
+
+typedef struct{
+	uint8_t ring[SPI_SLAVE_RX_BUFFER_SIZE];
+	uint16_t frameStart;				//Ring index of the first byte of the current frame
+	volatile uint8_t halvesSinceStart;	//HT/TC events since frameStart
+
+	SPI_SlaveFrame_t queue[SPI_SLAVE_QUEUE_DEPTH];
+	volatile uint8_t head;
+	volatile uint8_t tail;
+
+	SPI_GPIO_Config_t config;
+	bool running;
+	volatile SPI_SlaveStats_t stats;
+}SPI_SlaveRx_t;
+
+static SPI_SlaveRx_t spiSlave; //One slave receiver at a time
+
+
+/*
+ * @brief	Map SPI name to its register block
+ */
+static volatile SPI_Register_Offset_t* getSPIReg(SPI_Name_t SPIx){
+	switch(SPIx){
+		case my_SPI1: return SPI1_REG;
+		case my_SPI2: return SPI2_REG;
+		case my_SPI3: return SPI3_REG;
+		case my_SPI4: return SPI4_REG;
+		case my_SPI5: return SPI5_REG;
+		default: return NULL;
+	}
+}
 
 
 /*
@@ -53,6 +187,159 @@ char SPI_readReceivedData(SPI_GPIO_Config_t config,
 
 
 
+/*
+ * @brief	Clock one byte out and return the byte clocked in at the same time
+ *
+ * 			TXE is checked before writing and RXNE after, so the RX side never overruns
+ * 			and the caller can keep the bus busy without a BSY wait per byte.
+ */
+static uint8_t SPI_transferByte(SPI_Name_t SPIx, uint8_t txByte){
+	while(readSPI(1, SPIx, SPI_SR) == 0); //Wait until TX buffer is empty
+	writeSPI(0, SPIx, SPI_DR, txByte);
+	while(readSPI(0, SPIx, SPI_SR) == 0); //Wait until RX buffer holds the answer
+	return (uint8_t)readSPI(0, SPIx, SPI_DR);
+}
+
+
+
+/*
+ * @brief	Polled full-duplex loop over whole frames, one frame in flight
+ * 			SR is read with a single register access per poll instead of one readSPI() per flag
+ */
+static inline uint16_t SPI_transferFrame(SPI_Name_t SPIx, uint16_t txFrame){
+	while((SPI_readRegister(SPIx, SPI_SR) & (1U << 1)) == 0); //TXE
+	SPI_writeRegister(SPIx, SPI_DR, txFrame);
+	while((SPI_readRegister(SPIx, SPI_SR) & (1U << 0)) == 0); //RXNE
+	return (uint16_t)SPI_readRegister(SPIx, SPI_DR);
+}
+
+
+/*
+ * @brief	Switch CR1.DFF, only legal while SPE = 0 (no-op when already in that mode)
+ */
+static void SPI_setFrameSize(SPI_Name_t SPIx, SPI_DFF_t frameSize){
+	uint32_t cr1 = SPI_readRegister(SPIx, SPI_CR1);
+	uint32_t wanted = (frameSize == DFF_16BITS) ? (cr1 | (1U << 11)) : (cr1 & ~(1U << 11));
+	if(wanted == cr1) return;
+
+	while(readSPI(7, SPIx, SPI_SR) == 1); //BSY
+	SPI_writeRegister(SPIx, SPI_CR1, cr1 & ~(1U << 6)); //SPE off
+	SPI_writeRegister(SPIx, SPI_CR1, wanted & ~(1U << 6));
+	SPI_writeRegister(SPIx, SPI_CR1, wanted);
+}
+
+
+
+/*
+ * @brief	Polled full-duplex buffer transfer with 8-bit frames under one NSS assertion
+ *
+ * @param	txBuf	Bytes to send, NULL clocks out 0xFF
+ * @param	rxBuf	Receives @p len bytes, may be NULL
+ */
+void SPI_transfer8(SPI_GPIO_Config_t config, const uint8_t* txBuf, uint8_t* rxBuf, uint16_t len){
+	if(len == 0) return;
+
+	SPI_setFrameSize(config.SPIx, DFF_8BITS);
+	while(readSPI(0, config.SPIx, SPI_SR) == 1) (void)readSPI(0, config.SPIx, SPI_DR);
+	writePin(config.nssPin, config.nssPort, BSRR, my_GPIO_PIN_RESET);
+
+	for(uint16_t i = 0; i < len; i++){
+		uint8_t data = (uint8_t)SPI_transferFrame(config.SPIx, (txBuf != NULL) ? txBuf[i] : 0xFF);
+		if(rxBuf != NULL) rxBuf[i] = data;
+	}
+
+	while(readSPI(7, config.SPIx, SPI_SR) == 1);
+	writePin(config.nssPin, config.nssPort, BSRR, my_GPIO_PIN_SET);
+}
+
+
+
+/*
+ * @brief	Polled full-duplex buffer transfer packed into 16-bit frames
+ *
+ * 			Two bytes per DR access and per flag poll. SPI shifts every frame MSB first:
+ * 				SPI_PACK_BIG_ENDIAN		buf[0] is the high byte, the wire sees exactly the same byte
+ * 										order as SPI_transfer8() (byte streams, flash, displays)
+ * 				SPI_PACK_LITTLE_ENDIAN	buf is a native uint16_t array (DAC/ADC words)
+ * 			An odd trailing byte is sent as one 8-bit frame inside the same NSS assertion.
+ * 			CR1.DFF is restored to 8 bits afterwards.
+ *
+ * @param	txBuf	Bytes to send, NULL clocks out all ones
+ * @param	rxBuf	Receives @p len bytes in the same packing, may be NULL
+ * @param	len		Number of bytes
+ */
+void SPI_transfer16(SPI_GPIO_Config_t config, const uint8_t* txBuf, uint8_t* rxBuf, uint16_t len, SPI_PackOrder_t order){
+	if(len == 0) return;
+
+	const uint8_t HI = (order == SPI_PACK_BIG_ENDIAN) ? 0 : 1; //Index of the byte that goes out first
+	const uint8_t LO = (uint8_t)(1U - HI);
+	uint16_t words = len / 2;
+
+	SPI_setFrameSize(config.SPIx, DFF_16BITS);
+	while(readSPI(0, config.SPIx, SPI_SR) == 1) (void)readSPI(0, config.SPIx, SPI_DR);
+	writePin(config.nssPin, config.nssPort, BSRR, my_GPIO_PIN_RESET);
+
+	for(uint16_t w = 0; w < words; w++){
+		uint16_t frame = 0xFFFF;
+		if(txBuf != NULL) frame = (uint16_t)((txBuf[2 * w + HI] << 8) | txBuf[2 * w + LO]);
+
+		frame = SPI_transferFrame(config.SPIx, frame);
+
+		if(rxBuf != NULL){
+			rxBuf[2 * w + HI] = (uint8_t)(frame >> 8);
+			rxBuf[2 * w + LO] = (uint8_t)(frame & 0xFF);
+		}
+	}
+
+	if(len & 1U){
+		SPI_setFrameSize(config.SPIx, DFF_8BITS); //Waits for BSY, NSS stays low
+		uint8_t data = (uint8_t)SPI_transferFrame(config.SPIx, (txBuf != NULL) ? txBuf[len - 1] : 0xFF);
+		if(rxBuf != NULL) rxBuf[len - 1] = data;
+	}
+
+	while(readSPI(7, config.SPIx, SPI_SR) == 1);
+	writePin(config.nssPin, config.nssPort, BSRR, my_GPIO_PIN_SET);
+	SPI_setFrameSize(config.SPIx, DFF_8BITS);
+}
+
+
+
+/*
+ *	@brief		Read consecutive registers of an SPI slave in one chip-select assertion
+ *				The address byte carries the read bit (0x80) and the L3GD20 multi-byte bit (0x40),
+ *				so the slave increments its register pointer after every byte. Reading
+ *				STATUS_REG + OUT_X_L..OUT_Z_H (7 bytes) costs one transaction instead of seven.
+ *
+ *	@param		config			SPI peripheral and pin mapping
+ *	@param		startAddr		First register to read (6-bit address)
+ *	@param		buffer			Receives @p len bytes, buffer[0] is the register at @p startAddr
+ *	@param		len				Number of registers to read
+ *
+ *	@note		The L3GD20 accepts SCK up to 10MHz.
+ */
+void SPI_burstRead(SPI_GPIO_Config_t config, uint8_t startAddr, uint8_t* buffer, uint16_t len){
+	const uint8_t DUMMYBYTE = 0xFF;
+
+	if(buffer == NULL || len == 0) return;
+
+	writePin(config.nssPin, config.nssPort, BSRR, my_GPIO_PIN_RESET); //Select the slave
+
+	while(readSPI(0, config.SPIx, SPI_SR) == 1) (void)readSPI(0, config.SPIx, SPI_DR); //Drop a stale byte so the first answer lines up
+
+	uint8_t cmd = (uint8_t)((startAddr & L3GD20_SPI_ADDR_MASK) | L3GD20_SPI_READ);
+	if(len > 1) cmd |= L3GD20_SPI_MULTIBYTE; //MS bit: the slave auto-increments the register address
+	(void)SPI_transferByte(config.SPIx, cmd); //Byte clocked in during the address phase is meaningless
+
+	for(uint16_t i = 0; i < len; i++){
+		buffer[i] = SPI_transferByte(config.SPIx, DUMMYBYTE);
+	}
+
+	while(readSPI(7, config.SPIx, SPI_SR) == 1); //Last bit must leave the shift register before NSS goes high
+	writePin(config.nssPin, config.nssPort, BSRR, my_GPIO_PIN_SET); //Release the slave
+}
+
+
+
 /*
  *
  */
@@ -291,6 +578,16 @@ void writeSPI(uint8_t bitPosition, SPI_Name_t userSPIx, SPI_Mode_t mode, uint32_
 		default: return;
 	}
 
+	/*
+	 * DR is not a memory cell: reading it returns the RX buffer, so a read-modify-write would
+	 * OR the last received frame into the one being sent. Frames are written whole.
+	 */
+	if(mode == SPI_DR){
+		*reg = value & 0xFFFF;
+		SIM_REG_WRITTEN(SPIx_p, reg);
+		return;
+	}
+
 	uint32_t bitWidth = 0;
 	uint32_t temp = value;
 
@@ -306,6 +603,7 @@ void writeSPI(uint8_t bitPosition, SPI_Name_t userSPIx, SPI_Mode_t mode, uint32_
 	uint32_t mask = ((1U << bitWidth) - 1U) << bitPosition;
 	uint32_t shiftedValue = (value << bitPosition) & mask;
 	*reg = (*reg & ~mask) | shiftedValue;
+	SIM_REG_WRITTEN(SPIx_p, reg);
 }
 
 
@@ -364,6 +662,8 @@ uint16_t readSPI(uint8_t bitPosition, SPI_Name_t userSPIx, SPI_Mode_t mode){
 		default: return ERROR_FLAG;
 	}
 
+	SIM_REG_READ(SPIx_p, reg);
+
 	/*
 	 * Condition to check if the Data Frame is 8 bits or 16 bits
 	 */
@@ -396,3 +696,681 @@ uint16_t readSPI(uint8_t bitPosition, SPI_Name_t userSPIx, SPI_Mode_t mode){
 	return((*reg >> bitPosition) & 0x1); // return 1 or 0
 }
 
+
+
+/*
+ * ------------------------------------------------------------
+ * Hardware CRC
+ * ------------------------------------------------------------
+ * CR1.CRCEN (bit 13) runs the TX and RX CRC calculators over every frame, CRCPR holds the
+ * polynomial. After the last data frame the master sends TXCRCR (CRCNEXT, bit 12, or
+ * automatically under DMA) and compares the frame it receives at the same time against RXCRCR;
+ * a mismatch sets SR.CRCERR (bit 4, rc_w0). The received CRC is left in DR and must be flushed.
+ * CRCEN may only change while SPE = 0, and toggling it is the only way to clear both CRC registers,
+ * so every protected transfer starts with a short SPE off/on cycle.
+ */
+
+/*
+ * @brief	Clear TXCRCR/RXCRCR for a new transfer (idle bus only)
+ */
+static void SPI_CRC_restart(SPI_Name_t SPIx){
+	uint32_t cr1 = SPI_readRegister(SPIx, SPI_CR1);
+	uint32_t base = cr1 & ~((1U << 6) | (1U << 12) | (1U << 13)); //SPE, CRCNEXT, CRCEN off
+
+	while(readSPI(7, SPIx, SPI_SR) == 1); //BSY
+	SPI_writeRegister(SPIx, SPI_CR1, base);
+	SPI_writeRegister(SPIx, SPI_CR1, base | (1U << 13));
+	SPI_writeRegister(SPIx, SPI_CR1, base | (1U << 13) | (cr1 & (1U << 6)));
+}
+
+
+/*
+ * @brief	Flush the received CRC frame and read the verdict
+ *
+ * @return	true if the peer's CRC matched RXCRCR (CRCERR clear)
+ */
+static bool SPI_CRC_check(SPI_Name_t SPIx){
+	while(readSPI(0, SPIx, SPI_SR) == 0); //RXNE: CRC frame
+	(void)SPI_readRegister(SPIx, SPI_DR);
+	while(readSPI(7, SPIx, SPI_SR) == 1); //BSY
+	writeSPI(12, SPIx, SPI_CR1, 0); //Back to the data phase
+
+	bool ok = (readSPI(4, SPIx, SPI_SR) == 0);
+	if(!ok){
+		writeSPI(4, SPIx, SPI_SR, 0); //Clear CRCERR
+		spiCrcStats[SPIx].errors++;
+	}
+	spiCrcStats[SPIx].transfers++;
+	return ok;
+}
+
+
+static inline bool SPI_CRC_enabled(SPI_Name_t SPIx){
+	return (SPI_readRegister(SPIx, SPI_CR1) & (1U << 13)) != 0;
+}
+
+
+/*
+ * @brief	Program the CRC polynomial and turn the hardware CRC on
+ *
+ * 			Both ends of the link must use the same polynomial and frame size. The CRC width
+ * 			follows CR1.DFF: CRC8 for 8-bit frames, CRC16 for 16-bit frames.
+ *
+ * @param	polynomial	Odd polynomial, e.g. 0x07 (CRC-8/ATM) or 0x1021 (CRC-16/CCITT)
+ *
+ * @return	false on an even polynomial or while a DMA/interrupt transfer owns the bus
+ *
+ * @note	The SPI_BUS manager writes whole CR1 images and does not carry CRCEN.
+ */
+bool SPI_CRC_enable(SPI_Name_t SPIx, uint16_t polynomial){
+	if(getSPIReg(SPIx) == NULL || (polynomial & 1U) == 0) return false;
+	if(spiDma[SPIx].busy || spiIt[SPIx].busy) return false;
+
+	uint32_t cr1 = SPI_readRegister(SPIx, SPI_CR1);
+
+	while(readSPI(7, SPIx, SPI_SR) == 1); //BSY
+	SPI_writeRegister(SPIx, SPI_CR1, cr1 & ~(1U << 6));
+	SPI_writeRegister(SPIx, SPI_CRC, polynomial);
+	SPI_writeRegister(SPIx, SPI_CR1, (cr1 & ~((1U << 6) | (1U << 12))) | (1U << 13));
+	SPI_writeRegister(SPIx, SPI_CR1, (cr1 & ~(1U << 12)) | (1U << 13));
+
+	spiCrcStats[SPIx] = (SPI_CRCStats_t){0};
+	return true;
+}
+
+
+void SPI_CRC_disable(SPI_Name_t SPIx){
+	if(getSPIReg(SPIx) == NULL || spiDma[SPIx].busy || spiIt[SPIx].busy) return;
+
+	uint32_t cr1 = SPI_readRegister(SPIx, SPI_CR1);
+
+	while(readSPI(7, SPIx, SPI_SR) == 1); //BSY
+	SPI_writeRegister(SPIx, SPI_CR1, cr1 & ~(1U << 6));
+	SPI_writeRegister(SPIx, SPI_CR1, cr1 & ~((1U << 6) | (1U << 12) | (1U << 13)));
+	SPI_writeRegister(SPIx, SPI_CR1, cr1 & ~((1U << 12) | (1U << 13)));
+}
+
+
+/*
+ * @brief	Polled full-duplex transfer followed by one CRC frame, under one NSS assertion
+ *
+ * 			Frames follow CR1.DFF like the DMA engine. CRCNEXT is set right after the last data
+ * 			frame is written to DR, so the CRC goes out back to back with the data.
+ *
+ * @param	txBuf	Frames to send (uint8_t, or uint16_t when CR1.DFF = 1), NULL clocks out all ones
+ * @param	rxBuf	Receives @p len data frames (the CRC frame is not stored), may be NULL
+ *
+ * @return	false on a CRC mismatch, or when the CRC is not enabled
+ */
+bool SPI_transferCRC(SPI_GPIO_Config_t config, const void* txBuf, void* rxBuf, uint16_t len){
+	SPI_Name_t SPIx = config.SPIx;
+	if(getSPIReg(SPIx) == NULL || len == 0 || !SPI_CRC_enabled(SPIx)) return false;
+	if(spiDma[SPIx].busy || spiIt[SPIx].busy) return false;
+
+	bool is16Bit = (readSPI(11, SPIx, SPI_CR1) == 1);
+
+	SPI_CRC_restart(SPIx);
+	while(readSPI(0, SPIx, SPI_SR) == 1) (void)readSPI(0, SPIx, SPI_DR);
+	writePin(config.nssPin, config.nssPort, BSRR, my_GPIO_PIN_RESET);
+
+	for(uint16_t i = 0; i < len; i++){
+		uint16_t frame = 0xFFFF;
+		if(txBuf != NULL) frame = is16Bit ? ((const uint16_t*)txBuf)[i] : ((const uint8_t*)txBuf)[i];
+
+		while((SPI_readRegister(SPIx, SPI_SR) & (1U << 1)) == 0); //TXE
+		SPI_writeRegister(SPIx, SPI_DR, frame);
+		if(i == len - 1) writeSPI(12, SPIx, SPI_CR1, 1); //CRCNEXT
+
+		while((SPI_readRegister(SPIx, SPI_SR) & (1U << 0)) == 0); //RXNE
+		frame = (uint16_t)SPI_readRegister(SPIx, SPI_DR);
+
+		if(rxBuf != NULL){
+			if(is16Bit) ((uint16_t*)rxBuf)[i] = frame;
+			else ((uint8_t*)rxBuf)[i] = (uint8_t)frame;
+		}
+	}
+
+	bool ok = SPI_CRC_check(SPIx);
+	writePin(config.nssPin, config.nssPort, BSRR, my_GPIO_PIN_SET);
+	return ok;
+}
+
+
+SPI_CRCStats_t SPI_CRC_getStats(SPI_Name_t SPIx){
+	if(getSPIReg(SPIx) == NULL) return (SPI_CRCStats_t){0};
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	SPI_CRCStats_t stats = spiCrcStats[SPIx];
+	__set_PRIMASK(primask);
+	return stats;
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * DMA Transfer API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Stop both streams, drop the DMA requests and release the slave
+ */
+static void SPI_DMA_finish(SPI_Name_t SPIx, bool ok){
+	SPI_DMAState_t* state = &spiDma[SPIx];
+
+	DMA_streamStop(SPI_DMA_TX_CONFIG[SPIx].dma, SPI_DMA_TX_CONFIG[SPIx].stream);
+	DMA_streamStop(SPI_DMA_RX_CONFIG[SPIx].dma, SPI_DMA_RX_CONFIG[SPIx].stream);
+
+	if(ok && SPI_CRC_enabled(SPIx)) ok = SPI_CRC_check(SPIx); //CRC frame follows the last data frame
+	while(readSPI(7, SPIx, SPI_SR) == 1); //RXNE of the last byte implies BSY is about to drop
+	writeSPI(1, SPIx, SPI_CR2, 0); //TXDMAEN
+	writeSPI(0, SPIx, SPI_CR2, 0); //RXDMAEN
+	writePin(state -> config.nssPin, state -> config.nssPort, BSRR, my_GPIO_PIN_SET);
+
+	state -> busy = false;
+	if(state -> callback != NULL) state -> callback(SPIx, ok, state -> context);
+}
+
+
+/*
+ * @brief	RX stream IRQ: the last byte has been received (or a stream failed)
+ */
+static void SPI_DMA_rxEvent(uint8_t events, void* context){
+	SPI_Name_t SPIx = (SPI_Name_t)(uintptr_t)context;
+	if(!spiDma[SPIx].busy) return;
+
+	if(events & DMA_EVENT_ERROR) SPI_DMA_finish(SPIx, false);
+	else if(events & DMA_EVENT_COMPLETE) SPI_DMA_finish(SPIx, true);
+}
+
+
+/*
+ * @brief	TX stream IRQ: completion is ignored (RX finishes the transfer), errors abort it
+ */
+static void SPI_DMA_txEvent(uint8_t events, void* context){
+	SPI_Name_t SPIx = (SPI_Name_t)(uintptr_t)context;
+	if(spiDma[SPIx].busy && (events & DMA_EVENT_ERROR)) SPI_DMA_finish(SPIx, false);
+}
+
+
+/*
+ * @brief	(Re)program one stream when its memory increment mode or frame size has to change
+ */
+static void SPI_DMA_setupStream(const DMA_Config_t* base, SPI_Name_t SPIx, bool memIncrement,
+								DMA_DataSize_t dataSize, DMA_Callback_t event){
+	DMA_Config_t cfg = *base;
+	cfg.memIncrement = memIncrement;
+	cfg.dataSize = dataSize;
+	DMA_streamInit(&cfg, &getSPIReg(SPIx) -> SPI_DR, event, (void*)(uintptr_t)SPIx);
+}
+
+
+/*
+ * @brief	Attach an SPI master to its RX/TX DMA streams (call after SPI_basicConfigInit)
+ *
+ * @param	config	Peripheral and NSS pin, NSS is driven by the engine for every transfer
+ */
+void SPI_DMA_init(SPI_GPIO_Config_t config){
+	if(getSPIReg(config.SPIx) == NULL) return;
+
+	SPI_DMAState_t* state = &spiDma[config.SPIx];
+	state -> config = config;
+	state -> busy = false;
+	state -> callback = NULL;
+	state -> context = NULL;
+	state -> txMemIncrement = true;
+	state -> rxMemIncrement = true;
+	state -> dataSize = DMA_SIZE_8BITS;
+
+	SPI_DMA_setupStream(&SPI_DMA_RX_CONFIG[config.SPIx], config.SPIx, true, DMA_SIZE_8BITS, SPI_DMA_rxEvent);
+	SPI_DMA_setupStream(&SPI_DMA_TX_CONFIG[config.SPIx], config.SPIx, true, DMA_SIZE_8BITS, SPI_DMA_txEvent);
+	state -> ready = true;
+}
+
+
+/*
+ * @brief	Start a full-duplex transfer of @p len frames under one NSS assertion
+ *
+ * @param	txBuf		Frames to send (uint8_t, or uint16_t when CR1.DFF = 1), or NULL to clock out all ones
+ * @param	rxBuf		Receives @p len frames, or NULL to discard what comes back
+ * @param	callback	Raised from the DMA IRQ once NSS is released (may be NULL)
+ * @param	context		Handed back to @p callback
+ *
+ * @return	false if the engine is not initialized, still busy, or @p len is 0.
+ * 			Both buffers must stay valid until the callback (or SPI_DMA_busy() == false).
+ */
+bool SPI_DMA_transfer(SPI_Name_t SPIx, const void* txBuf, void* rxBuf, uint16_t len,
+					  SPI_TransferCallback_t callback, void* context){
+	if(getSPIReg(SPIx) == NULL || len == 0) return false;
+
+	SPI_DMAState_t* state = &spiDma[SPIx];
+	if(!state -> ready || state -> busy || spiIt[SPIx].busy) return false;
+
+	const DMA_Config_t* rxCfg = &SPI_DMA_RX_CONFIG[SPIx];
+	const DMA_Config_t* txCfg = &SPI_DMA_TX_CONFIG[SPIx];
+
+	//Streams are only reprogrammed when switching between real/dummy buffers or 8/16-bit frames
+	DMA_DataSize_t dataSize = (readSPI(11, SPIx, SPI_CR1) == 1) ? DMA_SIZE_16BITS : DMA_SIZE_8BITS;
+	bool sizeChanged = (dataSize != state -> dataSize);
+	state -> dataSize = dataSize;
+
+	if(sizeChanged || (rxBuf != NULL) != state -> rxMemIncrement){
+		state -> rxMemIncrement = (rxBuf != NULL);
+		SPI_DMA_setupStream(rxCfg, SPIx, state -> rxMemIncrement, dataSize, SPI_DMA_rxEvent);
+	}
+	if(sizeChanged || (txBuf != NULL) != state -> txMemIncrement){
+		state -> txMemIncrement = (txBuf != NULL);
+		SPI_DMA_setupStream(txCfg, SPIx, state -> txMemIncrement, dataSize, SPI_DMA_txEvent);
+	}
+
+	state -> callback = callback;
+	state -> context = context;
+	state -> busy = true;
+
+	//With CRCEN the hardware appends TXCRCR after the last TX request by itself, no CRCNEXT needed
+	if(SPI_CRC_enabled(SPIx)) SPI_CRC_restart(SPIx);
+
+	while(readSPI(0, SPIx, SPI_SR) == 1) (void)readSPI(0, SPIx, SPI_DR); //Stale byte would be the first one DMA reads
+	(void)readSPI(6, SPIx, SPI_SR); //DR then SR read clears OVR
+
+	writePin(state -> config.nssPin, state -> config.nssPort, BSRR, my_GPIO_PIN_RESET);
+
+	//RM0383 order: RX request first so no received byte is missed, then TX starts the clock
+	DMA_streamStart(rxCfg -> dma, rxCfg -> stream, (rxBuf != NULL) ? rxBuf : &spiDmaDummyRx, len);
+	writeSPI(0, SPIx, SPI_CR2, 1); //RXDMAEN
+	DMA_streamStart(txCfg -> dma, txCfg -> stream, (txBuf != NULL) ? txBuf : &spiDmaDummyTx, len);
+	writeSPI(1, SPIx, SPI_CR2, 1); //TXDMAEN
+	return true;
+}
+
+
+/*
+ * @brief	Move the chip select driven by the DMA engine to another pin (bus manager, idle bus only)
+ */
+void SPI_DMA_setChipSelect(SPI_Name_t SPIx, GPIO_Pin_t nssPin, GPIO_PortName_t nssPort){
+	if(getSPIReg(SPIx) == NULL || spiDma[SPIx].busy) return;
+	spiDma[SPIx].config.nssPin = nssPin;
+	spiDma[SPIx].config.nssPort = nssPort;
+}
+
+
+/*
+ * @brief	true while a DMA transfer owns the bus
+ */
+bool SPI_DMA_busy(SPI_Name_t SPIx){
+	if(getSPIReg(SPIx) == NULL) return false;
+	return spiDma[SPIx].busy;
+}
+
+
+
+/*
+ * @brief	Write a whole SPI register in one access (e.g. a full CR1 image)
+ * 			writeSPI() only touches the bit field sized after its value
+ */
+void SPI_writeRegister(SPI_Name_t SPIx, SPI_Mode_t mode, uint32_t value){
+	volatile SPI_Register_Offset_t* SPIx_p = getSPIReg(SPIx);
+	if(SPIx_p == NULL) return;
+
+	volatile uint32_t* reg;
+	switch(mode){
+		case SPI_CR1: reg = &SPIx_p -> SPI_CR1; break;
+		case SPI_CR2: reg = &SPIx_p -> SPI_CR2; break;
+		case SPI_SR: reg = &SPIx_p -> SPI_SR; break;
+		case SPI_DR: reg = &SPIx_p -> SPI_DR; break;
+		case SPI_CRC: reg = &SPIx_p -> SPI_CRC; break;
+		case SPI_I2SCFGR: reg = &SPIx_p -> SPI_I2SCFGR; break;
+		case SPI_I2SPR: reg = &SPIx_p -> SPI_I2SPR; break;
+		default: return; //RXCRCR/TXCRCR are read only
+	}
+
+	*reg = value;
+	SIM_REG_WRITTEN(SPIx_p, reg);
+}
+
+
+/*
+ * @brief	Read a whole SPI register in one access
+ */
+uint32_t SPI_readRegister(SPI_Name_t SPIx, SPI_Mode_t mode){
+	volatile SPI_Register_Offset_t* SPIx_p = getSPIReg(SPIx);
+	if(SPIx_p == NULL) return 0;
+
+	volatile uint32_t* reg;
+	switch(mode){
+		case SPI_CR1: reg = &SPIx_p -> SPI_CR1; break;
+		case SPI_CR2: reg = &SPIx_p -> SPI_CR2; break;
+		case SPI_SR: reg = &SPIx_p -> SPI_SR; break;
+		case SPI_DR: reg = &SPIx_p -> SPI_DR; break;
+		case SPI_CRC: reg = &SPIx_p -> SPI_CRC; break;
+		case SPI_RXCRCR: reg = &SPIx_p -> SPI_RXCRCR; break;
+		case SPI_TXCRCR: reg = &SPIx_p -> SPI_TXCRCR; break;
+		case SPI_I2SCFGR: reg = &SPIx_p -> SPI_I2SCFGR; break;
+		case SPI_I2SPR: reg = &SPIx_p -> SPI_I2SPR; break;
+		default: return 0;
+	}
+
+	SIM_REG_READ(SPIx_p, reg);
+	return *reg;
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Interrupt-Driven Transfer API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Map SPI name to its NVIC line
+ */
+static IRQn_Pos_t getSPIIRQn(SPI_Name_t SPIx){
+	switch(SPIx){
+		case my_SPI1: return SPI1_user;
+		case my_SPI2: return SPI2_user;
+		case my_SPI3: return SPI3_user;
+		case my_SPI4: return SPI4_user;
+		default: return SPI5_user;
+	}
+}
+
+
+/*
+ * @brief	Mask the SPI interrupts, release the slave and report the result
+ */
+static void SPI_IT_finish(SPI_Name_t SPIx, bool ok){
+	SPI_ITState_t* state = &spiIt[SPIx];
+
+	writeSPI(5, SPIx, SPI_CR2, 0); //ERRIE
+	writeSPI(6, SPIx, SPI_CR2, 0); //RXNEIE
+
+	while(readSPI(7, SPIx, SPI_SR) == 1); //BSY
+	writePin(state -> transaction.nssPin, state -> transaction.nssPort, BSRR, my_GPIO_PIN_SET);
+
+	state -> busy = false;
+	if(state -> transaction.callback != NULL) state -> transaction.callback(SPIx, ok, state -> transaction.context);
+}
+
+
+/*
+ * @brief	Start a transaction and return at once, the SPIx IRQ moves it forward
+ *
+ * @param	transaction		Copied; its buffers must stay valid until the callback
+ *
+ * @return	false if the port is busy (interrupt or DMA transfer) or the length is 0
+ *
+ * @note	SPI must already be enabled as master with 8-bit frames (SPI_basicConfigInit)
+ */
+bool SPI_IT_start(SPI_Name_t SPIx, const SPI_Transaction_t* transaction){
+	if(getSPIReg(SPIx) == NULL || transaction == NULL || transaction -> len == 0) return false;
+
+	SPI_ITState_t* state = &spiIt[SPIx];
+	if(state -> busy || spiDma[SPIx].busy) return false;
+
+	state -> transaction = *transaction;
+	state -> txIndex = 0;
+	state -> rxIndex = 0;
+	state -> busy = true;
+
+	while(readSPI(0, SPIx, SPI_SR) == 1) (void)readSPI(0, SPIx, SPI_DR); //Stale RXNE would shift every frame by one
+	(void)readSPI(6, SPIx, SPI_SR); //DR then SR read clears OVR
+
+	writePin(transaction -> nssPin, transaction -> nssPort, BSRR, my_GPIO_PIN_RESET);
+
+	writeSPI(5, SPIx, SPI_CR2, 1); //ERRIE: OVR/MODF end the transaction
+	writeSPI(6, SPIx, SPI_CR2, 1); //RXNEIE
+	NVIC_enableIRQ(getSPIIRQn(SPIx));
+
+	uint8_t first = (transaction -> txBuf != NULL) ? transaction -> txBuf[0] : 0xFF;
+	state -> txIndex = 1;
+	SPI_writeRegister(SPIx, SPI_DR, first);
+	return true;
+}
+
+
+/*
+ * @brief	true until the callback of the current interrupt-driven transaction has run
+ */
+bool SPI_IT_busy(SPI_Name_t SPIx){
+	if(getSPIReg(SPIx) == NULL) return false;
+	return spiIt[SPIx].busy;
+}
+
+
+/*
+ * @brief	Common SPIx IRQ body, SR is read once per interrupt
+ */
+static void SPI_IRQDispatch(SPI_Name_t SPIx){
+	SPI_ITState_t* state = &spiIt[SPIx];
+	uint32_t sr = SPI_readRegister(SPIx, SPI_SR);
+
+	if(!state -> busy){ //Late interrupt after an abort, just silence it
+		writeSPI(6, SPIx, SPI_CR2, 0);
+		writeSPI(5, SPIx, SPI_CR2, 0);
+		return;
+	}
+
+	if(sr & ((1U << 6) | (1U << 5))){ //OVR or MODF
+		(void)SPI_readRegister(SPIx, SPI_DR);
+		(void)SPI_readRegister(SPIx, SPI_SR); //Clears OVR
+		SPI_IT_finish(SPIx, false);
+		return;
+	}
+
+	if(sr & (1U << 0)){ //RXNE
+		uint8_t data = (uint8_t)SPI_readRegister(SPIx, SPI_DR);
+		const SPI_Transaction_t* t = &state -> transaction;
+
+		if(t -> rxBuf != NULL) t -> rxBuf[state -> rxIndex] = data;
+		state -> rxIndex++;
+
+		if(state -> txIndex < t -> len){
+			uint8_t next = (t -> txBuf != NULL) ? t -> txBuf[state -> txIndex] : 0xFF;
+			state -> txIndex++;
+			SPI_writeRegister(SPIx, SPI_DR, next);
+		}
+		else if(state -> rxIndex >= t -> len){
+			SPI_IT_finish(SPIx, true);
+		}
+	}
+}
+
+void SPI1_IRQHandler(void){ SPI_IRQDispatch(my_SPI1); }
+void SPI2_IRQHandler(void){ SPI_IRQDispatch(my_SPI2); }
+void SPI3_IRQHandler(void){ SPI_IRQDispatch(my_SPI3); }
+void SPI4_IRQHandler(void){ SPI_IRQDispatch(my_SPI4); }
+void SPI5_IRQHandler(void){ SPI_IRQDispatch(my_SPI5); }
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Slave Receive API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Ring index the DMA will write next
+ */
+static uint16_t SPI_slaveWritePos(void){
+	const DMA_Config_t* cfg = &SPI_DMA_RX_CONFIG[spiSlave.config.SPIx];
+	uint16_t remaining = DMA_getRemaining(cfg -> dma, cfg -> stream);
+	return (uint16_t)((SPI_SLAVE_RX_BUFFER_SIZE - remaining) % SPI_SLAVE_RX_BUFFER_SIZE);
+}
+
+
+/*
+ * @brief	DMA HT/TC: only counts buffer halves, frames are cut on NSS
+ */
+static void SPI_slaveDmaEvent(uint8_t events, void* context){
+	(void)context;
+	if(events & DMA_EVENT_HALF) spiSlave.halvesSinceStart++;
+	if(events & DMA_EVENT_COMPLETE) spiSlave.halvesSinceStart++;
+	if(events & DMA_EVENT_ERROR) spiSlave.stats.dmaErrors++;
+}
+
+
+/*
+ * @brief	NSS rising edge: the master finished a frame, publish it
+ */
+static void SPI_slaveNssEvent(uint8_t line){
+	(void)line;
+	if(!spiSlave.running) return;
+
+	SPI_Name_t SPIx = spiSlave.config.SPIx;
+	for(uint8_t i = 0; i < SPI_SLAVE_DRAIN_LOOPS && readSPI(0, SPIx, SPI_SR) == 1; i++); //Last byte still in DR
+
+	uint16_t end = SPI_slaveWritePos();
+	uint16_t start = spiSlave.frameStart;
+	uint16_t len = (uint16_t)((end - start + SPI_SLAVE_RX_BUFFER_SIZE) % SPI_SLAVE_RX_BUFFER_SIZE);
+	uint8_t halves = spiSlave.halvesSinceStart;
+
+	spiSlave.frameStart = end;
+	spiSlave.halvesSinceStart = 0;
+
+	/*
+	 * len is only known modulo the ring size, so compare the HT/TC count with the half-buffer
+	 * boundaries that [start, start + len] really crosses. Every lap adds two more events;
+	 * one extra is tolerated since an HT/TC still pending behind this EXTI is counted late.
+	 */
+	uint16_t expected = (uint16_t)((start + len) / (SPI_SLAVE_RX_BUFFER_SIZE / 2U) - start / (SPI_SLAVE_RX_BUFFER_SIZE / 2U));
+	if(halves >= expected + 2U || len > SPI_SLAVE_MAX_FRAME){
+		spiSlave.stats.oversize++;
+		return;
+	}
+	if(len == 0) return;
+
+	uint8_t next = (uint8_t)((spiSlave.head + 1U) & (SPI_SLAVE_QUEUE_DEPTH - 1U));
+	if(next == spiSlave.tail){
+		spiSlave.stats.droppedFull++;
+		return;
+	}
+
+	SPI_SlaveFrame_t* slot = &spiSlave.queue[spiSlave.head];
+	uint16_t first = (uint16_t)(SPI_SLAVE_RX_BUFFER_SIZE - start);
+	if(first >= len){
+		memcpy(slot -> data, &spiSlave.ring[start], len);
+	}
+	else{
+		memcpy(slot -> data, &spiSlave.ring[start], first);
+		memcpy(&slot -> data[first], spiSlave.ring, (size_t)(len - first));
+	}
+	slot -> len = len;
+
+	__DMB(); //Slot contents must be visible before the new head
+	spiSlave.head = next;
+	spiSlave.stats.frames++;
+	spiSlave.stats.bytes += len;
+}
+
+
+/*
+ * @brief	Receive NSS-delimited frames as an SPI slave through circular DMA
+ *
+ * @param	config	SCK/MOSI/MISO pins plus the hardware NSS pin of this SPI
+ * 					(SPI1: PA4/PA15, SPI2: PB12/PB9, SPI3: PA4/PA15, SPI4: PE4/PE11, SPI5: PB1/PE11).
+ * 					The NSS EXTI line must not be shared with another EXTI user.
+ *
+ * @return	false if another slave receiver is already running
+ */
+bool SPI_slaveRxInit(SPI_GPIO_Config_t config){
+	if(getSPIReg(config.SPIx) == NULL || spiSlave.running) return false;
+
+	spiSlave.config = config;
+	spiSlave.frameStart = 0;
+	spiSlave.halvesSinceStart = 0;
+	spiSlave.head = 0;
+	spiSlave.tail = 0;
+	spiSlave.stats = (SPI_SlaveStats_t){0};
+
+	Enable_GPIO_Clock(config.sckPort);
+	Enable_GPIO_Clock(config.nssPort);
+	Enable_GPIO_Clock(config.mosiPort);
+	Enable_GPIO_Clock(config.misoPort);
+	SPI_sckPin_init(config.sckPin, config.sckPort, config.SPIx);
+	SPI_mosiPin_init(config.mosiPin, config.mosiPort, config.SPIx);
+	SPI_misoPin_init(config.misoPin, config.misoPort, config.SPIx);
+
+	//Hardware NSS: SPI1/2/4 -> AF5, SPI3/5 -> AF6
+	writePin(config.nssPin, config.nssPort, MODER, AF_MODE);
+	writePin(config.nssPin, config.nssPort, (config.nssPin <= 7) ? AFRL : AFRH,
+			 (config.SPIx == my_SPI3 || config.SPIx == my_SPI5) ? AF6 : AF5);
+	writePin(config.nssPin, config.nssPort, PUPDR, PULL_UP); //Deselected while the master is unplugged
+
+	//Slave, SSM = 0: the NSS pin itself gates reception
+	SPI_basicConfigInit(config, STM32_SLAVE, DFF_8BITS, FPCLK_DIV2, SOFTWARE_SLAVE_DISABLE, SPI_DISABLE);
+
+	DMA_Config_t rxCfg = SPI_DMA_RX_CONFIG[config.SPIx];
+	rxCfg.circular = true;
+	rxCfg.halfTransferIrq = true;
+	rxCfg.priority = my_DMA_PRIORITY_VERY_HIGH;
+	DMA_streamInit(&rxCfg, &getSPIReg(config.SPIx) -> SPI_DR, SPI_slaveDmaEvent, NULL);
+	DMA_streamStart(rxCfg.dma, rxCfg.stream, spiSlave.ring, SPI_SLAVE_RX_BUFFER_SIZE);
+	writeSPI(0, config.SPIx, SPI_CR2, 1); //RXDMAEN
+
+	EXTI_selectPort(config.nssPin, config.nssPort);
+	EXTI_setCallback(config.nssPin, SPI_slaveNssEvent);
+	spiSlave.running = true;
+	EXTI_init(config.nssPin, my_EXTI_TRIGGER_RISING, EXTI_getIRQn(config.nssPin));
+
+	writeSPI(6, config.SPIx, SPI_CR1, 1); //SPE, ready for the master
+	return true;
+}
+
+
+/*
+ * @brief	Stop the slave receiver, frames already queued stay readable
+ */
+void SPI_slaveRxStop(void){
+	if(!spiSlave.running) return;
+	SPI_Name_t SPIx = spiSlave.config.SPIx;
+
+	writeEXTI(spiSlave.config.nssPin, IMR, RESET);
+	spiSlave.running = false;
+	EXTI_setCallback(spiSlave.config.nssPin, NULL);
+
+	writeSPI(6, SPIx, SPI_CR1, 0); //SPE
+	writeSPI(0, SPIx, SPI_CR2, 0); //RXDMAEN
+	DMA_streamStop(SPI_DMA_RX_CONFIG[SPIx].dma, SPI_DMA_RX_CONFIG[SPIx].stream);
+
+	//Put the stream back in the shape the master DMA engine expects
+	if(spiDma[SPIx].ready){
+		SPI_DMA_setupStream(&SPI_DMA_RX_CONFIG[SPIx], SPIx, spiDma[SPIx].rxMemIncrement,
+							spiDma[SPIx].dataSize, SPI_DMA_rxEvent);
+	}
+}
+
+
+/*
+ * @brief	Oldest received frame without copying it
+ *
+ * @param	len		Returns the frame length in bytes
+ * @return	Pointer valid until SPI_slaveReleaseFrame(), or NULL when the queue is empty
+ */
+const uint8_t* SPI_slavePeekFrame(uint16_t* len){
+	if(spiSlave.tail == spiSlave.head) return NULL;
+	__DMB(); //Pairs with the barrier before the producer's head update
+
+	const SPI_SlaveFrame_t* slot = &spiSlave.queue[spiSlave.tail];
+	if(len != NULL) *len = slot -> len;
+	return slot -> data;
+}
+
+
+/*
+ * @brief	Give the oldest frame back to the receiver
+ */
+void SPI_slaveReleaseFrame(void){
+	if(spiSlave.tail == spiSlave.head) return;
+	spiSlave.tail = (uint8_t)((spiSlave.tail + 1U) & (SPI_SLAVE_QUEUE_DEPTH - 1U));
+}
+
+
+SPI_SlaveStats_t SPI_slaveGetStats(void){
+	return (SPI_SlaveStats_t){ .frames = spiSlave.stats.frames, .bytes = spiSlave.stats.bytes,
+							   .droppedFull = spiSlave.stats.droppedFull, .oversize = spiSlave.stats.oversize,
+							   .dmaErrors = spiSlave.stats.dmaErrors };
+}
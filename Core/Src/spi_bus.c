@@ -0,0 +1,255 @@
+/*
+ * @file	spi_bus.c
+ * @brief	Shared SPI bus manager on top of the SPI DMA engine
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include "spi_bus.h"
+
+#define SPI_BUS_COUNT	5U
+
+/*
+ * CR1 bits owned by the bus: master, software NSS with SSI high
+ * Device bits on top: BR[2:0] << 3, CPOL/CPHA, DFF << 11
+ */
+#define SPI_BUS_CR1_BASE	((1U << 2) | (1U << 8) | (1U << 9))
+#define SPI_BUS_CR1_SPE		(1U << 6)
+
+/*
+ * ------------------------------------------------------------
+ * Globals
+ * ------------------------------------------------------------
+ * queueHead is written by producers (inside a PRIMASK section), queueTail only by the
+ * dispatcher, which also runs with interrupts masked or from the DMA IRQ.
+ */
+typedef struct{
+	SPI_BusDevice_t devices[SPI_BUS_MAX_DEVICES];
+	uint16_t deviceCR1[SPI_BUS_MAX_DEVICES];	//Precomputed CR1 image per device (SPE clear)
+	uint8_t deviceCount;
+
+	SPI_BusTransaction_t queue[SPI_BUS_QUEUE_DEPTH];
+	volatile uint8_t queueHead;
+	volatile uint8_t queueTail;
+
+	SPI_BusTransaction_t active;
+	volatile bool busy;
+	uint16_t cachedCR1;		//Last image written, valid once cr1Valid is set
+	bool cr1Valid;
+	bool ready;
+
+	SPI_BusStats_t stats;
+}SPI_Bus_t;
+
+static SPI_Bus_t spiBus[SPI_BUS_COUNT];
+
+static void SPI_BUS_startNext(SPI_Name_t SPIx);
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------
+ */
+static uint8_t SPI_BUS_queueCount(const SPI_Bus_t* bus){
+	return (uint8_t)((bus -> queueHead - bus -> queueTail) & (SPI_BUS_QUEUE_DEPTH - 1U));
+}
+
+
+/*
+ * @brief	Put the device settings in place, touching CR1 only when they differ
+ *
+ * 			DFF must only change while SPE = 0, so a switch is: SPE off, new image, SPE on.
+ * 			The DMA engine has already waited for BSY = 0 before the previous completion.
+ */
+static void SPI_BUS_applyDevice(SPI_Name_t SPIx, SPI_Bus_t* bus, int8_t device){
+	uint16_t cr1 = bus -> deviceCR1[device];
+
+	if(bus -> cr1Valid && bus -> cachedCR1 == cr1){
+		bus -> stats.cr1Skipped++;
+	}
+	else{
+		SPI_writeRegister(SPIx, SPI_CR1, cr1);
+		SPI_writeRegister(SPIx, SPI_CR1, cr1 | SPI_BUS_CR1_SPE);
+		bus -> cachedCR1 = cr1;
+		bus -> cr1Valid = true;
+		bus -> stats.cr1Writes++;
+	}
+
+	SPI_DMA_setChipSelect(SPIx, bus -> devices[device].nssPin, bus -> devices[device].nssPort);
+}
+
+
+/*
+ * @brief	DMA completion of the active transaction: report it and run the next one
+ */
+static void SPI_BUS_transferDone(SPI_Name_t SPIx, bool ok, void* context){
+	(void)context;
+	SPI_Bus_t* bus = &spiBus[SPIx];
+	SPI_BusTransaction_t done = bus -> active;
+
+	if(ok) bus -> stats.transactions++;
+	else bus -> stats.errors++;
+	bus -> busy = false;
+
+	if(done.callback != NULL) done.callback(SPIx, ok, done.context);
+	SPI_BUS_startNext(SPIx);
+}
+
+
+/*
+ * @brief	Pop the next transaction if the bus is idle (interrupts masked by the caller or DMA IRQ)
+ */
+static void SPI_BUS_startNext(SPI_Name_t SPIx){
+	SPI_Bus_t* bus = &spiBus[SPIx];
+
+	while(!bus -> busy && bus -> queueTail != bus -> queueHead){
+		bus -> active = bus -> queue[bus -> queueTail];
+		bus -> queueTail = (uint8_t)((bus -> queueTail + 1U) & (SPI_BUS_QUEUE_DEPTH - 1U));
+
+		SPI_BUS_applyDevice(SPIx, bus, bus -> active.device);
+		bus -> busy = true;
+
+		if(!SPI_DMA_transfer(SPIx, bus -> active.txBuf, bus -> active.rxBuf, bus -> active.len,
+							 SPI_BUS_transferDone, NULL)){
+			//Engine refused (not initialized / zero length): fail this one and keep draining
+			bus -> busy = false;
+			bus -> stats.errors++;
+			if(bus -> active.callback != NULL) bus -> active.callback(SPIx, false, bus -> active.context);
+		}
+	}
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Set up SCK/MOSI/MISO and the DMA engine for a shared bus
+ *
+ * @param	pins	SPI peripheral and its SCK/MOSI/MISO pins. The NSS fields are ignored,
+ * 					every device brings its own chip select.
+ */
+bool SPI_BUS_init(SPI_GPIO_Config_t pins){
+	if(pins.SPIx > my_SPI5) return false;
+
+	Enable_GPIO_Clock(pins.sckPort);
+	Enable_GPIO_Clock(pins.mosiPort);
+	Enable_GPIO_Clock(pins.misoPort);
+	SPI_sckPin_init(pins.sckPin, pins.sckPort, pins.SPIx);
+	SPI_mosiPin_init(pins.mosiPin, pins.mosiPort, pins.SPIx);
+	SPI_misoPin_init(pins.misoPin, pins.misoPort, pins.SPIx);
+
+	//Clock + master/SSM setup, left disabled until the first device is selected
+	SPI_basicConfigInit(pins, STM32_MASTER, DFF_8BITS, FPCLK_DIV16, SOFTWARE_SLAVE_ENABLE, SPI_DISABLE);
+	SPI_DMA_init(pins);
+
+	SPI_Bus_t* bus = &spiBus[pins.SPIx];
+	bus -> deviceCount = 0;
+	bus -> queueHead = 0;
+	bus -> queueTail = 0;
+	bus -> busy = false;
+	bus -> cr1Valid = false;
+	bus -> stats = (SPI_BusStats_t){0};
+	bus -> ready = true;
+	return true;
+}
+
+
+/*
+ * @brief	Register a chip select with its bus settings, NSS is driven high right away
+ *
+ * @return	Device handle for SPI_BusTransaction_t.device, or -1 when the bus is full
+ */
+int8_t SPI_BUS_addDevice(SPI_Name_t SPIx, const SPI_BusDevice_t* device){
+	if(SPIx > my_SPI5 || device == NULL) return -1;
+
+	SPI_Bus_t* bus = &spiBus[SPIx];
+	if(!bus -> ready || bus -> deviceCount >= SPI_BUS_MAX_DEVICES) return -1;
+
+	Enable_GPIO_Clock(device -> nssPort);
+	writePin(device -> nssPin, device -> nssPort, BSRR, my_GPIO_PIN_SET);
+	writePin(device -> nssPin, device -> nssPort, MODER, OUTPUT_MODE);
+
+	uint8_t id = bus -> deviceCount;
+	bus -> devices[id] = *device;
+	bus -> deviceCR1[id] = (uint16_t)(SPI_BUS_CR1_BASE
+									 | ((uint32_t)(device -> baudRate & 0x7) << 3)
+									 | ((uint32_t)device -> clockMode & 0x3)
+									 | ((uint32_t)device -> frameSize << 11));
+	bus -> deviceCount++;
+	return (int8_t)id;
+}
+
+
+/*
+ * @brief	Queue a transaction, safe from thread mode and interrupt handlers
+ *
+ * 			If the bus is idle the transfer starts before this returns.
+ *
+ * @return	false if the handle is invalid or the queue is full
+ */
+bool SPI_BUS_submit(SPI_Name_t SPIx, const SPI_BusTransaction_t* transaction){
+	if(SPIx > my_SPI5 || transaction == NULL) return false;
+
+	SPI_Bus_t* bus = &spiBus[SPIx];
+	if(!bus -> ready || transaction -> device < 0 || transaction -> device >= (int8_t)bus -> deviceCount ||
+	   transaction -> len == 0) return false;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint8_t next = (uint8_t)((bus -> queueHead + 1U) & (SPI_BUS_QUEUE_DEPTH - 1U));
+	if(next == bus -> queueTail){
+		bus -> stats.queueFull++;
+		__set_PRIMASK(primask);
+		return false;
+	}
+
+	bus -> queue[bus -> queueHead] = *transaction;
+	bus -> queueHead = next;
+
+	uint8_t pending = SPI_BUS_queueCount(bus);
+	if(pending > bus -> stats.queueHighWater) bus -> stats.queueHighWater = pending;
+
+	SPI_BUS_startNext(SPIx);
+	__set_PRIMASK(primask);
+	return true;
+}
+
+
+/*
+ * @brief	true when nothing is running or queued on the bus
+ */
+bool SPI_BUS_idle(SPI_Name_t SPIx){
+	if(SPIx > my_SPI5) return true;
+	SPI_Bus_t* bus = &spiBus[SPIx];
+	return !bus -> busy && bus -> queueHead == bus -> queueTail;
+}
+
+
+SPI_BusStats_t SPI_BUS_getStats(SPI_Name_t SPIx){
+	if(SPIx > my_SPI5) return (SPI_BusStats_t){0};
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	SPI_BusStats_t stats = spiBus[SPIx].stats;
+	__set_PRIMASK(primask);
+	return stats;
+}
+
+
+void SPI_BUS_resetStats(SPI_Name_t SPIx){
+	if(SPIx > my_SPI5) return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	spiBus[SPIx].stats = (SPI_BusStats_t){0};
+	__set_PRIMASK(primask);
+}
@@ -29,6 +29,8 @@
 #include <time.h>
 #include <sys/time.h>
 #include <sys/times.h>
+#include <unistd.h>
+#include "uart.h"
 
 
 /* Variables */
@@ -79,9 +81,18 @@ __attribute__((weak)) int _read(int file, char *ptr, int len)
 
 __attribute__((weak)) int _write(int file, char *ptr, int len)
 {
-  (void)file;
   int DataIdx;
 
+  /* stdout/stderr go through the non-blocking UART TX ring once UART_retargetInit() ran */
+  if (file == STDOUT_FILENO || file == STDERR_FILENO)
+  {
+    int written = UART_retargetWrite(ptr, len);
+    if (written >= 0)
+    {
+      return written;
+    }
+  }
+
   for (DataIdx = 0; DataIdx < len; DataIdx++)
   {
     __io_putchar(*ptr++);
@@ -18,6 +18,11 @@
  */
 static volatile int timeCnt = 0; //Millisecond counter
 
+/*
+ * Update callbacks for the periodic general-purpose timers, indexed with ::TIM_Name_t (TIM2 to TIM5 only)
+ */
+static TIM_UpdateCallback_t timUpdateCallback[my_TIM5 + 1];
+
 
 /*
  * ------------------------------------------------------------
@@ -833,16 +838,17 @@ uint32_t readTimer(uint8_t bitPosition, TIM_Name_t userTIMx, TIM_Mode_t mode){
 TIM_Cal_t timerCalculation(uint32_t sysClkFreq, uint32_t targetHz, uint32_t maxArr){
 	TIM_Cal_t output = {0};
 
-	uint32_t psc = (sysClkFreq / (targetHz * (maxArr + 1)));
+	//64-bit products: targetHz * (maxArr + 1) wraps above 65535Hz with a 16-bit ARR (and at any rate with 32-bit)
+	uint64_t psc = (uint64_t)sysClkFreq / ((uint64_t)targetHz * ((uint64_t)maxArr + 1U));
 	if(psc > 0xFFFF) psc = 0xFFFF; //PSC is 16-bit on stm32
 
 	for(;; ++psc){
-		uint32_t arr = (sysClkFreq/(targetHz * (psc + 1))) - 1;
+		uint64_t arr = ((uint64_t)sysClkFreq / ((uint64_t)targetHz * (psc + 1U))) - 1U;
 
 		if(arr <= maxArr){
-			output.psc = psc;
-			output.arr = arr;
-			output.actualHz = sysClkFreq / ((psc + 1) * (arr + 1));
+			output.psc = (uint32_t)psc;
+			output.arr = (uint32_t)arr;
+			output.actualHz = (uint32_t)((uint64_t)sysClkFreq / ((psc + 1U) * (arr + 1U)));
 			return output;
 		}
 	}
@@ -904,26 +910,116 @@ void delay(int msec){
 }
 
 
+/*
+ * --------------------------------------------------------
+ * Periodic Update Interrupt (TIM2 to TIM5)
+ * --------------------------------------------------------
+ */
 
+static volatile TIM_Register_Offset_t* getGPTimerReg(TIM_Name_t userTIMx){
+	switch(userTIMx){
+		case my_TIM2: return TIM2_REG;
+		case my_TIM3: return TIM3_REG;
+		case my_TIM4: return TIM4_REG;
+		default: return TIM5_REG;
+	}
+}
 
 
+/*
+ * @brief	Map TIM2 - TIM5 to their NVIC line
+ */
+static IRQn_Pos_t getTimerIRQn(TIM_Name_t userTIMx){
+	switch(userTIMx){
+		case my_TIM2: return TIM2_user;
+		case my_TIM3: return TIM3_user;
+		case my_TIM4: return TIM4_user;
+		default: return TIM5_user;
+	}
+}
 
 
+/*
+ * @brief	Counter clock of the APB1 timers (TIM2 - TIM5)
+ *
+ * 			The timer clock is PCLK1 when APB1 is not divided, otherwise twice PCLK1 (RM0383 6.2).
+ */
+uint32_t TIM_getAPB1TimerClock(void){
+	uint32_t pclk1 = RCC_getPCLK1Freq();
+	return (pclk1 == RCC_getHCLKFreq()) ? pclk1 : (pclk1 * 2U);
+}
 
 
+/*
+ * @brief	Run TIM2 - TIM5 as a free-running update interrupt at @p rateHz
+ *
+ * @param	rateHz		Update rate, 1Hz up to 1/10 of the timer clock
+ * @param	callback	Raised from the timer IRQ on every update event (may be NULL)
+ *
+ * @return	Achieved rate in Hz (timer clock / ((PSC + 1) * (ARR + 1))), 0 on invalid arguments
+ */
+uint32_t TIM_startPeriodic(TIM_Name_t userTIMx, uint32_t rateHz, TIM_UpdateCallback_t callback){
+	if(userTIMx < my_TIM2 || userTIMx > my_TIM5 || rateHz == 0) return 0;
 
+	uint32_t timClk = TIM_getAPB1TimerClock();
+	if(rateHz > timClk / 10U) return 0;
 
+	switch(userTIMx){
+		case my_TIM2: my_RCC_TIM2_CLK_ENABLE(); break;
+		case my_TIM3: my_RCC_TIM3_CLK_ENABLE(); break;
+		case my_TIM4: my_RCC_TIM4_CLK_ENABLE(); break;
+		default: my_RCC_TIM5_CLK_ENABLE(); break;
+	}
 
+	/*
+	 * 16-bit ARR limit for all four: targetHz * (maxArr + 1) must not overflow,
+	 * and PSC still reaches the lowest rates on the 32-bit TIM2/TIM5
+	 */
+	TIM_Cal_t timConfig = timerCalculation(timClk, rateHz, 0xFFFF);
 
+	volatile TIM_Register_Offset_t* TIMx_p = getGPTimerReg(userTIMx);
 
+	writeTimer(0, userTIMx, TIM_CR1, RESET);	//Counter off while reprogramming
+	timUpdateCallback[userTIMx] = callback;
 
+	//Whole-register writes: writeTimer() only touches as many bits as the new value has
+	TIMx_p -> TIM_PSC = timConfig.psc;
+	TIMx_p -> TIM_ARR = timConfig.arr;
+	writeTimer(7, userTIMx, TIM_CR1, SET);		//ARPE: ARR is buffered
+	TIMx_p -> TIM_EGR = 1U;						//UG: load PSC/ARR and clear CNT now, not one period later
+	TIMx_p -> TIM_SR = ~1U;						//UG sets UIF as well
 
+	writeTimer(0, userTIMx, TIM_DIER, SET);		//UIE
+	NVIC_enableIRQ(getTimerIRQn(userTIMx));
+	writeTimer(0, userTIMx, TIM_CR1, SET);		//Counter enabled
+	return timConfig.actualHz;
+}
 
 
+/*
+ * @brief	Stop a timer started with TIM_startPeriodic()
+ */
+void TIM_stopPeriodic(TIM_Name_t userTIMx){
+	if(userTIMx < my_TIM2 || userTIMx > my_TIM5) return;
+
+	writeTimer(0, userTIMx, TIM_CR1, RESET);
+	writeTimer(0, userTIMx, TIM_DIER, RESET);
+	NVIC_disableIRQ(getTimerIRQn(userTIMx));
+	getGPTimerReg(userTIMx) -> TIM_SR = ~1U;
+	timUpdateCallback[userTIMx] = NULL;
+}
 
 
+static void TIM_updateDispatch(TIM_Name_t userTIMx){
+	volatile TIM_Register_Offset_t* TIMx_p = getGPTimerReg(userTIMx);
 
+	if((TIMx_p -> TIM_SR & 1U) == 0) return;
+	TIMx_p -> TIM_SR = ~1U; //rc_w0: clear UIF only, first so a late clear cannot re-enter the handler
 
+	if(timUpdateCallback[userTIMx] != NULL) timUpdateCallback[userTIMx](userTIMx);
+}
 
-
-
+void TIM2_IRQHandler(void){ TIM_updateDispatch(my_TIM2); }
+void TIM3_IRQHandler(void){ TIM_updateDispatch(my_TIM3); }
+void TIM4_IRQHandler(void){ TIM_updateDispatch(my_TIM4); }
+void TIM5_IRQHandler(void){ TIM_updateDispatch(my_TIM5); }
@@ -6,6 +6,201 @@
  */
 #include "uart.h"
 
+/*
+ * ------------------------------------------------------------
+ * Interrupt-driven Ring Buffers
+ * ------------------------------------------------------------
+ */
+#define UART_PORT_COUNT	3U
+
+static uint8_t uartTxStorage[UART_PORT_COUNT][UART_TX_RING_SIZE];
+static uint8_t uartRxStorage[UART_PORT_COUNT][UART_RX_RING_SIZE];
+
+static UART_BaudCal_t uartBaudInfo[UART_PORT_COUNT]; //Result of the last BRR computation per port
+
+static UART_RingBuffer_t uartTxRing[UART_PORT_COUNT];
+static UART_RingBuffer_t uartRxRing[UART_PORT_COUNT];
+
+static volatile uint32_t uartRxOverrunCnt[UART_PORT_COUNT]; //Bytes lost because the RX ring was full or ORE was raised
+
+
+/*
+ * ------------------------------------------------------------
+ * DMA Transmit Ping-Pong Buffers
+ * ------------------------------------------------------------
+ * The application always owns buffer[fillIdx]; the other buffer belongs to the DMA while busy == true.
+ * 'filling' is set between UART_DMA_getTxBuffer() and UART_DMA_commitTx() so the DMA IRQ never
+ * swaps a buffer out from under a writer.
+ */
+typedef struct{
+	uint8_t buffer[2][UART_DMA_TX_BUFFER_SIZE];
+	volatile uint16_t fillLen[2];
+	volatile uint8_t fillIdx;
+	volatile bool busy;
+	volatile bool filling;
+	bool ready;
+	UART_TxCompleteCallback_t callback;
+}UART_DMATx_t;
+
+static UART_DMATx_t uartDmaTx[UART_PORT_COUNT];
+
+/*
+ * @brief	USARTx_TX request mapping (RM0383 Table 27/28)
+ * 			USART1_TX: DMA2 Stream7 Channel4
+ * 			USART2_TX: DMA1 Stream6 Channel4
+ * 			USART6_TX: DMA2 Stream6 Channel5
+ */
+static const DMA_Config_t UART_DMA_TX_CONFIG[UART_PORT_COUNT] = {
+		[my_UART1] = {.dma = my_DMA2, .stream = DMA_STREAM7, .channel = 4, .direction = DMA_MEM_TO_PERIPH,
+					  .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_MEDIUM, .memIncrement = true},
+		[my_UART2] = {.dma = my_DMA1, .stream = DMA_STREAM6, .channel = 4, .direction = DMA_MEM_TO_PERIPH,
+					  .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_MEDIUM, .memIncrement = true},
+		[my_UART6] = {.dma = my_DMA2, .stream = DMA_STREAM6, .channel = 5, .direction = DMA_MEM_TO_PERIPH,
+					  .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_MEDIUM, .memIncrement = true},
+};
+
+
+/*
+ * ------------------------------------------------------------
+ * DMA Circular Receive
+ * ------------------------------------------------------------
+ * The DMA never stops; readPos trails the DMA write position (SIZE - NDTR) and everything
+ * in between is handed to the callback on HT, TC and IDLE events.
+ */
+typedef struct{
+	uint8_t buffer[UART_DMA_RX_BUFFER_SIZE];
+	uint16_t readPos;
+	bool frameOpen;		//Bytes were delivered since the last frameEnd
+	bool ready;
+	UART_RxFrameCallback_t callback;
+}UART_DMARx_t;
+
+static UART_DMARx_t uartDmaRx[UART_PORT_COUNT];
+
+/*
+ * @brief	USARTx_RX request mapping (RM0383 Table 27/28)
+ * 			USART1_RX: DMA2 Stream2 Channel4
+ * 			USART2_RX: DMA1 Stream5 Channel4
+ * 			USART6_RX: DMA2 Stream1 Channel5
+ */
+static const DMA_Config_t UART_DMA_RX_CONFIG[UART_PORT_COUNT] = {
+		[my_UART1] = {.dma = my_DMA2, .stream = DMA_STREAM2, .channel = 4, .direction = DMA_PERIPH_TO_MEM,
+					  .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true,
+					  .circular = true, .halfTransferIrq = true},
+		[my_UART2] = {.dma = my_DMA1, .stream = DMA_STREAM5, .channel = 4, .direction = DMA_PERIPH_TO_MEM,
+					  .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true,
+					  .circular = true, .halfTransferIrq = true},
+		[my_UART6] = {.dma = my_DMA2, .stream = DMA_STREAM1, .channel = 5, .direction = DMA_PERIPH_TO_MEM,
+					  .dataSize = DMA_SIZE_8BITS, .priority = my_DMA_PRIORITY_HIGH, .memIncrement = true,
+					  .circular = true, .halfTransferIrq = true},
+};
+
+static void UART_DMA_rxProcess(UART_Name_t UARTx, bool idleLine);
+
+static UART_IdleCallback_t uartIdleCallback[UART_PORT_COUNT]; //Overrides the circular RX IDLE handling (bridge.c)
+
+
+/*
+ * ------------------------------------------------------------
+ * Hardware Flow Control Streaming
+ * ------------------------------------------------------------
+ * With CTSE set the USART itself holds the next character while nCTS is high, so the TX DMA
+ * simply stalls on its pending request and nothing is lost. The stream layer only has to tell
+ * producers about it: it tracks the nCTS level through the CTS interrupt and reports how
+ * much DMA buffer space is left.
+ */
+typedef struct{
+	GPIO_Pin_t ctsPin;
+	GPIO_PortName_t ctsPort;
+	bool ctsEnabled;				//ctsPin/ctsPort are valid (UART_flowControlInit with CTS)
+	volatile bool paused;			//nCTS high: the receiver asked us to stop
+	volatile uint32_t pauseCount;
+	volatile uint32_t pausedUs;		//Accumulated time with nCTS high, each pause added when it ends
+	uint32_t pauseStart;
+	bool ready;
+	UART_StreamCallback_t callback;
+}UART_Stream_t;
+
+static UART_Stream_t uartStream[UART_PORT_COUNT];
+static void UART_streamCtsEvent(UART_Name_t UARTx);
+
+
+/*
+ * @brief	Map UART name to its register block (NULL on invalid port)
+ */
+static volatile UART_Register_Offset_t* getUARTReg(UART_Name_t UARTx){
+	switch(UARTx){
+		case my_UART1: return UART1_REG;
+		case my_UART2: return UART2_REG;
+		case my_UART6: return UART6_REG;
+		default: return NULL;
+	}
+}
+
+
+/*
+ * @brief	Map UART name to its NVIC line
+ */
+static IRQn_Pos_t getUARTIRQn(UART_Name_t UARTx){
+	switch(UARTx){
+		case my_UART1: return UART1;
+		case my_UART2: return UART2;
+		default: return UART6;
+	}
+}
+
+
+/*
+ * @brief	Integer-only BRR solver
+ *
+ * 			With x = round(fclk / baud):
+ * 				OVER8 = 0: USARTDIV = x / 16, so BRR = x (mantissa = x >> 4, fraction = x & 0xF)
+ * 				OVER8 = 1: USARTDIV = x / 8,  so BRR = ((x >> 3) << 4) | (x & 0x7), bit 3 kept 0
+ * 			Either way the achieved baud rate is fclk / x.
+ * 			16x oversampling is preferred (better noise immunity); 8x is only used when
+ * 			fclk / baud < 16, i.e. above fclk/16 (6.25 Mbaud from a 100MHz APB2).
+ *
+ * @param	pclkFreq	Clock feeding the USART in Hz
+ * @param	baudRate	Target baud rate
+ * @param	result		Filled with BRR, OVER8, achieved baud and error
+ *
+ * @return	true if a legal BRR exists (USARTDIV >= 1 and mantissa <= 0xFFF)
+ */
+bool UART_calculateBRR(uint32_t pclkFreq, uint32_t baudRate, UART_BaudCal_t* result){
+	if(result == NULL) return false;
+	*result = (UART_BaudCal_t){ .pclkFreq = pclkFreq, .targetBaud = baudRate };
+	if(baudRate == 0 || pclkFreq == 0) return false;
+
+	uint32_t x = (pclkFreq + (baudRate / 2U)) / baudRate; //fclk / baud rounded to nearest
+	if(x < 8U) return false; //Even 8x oversampling cannot go that fast
+
+	if(x >= 16U){
+		if((x >> 4) > 0xFFFU) return false; //Too slow for a 12-bit mantissa
+		result -> brr = (uint16_t)x;
+		result -> over8 = false;
+	}
+	else{
+		result -> brr = (uint16_t)(((x >> 3) << 4) | (x & 0x7U));
+		result -> over8 = true;
+	}
+
+	result -> actualBaud = (pclkFreq + (x / 2U)) / x;
+	result -> errorPpm = (int32_t)((((int64_t)result -> actualBaud - (int64_t)baudRate) * 1000000) / (int64_t)baudRate);
+	result -> valid = true;
+	return true;
+}
+
+
+
+/*
+ * @brief	Baud rate actually programmed by the last UART_Init() on this port
+ */
+UART_BaudCal_t UART_getBaudInfo(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL) return (UART_BaudCal_t){0};
+	return uartBaudInfo[UARTx];
+}
+
+
 
 /*
  * UART Initialize in general
@@ -14,7 +209,7 @@ void UART_Init(GPIO_Pin_t TXPin,
 			   GPIO_Pin_t RXPin,
 			   GPIO_PortName_t portName,
 			   UART_Name_t UARTx,
-			   uint16_t baudRate,
+			   uint32_t baudRate,
 			   UART_Parity_t parity,
 			   UART_WordLength_t wordLength){
 
@@ -50,28 +245,29 @@ void UART_Init(GPIO_Pin_t TXPin,
 	GPIO_Mode_t afrRegTX = (TXPin <= 7) ? AFRL : AFRH;
 	GPIO_Mode_t afrRegRX = (RXPin <= 7) ? AFRL : AFRH;
 
-	writePin(TXPin, portName, afrRegTX, AF7);
-	writePin(RXPin, portName, afrRegRX, AF7);
+	GPIO_State_t uartAF = (UARTx == my_UART6) ? AF8 : AF7; //USART1/2 are AF7, USART6 is AF8
+
+	writePin(TXPin, portName, afrRegTX, uartAF);
+	writePin(RXPin, portName, afrRegRX, uartAF);
 
 	/*
 	 * CONFIG UART
 	 *
-	 * Config baud rate
+	 * Config baud rate from the real APB clock (USART1/6 on APB2, USART2 on APB1)
 	 * baud = fclk / (8*(2-OVER8)*UARTDIV)
 	 */
-	long int f_clk = 16000000L; //16MHz
-	char over8 = 0; //16x oversampling
-	float uartDiv = f_clk / (8*(2-over8) * baudRate);
+	uint32_t f_clk = (UARTx == my_UART2) ? RCC_getPCLK1Freq() : RCC_getPCLK2Freq();
+	UART_BaudCal_t baudCal;
+	if(!UART_calculateBRR(f_clk, baudRate, &baudCal)) return; //Baud rate out of reach for this clock
+	uartBaudInfo[UARTx] = baudCal;
 
-	int divMantissa = (int)uartDiv; //Extract the integer part
-	float divFraction = uartDiv - divMantissa; //Extract the fraction part
-	int convert_divFraction = (int)(divFraction * 16); //scale and store divFraction in 4 bits
-	uint16_t fullBRR = (divMantissa << 4) | (convert_divFraction & 0xF);
+	writeUART(13, UARTx, CR1, 0); //OVER8 and BRR may only change while UE = 0
+	writeUART(15, UARTx, CR1, baudCal.over8 ? 1 : 0);
 
 	/*
 	 * Write calculated full values to BRR
 	 */
-	writeUART(0, UARTx, BRR, fullBRR);
+	getUARTReg(UARTx) -> BRR = baudCal.brr;
 
 	/*
 	 * Enable TX and RX mode
@@ -258,3 +454,754 @@ char readUART(uint8_t bitPosition, UART_Name_t userUARTx, UART_Mode_t mode){
 		}
 	}
 }
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Interrupt-driven Mode
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Switch a UART (already set up by UART_Init) to interrupt-driven mode
+ *
+ * 			Resets the TX/RX rings of that port, enables RXNEIE so every received byte
+ * 			lands in the RX ring, and enables the USARTx line in the NVIC.
+ * 			TXEIE is only enabled while the TX ring holds data (see UART_write).
+ */
+void UART_interruptInit(UART_Name_t UARTx){
+	volatile UART_Register_Offset_t* regs = getUARTReg(UARTx);
+	if(regs == NULL) return;
+
+	uartTxRing[UARTx] = (UART_RingBuffer_t){ .buffer = uartTxStorage[UARTx], .mask = UART_TX_RING_SIZE - 1U };
+	uartRxRing[UARTx] = (UART_RingBuffer_t){ .buffer = uartRxStorage[UARTx], .mask = UART_RX_RING_SIZE - 1U };
+	uartRxOverrunCnt[UARTx] = 0;
+
+	writeUART(5, UARTx, CR1, 1); //RXNEIE: interrupt on RXNE and ORE
+	NVIC_enableIRQ(getUARTIRQn(UARTx));
+}
+
+
+
+/*
+ * @brief	Queue bytes for background transmission (never blocks)
+ *
+ * @param	UARTx	my_UART1, my_UART2, my_UART6
+ * @param	buf		Bytes to send
+ * @param	len		Number of bytes requested
+ *
+ * @return	Number of bytes actually queued (less than @p len when the TX ring is full)
+ */
+uint16_t UART_write(UART_Name_t UARTx, const uint8_t* buf, uint16_t len){
+	volatile UART_Register_Offset_t* regs = getUARTReg(UARTx);
+	if(regs == NULL || buf == NULL) return 0;
+
+	UART_RingBuffer_t* ring = &uartTxRing[UARTx];
+	if(ring -> buffer == NULL) return 0; //UART_interruptInit() was not called
+
+	uint16_t head = ring -> head;
+	uint16_t space = (uint16_t)(UART_TX_RING_SIZE - (uint16_t)(head - ring -> tail));
+	uint16_t count = (len < space) ? len : space;
+
+	for(uint16_t i = 0; i < count; i++){
+		ring -> buffer[(uint16_t)(head + i) & ring -> mask] = buf[i];
+	}
+	ring -> head = (uint16_t)(head + count); //Publish only after the bytes are stored
+
+	if(count > 0) regs -> CR1 |= USART_CR1_TXEIE; //Kick the ISR, it clears TXEIE once the ring runs dry
+	return count;
+}
+
+
+
+/*
+ * @brief	Pop received bytes from the RX ring (never blocks)
+ *
+ * @return	Number of bytes copied into @p buf (0 if nothing arrived)
+ */
+uint16_t UART_read(UART_Name_t UARTx, uint8_t* buf, uint16_t len){
+	if(getUARTReg(UARTx) == NULL || buf == NULL) return 0;
+
+	UART_RingBuffer_t* ring = &uartRxRing[UARTx];
+	if(ring -> buffer == NULL) return 0;
+
+	uint16_t tail = ring -> tail;
+	uint16_t available = (uint16_t)(ring -> head - tail);
+	uint16_t count = (len < available) ? len : available;
+
+	for(uint16_t i = 0; i < count; i++){
+		buf[i] = ring -> buffer[(uint16_t)(tail + i) & ring -> mask];
+	}
+	ring -> tail = (uint16_t)(tail + count);
+	return count;
+}
+
+
+
+/*
+ * @brief	Bytes still waiting in the TX ring
+ */
+uint16_t UART_txPending(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL) return 0;
+	return (uint16_t)(uartTxRing[UARTx].head - uartTxRing[UARTx].tail);
+}
+
+
+
+/*
+ * @brief	Bytes waiting to be read from the RX ring
+ */
+uint16_t UART_rxAvailable(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL) return 0;
+	return (uint16_t)(uartRxRing[UARTx].head - uartRxRing[UARTx].tail);
+}
+
+
+
+/*
+ * @brief	Number of received bytes dropped since UART_interruptInit()
+ */
+uint32_t UART_getRxOverrunCount(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL) return 0;
+	return uartRxOverrunCnt[UARTx];
+}
+
+
+
+/*
+ * @brief	Common USART interrupt body
+ *
+ * 			RXNE/ORE: read SR then DR (clears both) and push the byte into the RX ring
+ * 			TXE:      feed the next queued byte, or disable TXEIE when the ring is empty
+ *
+ * 			Registers are accessed directly here instead of through readUART()/writeUART()
+ * 			to keep the per-byte cost to a handful of instructions.
+ */
+static void UART_IRQDispatch(UART_Name_t UARTx){
+	volatile UART_Register_Offset_t* regs = getUARTReg(UARTx);
+	uint32_t sr = regs -> SR;
+	uint32_t cr1 = regs -> CR1;
+
+	if((cr1 & USART_CR1_RXNEIE) && (sr & (USART_SR_RXNE | USART_SR_ORE))){
+		uint8_t data = (uint8_t)(regs -> DR & 0xFF); //SR then DR read sequence clears RXNE/ORE/PE/FE/NE
+		UART_RingBuffer_t* ring = &uartRxRing[UARTx];
+		uint16_t head = ring -> head;
+
+		if(sr & USART_SR_ORE) uartRxOverrunCnt[UARTx]++;
+
+		if((uint16_t)(head - ring -> tail) < UART_RX_RING_SIZE){
+			ring -> buffer[head & ring -> mask] = data;
+			ring -> head = (uint16_t)(head + 1U);
+		}
+		else uartRxOverrunCnt[UARTx]++;
+	}
+
+	if((cr1 & USART_CR1_IDLEIE) && (sr & USART_SR_IDLE)){
+		(void)regs -> DR; //SR then DR read clears IDLE; RXNE is already 0 because the DMA took the byte
+		if(uartIdleCallback[UARTx] != NULL) uartIdleCallback[UARTx](UARTx);
+		else UART_DMA_rxProcess(UARTx, true);
+	}
+
+	if((regs -> CR3 & USART_CR3_CTSIE) && (sr & USART_SR_CTS)){
+		regs -> SR = (uint32_t)~USART_SR_CTS; //rc_w0: write 0 to clear, 1s leave the other flags alone
+		UART_streamCtsEvent(UARTx);
+	}
+
+	if((cr1 & USART_CR1_TXEIE) && (sr & USART_SR_TXE)){
+		UART_RingBuffer_t* ring = &uartTxRing[UARTx];
+		uint16_t tail = ring -> tail;
+
+		if(tail != ring -> head){
+			regs -> DR = ring -> buffer[tail & ring -> mask];
+			ring -> tail = (uint16_t)(tail + 1U);
+		}
+		else regs -> CR1 &= ~USART_CR1_TXEIE; //Nothing left, stop TXE interrupts
+	}
+}
+
+
+
+
+/*
+ * ------------------------------------------------------------
+ * stdout Retarget
+ * ------------------------------------------------------------
+ * printf() -> _write() -> UART_retargetWrite() -> TX ring -> USART TXE interrupt.
+ * The TX ring is single-producer, so only thread mode may enqueue; output produced
+ * inside an interrupt handler is dropped (and counted) instead of racing the main loop.
+ */
+static struct{
+	UART_Name_t port;
+	UART_RetargetPolicy_t policy;
+	bool ready;
+	volatile uint32_t droppedBytes;
+	volatile uint16_t highWater;
+}uartRetarget;
+
+
+/*
+ * @brief	Route stdout/stderr to a UART through its interrupt-driven TX ring
+ *
+ * @param	UARTx	Port already set up by UART_Init(); UART_interruptInit() is called here
+ * @param	policy	UART_RETARGET_DROP or UART_RETARGET_BLOCK when the ring is full
+ *
+ * @note	Do not combine with UART_DMA_txInit() on the same port.
+ */
+void UART_retargetInit(UART_Name_t UARTx, UART_RetargetPolicy_t policy){
+	if(getUARTReg(UARTx) == NULL) return;
+
+	UART_interruptInit(UARTx);
+	uartRetarget.port = UARTx;
+	uartRetarget.policy = policy;
+	uartRetarget.droppedBytes = 0;
+	uartRetarget.highWater = 0;
+	uartRetarget.ready = true;
+
+	setvbuf(stdout, NULL, _IONBF, 0); //Every printf() reaches _write at once, the ring does the buffering
+}
+
+
+/*
+ * @brief	Backend for _write(): queue bytes according to the configured policy
+ *
+ * @return	Number of bytes consumed (always @p len once initialized, dropped bytes included,
+ * 			so newlib never retries), or -1 if UART_retargetInit() was not called
+ */
+int UART_retargetWrite(const char* ptr, int len){
+	if(!uartRetarget.ready) return -1;
+	if(ptr == NULL || len <= 0) return 0;
+
+	UART_Name_t UARTx = uartRetarget.port;
+	const uint8_t* data = (const uint8_t*)ptr;
+	int remaining = len;
+
+	if(__get_IPSR() != 0U){ //Called from an exception handler, the ring has a single producer
+		uartRetarget.droppedBytes += (uint32_t)len;
+		return len;
+	}
+
+	//Blocking is only safe when the USART IRQ can still preempt us
+	bool canBlock = (uartRetarget.policy == UART_RETARGET_BLOCK) && (__get_PRIMASK() == 0U);
+
+	while(remaining > 0){
+		uint16_t chunk = (remaining > 0xFFFF) ? 0xFFFF : (uint16_t)remaining;
+		uint16_t queued = UART_write(UARTx, data, chunk);
+		data += queued;
+		remaining -= queued;
+
+		uint16_t level = UART_txPending(UARTx);
+		if(level > uartRetarget.highWater) uartRetarget.highWater = level;
+
+		if(queued < chunk && !canBlock) break;
+	}
+
+	uartRetarget.droppedBytes += (uint32_t)remaining;
+	return len;
+}
+
+
+/*
+ * @brief	Snapshot of the retarget drop counter and TX ring high-water mark
+ */
+UART_RetargetStats_t UART_retargetGetStats(void){
+	return (UART_RetargetStats_t){ .droppedBytes = uartRetarget.droppedBytes, .highWater = uartRetarget.highWater };
+}
+
+
+/*
+ * @brief	Bytes of stdout still waiting in the TX ring (0 when the retarget is not active)
+ */
+uint16_t UART_retargetGetPending(void){
+	if(!uartRetarget.ready) return 0;
+	return UART_txPending(uartRetarget.port);
+}
+
+
+/*
+ * @brief	Clear the drop counter and high-water mark
+ */
+void UART_retargetResetStats(void){
+	uartRetarget.droppedBytes = 0;
+	uartRetarget.highWater = 0;
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * DMA Transmit Mode
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Hand the filled ping-pong buffer to the DMA if the stream is idle
+ *
+ * @note	Must run with the TX stream IRQ masked or from that IRQ itself
+ */
+static void UART_DMA_kickTx(UART_Name_t UARTx){
+	UART_DMATx_t* tx = &uartDmaTx[UARTx];
+	if(tx -> busy || tx -> filling) return;
+
+	uint8_t idx = tx -> fillIdx;
+	uint16_t len = tx -> fillLen[idx];
+	if(len == 0) return;
+
+	tx -> fillIdx = idx ^ 1U; //Application continues in the other buffer
+	tx -> fillLen[idx ^ 1U] = 0;
+	tx -> busy = true;
+
+	getUARTReg(UARTx) -> SR = (uint32_t)~USART_SR_TC; //rc_w0: write 0 to clear TC, 1s leave RXNE/ORE/IDLE alone
+	DMA_streamStart(UART_DMA_TX_CONFIG[UARTx].dma, UART_DMA_TX_CONFIG[UARTx].stream, tx -> buffer[idx], len);
+}
+
+
+/*
+ * @brief	DMA stream callback: release the buffer on the wire, chain the next one, notify the app
+ */
+static void UART_DMA_txEvent(uint8_t events, void* context){
+	UART_Name_t UARTx = (UART_Name_t)(uintptr_t)context;
+	UART_DMATx_t* tx = &uartDmaTx[UARTx];
+
+	if(events & (DMA_EVENT_COMPLETE | DMA_EVENT_ERROR)){
+		tx -> busy = false;
+		UART_DMA_kickTx(UARTx);
+		if(tx -> callback != NULL) tx -> callback(UARTx);
+	}
+}
+
+
+/*
+ * @brief	Attach the USART TX request to its DMA stream (call after UART_Init)
+ *
+ * @param	UARTx		my_UART1 (DMA2 S7), my_UART2 (DMA1 S6), my_UART6 (DMA2 S6)
+ * @param	callback	Optional, raised from the DMA IRQ after every completed buffer
+ *
+ * @note	Do not mix with UART_write() on the same port, both would feed DR.
+ */
+void UART_DMA_txInit(UART_Name_t UARTx, UART_TxCompleteCallback_t callback){
+	if(getUARTReg(UARTx) == NULL) return;
+
+	UART_DMATx_t* tx = &uartDmaTx[UARTx];
+	tx -> fillIdx = 0;
+	tx -> fillLen[0] = 0;
+	tx -> fillLen[1] = 0;
+	tx -> busy = false;
+	tx -> filling = false;
+	tx -> callback = callback;
+
+	DMA_streamInit(&UART_DMA_TX_CONFIG[UARTx], &getUARTReg(UARTx) -> DR, UART_DMA_txEvent, (void*)(uintptr_t)UARTx);
+	writeUART(7, UARTx, CR3, 1); //DMAT: DMA enable transmitter
+	tx -> ready = true;
+}
+
+
+/*
+ * @brief	Borrow the free space of the buffer the application currently owns
+ *
+ * 			Lets a producer format data in place; must be followed by UART_DMA_commitTx()
+ *
+ * @param	space	Returns the number of bytes that can be written at the returned pointer
+ * @return	Write pointer, or NULL if DMA TX is not initialized on this port
+ */
+uint8_t* UART_DMA_getTxBuffer(UART_Name_t UARTx, uint16_t* space){
+	if(getUARTReg(UARTx) == NULL || !uartDmaTx[UARTx].ready) return NULL;
+
+	UART_DMATx_t* tx = &uartDmaTx[UARTx];
+	IRQn_Pos_t irqn = DMA_getIRQn(UART_DMA_TX_CONFIG[UARTx].dma, UART_DMA_TX_CONFIG[UARTx].stream);
+
+	NVIC_disableIRQ(irqn);
+	tx -> filling = true;
+	uint8_t idx = tx -> fillIdx;
+	uint16_t used = tx -> fillLen[idx];
+	NVIC_enableIRQ(irqn);
+
+	if(space != NULL) *space = (uint16_t)(UART_DMA_TX_BUFFER_SIZE - used);
+	return &tx -> buffer[idx][used];
+}
+
+
+/*
+ * @brief	Publish @p len bytes written through UART_DMA_getTxBuffer() and start the DMA if idle
+ */
+void UART_DMA_commitTx(UART_Name_t UARTx, uint16_t len){
+	if(getUARTReg(UARTx) == NULL || !uartDmaTx[UARTx].ready) return;
+
+	UART_DMATx_t* tx = &uartDmaTx[UARTx];
+	IRQn_Pos_t irqn = DMA_getIRQn(UART_DMA_TX_CONFIG[UARTx].dma, UART_DMA_TX_CONFIG[UARTx].stream);
+
+	NVIC_disableIRQ(irqn);
+	uint8_t idx = tx -> fillIdx;
+	uint16_t used = tx -> fillLen[idx];
+	if(len > (uint16_t)(UART_DMA_TX_BUFFER_SIZE - used)) len = (uint16_t)(UART_DMA_TX_BUFFER_SIZE - used);
+	tx -> fillLen[idx] = (uint16_t)(used + len);
+	tx -> filling = false;
+	UART_DMA_kickTx(UARTx);
+	NVIC_enableIRQ(irqn);
+}
+
+
+/*
+ * @brief	Copy bytes into the application-side buffer and start the DMA if idle (never blocks)
+ *
+ * @return	Number of bytes accepted; less than @p len when both buffers are in use
+ */
+uint16_t UART_DMA_write(UART_Name_t UARTx, const uint8_t* buf, uint16_t len){
+	if(buf == NULL) return 0;
+
+	uint16_t space = 0;
+	uint8_t* dst = UART_DMA_getTxBuffer(UARTx, &space);
+	if(dst == NULL) return 0;
+
+	uint16_t count = (len < space) ? len : space;
+	for(uint16_t i = 0; i < count; i++){
+		dst[i] = buf[i];
+	}
+	UART_DMA_commitTx(UARTx, count);
+	return count;
+}
+
+
+/*
+ * @brief	true while a buffer is being transferred or another one is waiting
+ */
+bool UART_DMA_txBusy(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL) return false;
+	UART_DMATx_t* tx = &uartDmaTx[UARTx];
+	return tx -> busy || tx -> fillLen[tx -> fillIdx] != 0;
+}
+
+
+
+
+/*
+ * ------------------------------------------------------------
+ * DMA Receive Mode
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Deliver everything the DMA wrote since the last call
+ *
+ * 			Runs from the RX stream IRQ (HT/TC) and from the USART IRQ (IDLE). Both IRQs must share
+ * 			the same NVIC priority so the two callers never preempt each other.
+ *
+ * @param	idleLine	true when called for an IDLE event: the last chunk closes the frame
+ */
+static void UART_DMA_rxProcess(UART_Name_t UARTx, bool idleLine){
+	UART_DMARx_t* rx = &uartDmaRx[UARTx];
+	if(!rx -> ready) return;
+
+	uint16_t writePos = (uint16_t)(UART_DMA_RX_BUFFER_SIZE - DMA_getRemaining(UART_DMA_RX_CONFIG[UARTx].dma, UART_DMA_RX_CONFIG[UARTx].stream));
+	if(writePos >= UART_DMA_RX_BUFFER_SIZE) writePos = 0; //NDTR reloads to SIZE right after the wrap
+
+	uint16_t readPos = rx -> readPos;
+
+	if(writePos != readPos){
+		if(writePos > readPos){
+			if(rx -> callback != NULL) rx -> callback(UARTx, &rx -> buffer[readPos], (uint16_t)(writePos - readPos), idleLine);
+		}
+		else{
+			//Wrapped: tail of the buffer first, then the head part (which may be empty)
+			bool headPart = (writePos > 0);
+			if(rx -> callback != NULL){
+				rx -> callback(UARTx, &rx -> buffer[readPos], (uint16_t)(UART_DMA_RX_BUFFER_SIZE - readPos), idleLine && !headPart);
+				if(headPart) rx -> callback(UARTx, rx -> buffer, writePos, idleLine);
+			}
+		}
+		rx -> readPos = writePos;
+		rx -> frameOpen = !idleLine;
+	}
+	else if(idleLine && rx -> frameOpen){
+		//Everything was already delivered by HT/TC, only the end-of-frame marker is missing
+		if(rx -> callback != NULL) rx -> callback(UARTx, &rx -> buffer[readPos], 0, true);
+		rx -> frameOpen = false;
+	}
+}
+
+
+/*
+ * @brief	DMA stream callback for the circular RX stream
+ */
+static void UART_DMA_rxEvent(uint8_t events, void* context){
+	UART_Name_t UARTx = (UART_Name_t)(uintptr_t)context;
+
+	if(events & (DMA_EVENT_HALF | DMA_EVENT_COMPLETE)){
+		UART_DMA_rxProcess(UARTx, false);
+	}
+}
+
+
+/*
+ * @brief	Start lossless background reception on a UART (call after UART_Init)
+ *
+ * 			The RX DMA runs forever in circular mode; IDLE (one idle character time after the
+ * 			last stop bit) marks the end of a frame and HT/TC drain long bursts before they wrap.
+ * 			The CPU does no per-byte work.
+ *
+ * @param	UARTx		my_UART1 (DMA2 S2), my_UART2 (DMA1 S5), my_UART6 (DMA2 S1)
+ * @param	callback	Receives the data chunks, see ::UART_RxFrameCallback_t
+ *
+ * @note	Replaces UART_interruptInit() RX on the same port (RXNEIE is turned off).
+ */
+void UART_DMA_rxInit(UART_Name_t UARTx, UART_RxFrameCallback_t callback){
+	volatile UART_Register_Offset_t* regs = getUARTReg(UARTx);
+	if(regs == NULL) return;
+
+	UART_DMARx_t* rx = &uartDmaRx[UARTx];
+	rx -> ready = false;
+	rx -> readPos = 0;
+	rx -> frameOpen = false;
+	rx -> callback = callback;
+
+	DMA_streamInit(&UART_DMA_RX_CONFIG[UARTx], &regs -> DR, UART_DMA_rxEvent, (void*)(uintptr_t)UARTx);
+
+	(void)regs -> SR; //Flush a stale byte/IDLE flag so the first frame starts clean
+	(void)regs -> DR;
+
+	writeUART(5, UARTx, CR1, 0); //RXNEIE off, the DMA owns DR reads
+	writeUART(6, UARTx, CR3, 1); //DMAR: DMA enable receiver
+	DMA_streamStart(UART_DMA_RX_CONFIG[UARTx].dma, UART_DMA_RX_CONFIG[UARTx].stream, rx -> buffer, UART_DMA_RX_BUFFER_SIZE);
+
+	rx -> ready = true;
+	writeUART(4, UARTx, CR1, 1); //IDLEIE
+	NVIC_enableIRQ(getUARTIRQn(UARTx));
+}
+
+
+/*
+ * @brief	Stop DMA reception and release the stream
+ */
+void UART_DMA_rxStop(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL) return;
+
+	writeUART(4, UARTx, CR1, 0); //IDLEIE off
+	writeUART(6, UARTx, CR3, 0); //DMAR off
+	DMA_streamStop(UART_DMA_RX_CONFIG[UARTx].dma, UART_DMA_RX_CONFIG[UARTx].stream);
+	uartDmaRx[UARTx].ready = false;
+}
+
+
+
+/*
+ * @brief	Free bytes in the application-side DMA TX buffer (0 if DMA TX is not initialized)
+ */
+uint16_t UART_DMA_txSpace(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL || !uartDmaTx[UARTx].ready) return 0;
+
+	UART_DMATx_t* tx = &uartDmaTx[UARTx];
+	IRQn_Pos_t irqn = DMA_getIRQn(UART_DMA_TX_CONFIG[UARTx].dma, UART_DMA_TX_CONFIG[UARTx].stream);
+
+	NVIC_disableIRQ(irqn);
+	uint16_t used = tx -> fillLen[tx -> fillIdx];
+	NVIC_enableIRQ(irqn);
+	return (uint16_t)(UART_DMA_TX_BUFFER_SIZE - used);
+}
+
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Hardware Flow Control
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Enable RTS and/or CTS on a port already set up by UART_Init()
+ *
+ * 			USART1: CTS PA11, RTS PA12		USART2: CTS PA0/PD3, RTS PA1/PD4 (all AF7)
+ * 			USART6 has no CTS/RTS pins on the STM32F411.
+ *
+ * @param	flow		UART_FLOW_RTS, UART_FLOW_CTS or UART_FLOW_RTS_CTS
+ * @param	ctsPin		Ignored when CTS is not requested
+ * @param	rtsPin		Ignored when RTS is not requested
+ * @param	portName	GPIO port of both pins
+ *
+ * @return	false if the port has no flow control lines
+ */
+bool UART_flowControlInit(UART_Name_t UARTx, UART_FlowControl_t flow, GPIO_Pin_t ctsPin, GPIO_Pin_t rtsPin, GPIO_PortName_t portName){
+	if(getUARTReg(UARTx) == NULL || UARTx == my_UART6) return false;
+
+	Enable_GPIO_Clock(portName);
+
+	if(flow & UART_FLOW_CTS){
+		writePin(ctsPin, portName, MODER, AF_MODE);
+		writePin(ctsPin, portName, (ctsPin <= 7) ? AFRL : AFRH, AF7);
+		writePin(ctsPin, portName, PUPDR, PULL_UP); //Pull-up: a disconnected peer reads as "stop"
+		uartStream[UARTx].ctsPin = ctsPin;
+		uartStream[UARTx].ctsPort = portName;
+	}
+	uartStream[UARTx].ctsEnabled = (flow & UART_FLOW_CTS) != 0;
+	if(flow & UART_FLOW_RTS){
+		writePin(rtsPin, portName, MODER, AF_MODE);
+		writePin(rtsPin, portName, (rtsPin <= 7) ? AFRL : AFRH, AF7);
+	}
+
+	writeUART(13, UARTx, CR1, 0); //CR3 flow control bits are written with UE = 0
+	writeUART(8, UARTx, CR3, (flow & UART_FLOW_RTS) ? 1 : 0); //RTSE
+	writeUART(9, UARTx, CR3, (flow & UART_FLOW_CTS) ? 1 : 0); //CTSE
+	writeUART(13, UARTx, CR1, 1);
+	return true;
+}
+
+
+/*
+ * @brief	Refresh the paused state from the nCTS pin level and notify the producer
+ *
+ * 			Does nothing without CTS: a zeroed ctsPin/ctsPort would otherwise sample PA0.
+ */
+static void UART_streamCtsEvent(UART_Name_t UARTx){
+	UART_Stream_t* stream = &uartStream[UARTx];
+	if(!stream -> ctsEnabled) return;
+
+	bool paused = (readPin(stream -> ctsPin, stream -> ctsPort, IDR) == 1);
+	if(paused == stream -> paused) return;
+
+	if(paused){
+		stream -> pauseCount++;
+		stream -> pauseStart = DWT_getCycles();
+	}
+	else stream -> pausedUs += DWT_cyclesToUs(DWT_elapsed(stream -> pauseStart)); //In us: a cycle total wraps after ~43s
+
+	stream -> paused = paused;
+	if(stream -> callback != NULL) stream -> callback(UARTx, paused);
+}
+
+
+/*
+ * @brief	DMA streaming with CTS back-pressure (call after UART_flowControlInit with CTS)
+ *
+ * 			Starts DMA TX on the port and enables the CTS interrupt.
+ *
+ * @param	callback	Optional, raised from the USART IRQ every time nCTS pauses or resumes the link
+ */
+void UART_streamInit(UART_Name_t UARTx, UART_StreamCallback_t callback){
+	if(getUARTReg(UARTx) == NULL || UARTx == my_UART6) return;
+
+	UART_Stream_t* stream = &uartStream[UARTx];
+	stream -> callback = callback;
+	stream -> pauseCount = 0;
+	stream -> pausedUs = 0;
+	stream -> paused = false;
+	(void)DWT_init();
+
+	UART_DMA_txInit(UARTx, NULL);
+
+	getUARTReg(UARTx) -> SR = (uint32_t)~USART_SR_CTS;
+	writeUART(10, UARTx, CR3, 1); //CTSIE
+	NVIC_enableIRQ(getUARTIRQn(UARTx));
+	stream -> ready = true;
+	UART_streamCtsEvent(UARTx); //Pick up the current level
+}
+
+
+/*
+ * @brief	Queue bytes for the stream (never blocks)
+ *
+ * @return	Bytes accepted. Less than @p len means back-pressure: the peer holds nCTS high or
+ * 			the DMA buffers are still full; retry after UART_streamWritable() grows again.
+ */
+uint16_t UART_streamWrite(UART_Name_t UARTx, const uint8_t* buf, uint16_t len){
+	if(getUARTReg(UARTx) == NULL || !uartStream[UARTx].ready) return 0;
+	return UART_DMA_write(UARTx, buf, len);
+}
+
+
+/*
+ * @brief	How many bytes UART_streamWrite() would accept right now
+ */
+uint16_t UART_streamWritable(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL || !uartStream[UARTx].ready) return 0;
+	return UART_DMA_txSpace(UARTx);
+}
+
+
+/*
+ * @brief	true while the peer holds nCTS high
+ */
+bool UART_streamPaused(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL || !uartStream[UARTx].ready) return false;
+	return uartStream[UARTx].paused;
+}
+
+
+/*
+ * @brief	Number of pauses and total paused time since UART_streamInit()
+ */
+UART_StreamStats_t UART_streamGetStats(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL) return (UART_StreamStats_t){0};
+
+	UART_Stream_t* stream = &uartStream[UARTx];
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	UART_StreamStats_t stats = { .pauseCount = stream -> pauseCount,
+								 .pausedUs = stream -> pausedUs,
+								 .paused = stream -> paused };
+	if(stats.paused) stats.pausedUs += DWT_cyclesToUs(DWT_elapsed(stream -> pauseStart));
+	__set_PRIMASK(primask);
+	return stats;
+}
+
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Raw DMA Access
+ * ------------------------------------------------------------
+ * For modules that manage their own buffers on top of the USART DMA requests
+ * (bridge.c). They own the stream and the DMAT/DMAR bits of the port.
+ */
+
+/*
+ * @brief	Stream/channel pairing of the USART TX request (NULL on invalid port)
+ */
+const DMA_Config_t* UART_DMA_getTxConfig(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL) return NULL;
+	return &UART_DMA_TX_CONFIG[UARTx];
+}
+
+
+/*
+ * @brief	Stream/channel pairing of the USART RX request (NULL on invalid port)
+ */
+const DMA_Config_t* UART_DMA_getRxConfig(UART_Name_t UARTx){
+	if(getUARTReg(UARTx) == NULL) return NULL;
+	return &UART_DMA_RX_CONFIG[UARTx];
+}
+
+
+/*
+ * @brief	Address of USART_DR, the peripheral side of both DMA requests
+ */
+volatile uint32_t* UART_getDataRegister(UART_Name_t UARTx){
+	volatile UART_Register_Offset_t* regs = getUARTReg(UARTx);
+	if(regs == NULL) return NULL;
+	return &regs -> DR;
+}
+
+
+/*
+ * @brief	Route the IDLE-line interrupt of a port to @p callback (NULL restores the default)
+ *
+ * 			Enables IDLEIE and the USART NVIC line; the callback runs from USARTx_IRQHandler
+ * 			after IDLE has been cleared.
+ */
+void UART_setIdleCallback(UART_Name_t UARTx, UART_IdleCallback_t callback){
+	if(getUARTReg(UARTx) == NULL) return;
+
+	uartIdleCallback[UARTx] = callback;
+	if(callback != NULL){
+		writeUART(4, UARTx, CR1, 1); //IDLEIE
+		NVIC_enableIRQ(getUARTIRQn(UARTx));
+	}
+	else if(!uartDmaRx[UARTx].ready) writeUART(4, UARTx, CR1, 0);
+}
+
+
+
+void USART1_IRQHandler(void){ UART_IRQDispatch(my_UART1); }
+void USART2_IRQHandler(void){ UART_IRQDispatch(my_UART2); }
+void USART6_IRQHandler(void){ UART_IRQDispatch(my_UART6); }
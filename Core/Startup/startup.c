@@ -10,6 +10,7 @@
  */
 
 #include <stdint.h>
+#include "exti.h"
 
 int main();
 
@@ -19,6 +20,51 @@ int main();
  * -------------------------------------------------------
  */
 void TIM1_UP_TIM10_IRQHandler();
+void TIM2_IRQHandler(void);
+void TIM3_IRQHandler(void);
+void TIM4_IRQHandler(void);
+void TIM5_IRQHandler(void);
+void USART1_IRQHandler(void);
+void USART2_IRQHandler(void);
+void USART6_IRQHandler(void);
+
+void SPI1_IRQHandler(void);
+void SPI2_IRQHandler(void);
+void SPI3_IRQHandler(void);
+void SPI4_IRQHandler(void);
+void SPI5_IRQHandler(void);
+
+void I2C1_EV_IRQHandler(void);
+void I2C1_ER_IRQHandler(void);
+void I2C2_EV_IRQHandler(void);
+void I2C2_ER_IRQHandler(void);
+void I2C3_EV_IRQHandler(void);
+void I2C3_ER_IRQHandler(void);
+
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+void EXTI2_IRQHandler(void);
+void EXTI3_IRQHandler(void);
+void EXTI4_IRQHandler(void);
+void EXTI9_5_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+
+void DMA1_Stream0_IRQHandler(void);
+void DMA1_Stream1_IRQHandler(void);
+void DMA1_Stream2_IRQHandler(void);
+void DMA1_Stream3_IRQHandler(void);
+void DMA1_Stream4_IRQHandler(void);
+void DMA1_Stream5_IRQHandler(void);
+void DMA1_Stream6_IRQHandler(void);
+void DMA1_Stream7_IRQHandler(void);
+void DMA2_Stream0_IRQHandler(void);
+void DMA2_Stream1_IRQHandler(void);
+void DMA2_Stream2_IRQHandler(void);
+void DMA2_Stream3_IRQHandler(void);
+void DMA2_Stream4_IRQHandler(void);
+void DMA2_Stream5_IRQHandler(void);
+void DMA2_Stream6_IRQHandler(void);
+void DMA2_Stream7_IRQHandler(void);
 typedef void(*handler_t)();
 
 /*
@@ -61,24 +107,67 @@ void resetHandler(){
 	main();
 }
 
-__attribute__((section(".isr_vector"))) handler_t VTTB[] = {
+/*
+ * -------------------------------------------------------
+ * Vector Table
+ * -------------------------------------------------------
+ * 	[0]				Initial stack pointer
+ * 	[1..15]			Cortex-M4 system exceptions
+ * 	[16 + IRQn]		STM32F411 peripheral interrupts, indexed with ::IRQn_Pos_t
+ * Unused entries stay 0
+ */
+#define IRQ_VECTOR(irqn)	(16 + (irqn))
+#define VECTOR_TABLE_SIZE	IRQ_VECTOR(SPI5_user + 1)
+
+__attribute__((section(".isr_vector"))) handler_t VTTB[VECTOR_TABLE_SIZE] = {
 		//_estack = ORIGIN(RAM) + LENGTH(RAM); /* end of "RAM" Ram type memory */
 		(handler_t)&_estack,
 		resetHandler,
-		0,0,0,0,
-
-		0,0,0,0,
-
-		0,0,0,0,
-
-		0,0,0,0,
-		0,0,0,0,
-		0,0,0,0,
-		0,0,0,0,
-		0,0,0,0,
-		0,0,0,0,
-		0,0,0,
-		TIM1_UP_TIM10_IRQHandler,
-		0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-		0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+
+		[IRQ_VECTOR(TIM1_UP_TIM10)]	= TIM1_UP_TIM10_IRQHandler,
+		[IRQ_VECTOR(TIM2_user)]		= TIM2_IRQHandler,
+		[IRQ_VECTOR(TIM3_user)]		= TIM3_IRQHandler,
+		[IRQ_VECTOR(TIM4_user)]		= TIM4_IRQHandler,
+		[IRQ_VECTOR(TIM5_user)]		= TIM5_IRQHandler,
+		[IRQ_VECTOR(UART1)]			= USART1_IRQHandler,
+		[IRQ_VECTOR(UART2)]			= USART2_IRQHandler,
+		[IRQ_VECTOR(UART6)]			= USART6_IRQHandler,
+
+		[IRQ_VECTOR(SPI1_user)]		= SPI1_IRQHandler,
+		[IRQ_VECTOR(SPI2_user)]		= SPI2_IRQHandler,
+		[IRQ_VECTOR(SPI3_user)]		= SPI3_IRQHandler,
+		[IRQ_VECTOR(SPI4_user)]		= SPI4_IRQHandler,
+		[IRQ_VECTOR(SPI5_user)]		= SPI5_IRQHandler,
+
+		[IRQ_VECTOR(I2C1_EV)]		= I2C1_EV_IRQHandler,
+		[IRQ_VECTOR(I2C1_ER)]		= I2C1_ER_IRQHandler,
+		[IRQ_VECTOR(I2C2_EV)]		= I2C2_EV_IRQHandler,
+		[IRQ_VECTOR(I2C2_ER)]		= I2C2_ER_IRQHandler,
+		[IRQ_VECTOR(I2C3_EV)]		= I2C3_EV_IRQHandler,
+		[IRQ_VECTOR(I2C3_ER)]		= I2C3_ER_IRQHandler,
+
+		[IRQ_VECTOR(EXTI0)]			= EXTI0_IRQHandler,
+		[IRQ_VECTOR(EXTI1)]			= EXTI1_IRQHandler,
+		[IRQ_VECTOR(EXTI2)]			= EXTI2_IRQHandler,
+		[IRQ_VECTOR(EXTI3)]			= EXTI3_IRQHandler,
+		[IRQ_VECTOR(EXTI4)]			= EXTI4_IRQHandler,
+		[IRQ_VECTOR(EXTI9_5)]		= EXTI9_5_IRQHandler,
+		[IRQ_VECTOR(EXTI15_10)]		= EXTI15_10_IRQHandler,
+
+		[IRQ_VECTOR(DMA1_S0)]		= DMA1_Stream0_IRQHandler,
+		[IRQ_VECTOR(DMA1_S1)]		= DMA1_Stream1_IRQHandler,
+		[IRQ_VECTOR(DMA1_S2)]		= DMA1_Stream2_IRQHandler,
+		[IRQ_VECTOR(DMA1_S3)]		= DMA1_Stream3_IRQHandler,
+		[IRQ_VECTOR(DMA1_S4)]		= DMA1_Stream4_IRQHandler,
+		[IRQ_VECTOR(DMA1_S5)]		= DMA1_Stream5_IRQHandler,
+		[IRQ_VECTOR(DMA1_S6)]		= DMA1_Stream6_IRQHandler,
+		[IRQ_VECTOR(DMA1_S7)]		= DMA1_Stream7_IRQHandler,
+		[IRQ_VECTOR(DMA2_S0)]		= DMA2_Stream0_IRQHandler,
+		[IRQ_VECTOR(DMA2_S1)]		= DMA2_Stream1_IRQHandler,
+		[IRQ_VECTOR(DMA2_S2)]		= DMA2_Stream2_IRQHandler,
+		[IRQ_VECTOR(DMA2_S3)]		= DMA2_Stream3_IRQHandler,
+		[IRQ_VECTOR(DMA2_S4)]		= DMA2_Stream4_IRQHandler,
+		[IRQ_VECTOR(DMA2_S5)]		= DMA2_Stream5_IRQHandler,
+		[IRQ_VECTOR(DMA2_S6)]		= DMA2_Stream6_IRQHandler,
+		[IRQ_VECTOR(DMA2_S7)]		= DMA2_Stream7_IRQHandler,
 };
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+#
+# @file		bench_diff.py
+# @brief	Compare two benchmark captures (JSON lines printed by Core/Src/bench.c)
+#
+#			Usage:	bench_diff.py baseline.log candidate.log [--threshold PCT]
+#
+#			Lines that are not JSON objects (boot noise, printf output) are ignored.
+#			Runs are matched on (suite, mode, baud, payload). Exit status is 1 when a run
+#			that passed in the baseline fails, or a timing metric got worse by more than
+#			the threshold (default 5%). Timing is skipped for lines with cycles_valid=false
+#			(e.g. captured under QEMU).
+#
+#  Created on: Oct 17, 2026
+#      Author: dobao
+#
+
+import argparse
+import json
+import sys
+
+KEY_FIELDS = ("suite", "mode", "baud", "payload")
+METRICS = ("cycles_per_byte", "latency_us", "cpu_permille")   # Lower is better for all of them
+
+
+def load(path):
+    runs = {}
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("{"):
+                continue
+            try:
+                rec = json.loads(line)
+            except json.JSONDecodeError:
+                continue
+            if "event" in rec or not all(k in rec for k in KEY_FIELDS):
+                continue
+            runs[tuple(rec[k] for k in KEY_FIELDS)] = rec
+    return runs
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=5.0, help="allowed regression in percent")
+    args = parser.parse_args()
+
+    base = load(args.baseline)
+    cand = load(args.candidate)
+    regressions = 0
+
+    header = "%-5s %-5s %8s %7s  " % ("suite", "mode", "baud", "payload")
+    header += "  ".join("%-26s" % m for m in METRICS)
+    print(header)
+
+    for key in sorted(set(base) | set(cand), key=lambda k: tuple(str(x) for x in k)):
+        b, c = base.get(key), cand.get(key)
+        row = "%-5s %-5s %8s %7s  " % key
+
+        if b is None or c is None:
+            print(row + ("only in candidate" if b is None else "missing in candidate"))
+            continue
+
+        if b.get("ok") and not c.get("ok"):
+            print(row + "FAIL (received %s/%s, mismatches %s)" % (c.get("received"), key[3], c.get("mismatches")))
+            regressions += 1
+            continue
+
+        timing = b.get("cycles_valid") and c.get("cycles_valid")
+        cells = []
+        for m in METRICS:
+            bv, cv = b.get(m, 0), c.get(m, 0)
+            if not timing:
+                cells.append("%-26s" % "n/a")
+                continue
+            delta = 0.0 if bv == 0 else (cv - bv) * 100.0 / bv
+            flag = ""
+            if delta > args.threshold:
+                flag = " <-- worse"
+                regressions += 1
+            cells.append("%-26s" % ("%d -> %d (%+.1f%%)%s" % (bv, cv, delta, flag)))
+        print(row + "  ".join(cells))
+
+    print("\n%d regression(s) above %.1f%%" % (regressions, args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
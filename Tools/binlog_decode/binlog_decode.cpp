@@ -0,0 +1,249 @@
+/*
+ * @file	binlog_decode.cpp
+ * @brief	Host-side decoder for the binary log stream produced by Core/Src/log.c
+ *
+ * 			Reads the format strings from the .binlog_fmt section of the firmware ELF and
+ * 			turns a captured UART byte stream back into text, one line per record.
+ *
+ * 			Build:	g++ -std=c++17 -O2 -Wall -o binlog_decode binlog_decode.cpp
+ * 			Usage:	binlog_decode firmware.elf [capture.bin | -] [--clock HZ]
+ * 			Check:	sh check.sh (decodes test/capture.bin, compares with test/expected.txt)
+ *
+ * 			--clock converts the timestamp (DWT cycles by default) to seconds.
+ * 			Bytes that do not form a valid record are skipped until the next sync byte.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/*
+ * Must match log.h
+ */
+constexpr uint8_t LOG_SYNC_BYTE = 0xA5;
+constexpr uint8_t LOG_MAX_ARGS = 8;
+constexpr size_t LOG_HEADER_SIZE = 8;
+
+/*
+ * ------------------------------------------------------------
+ * ELF section lookup (ELF32/ELF64 little-endian, no libelf needed)
+ * ------------------------------------------------------------
+ */
+struct FmtSection{
+	uint64_t addr = 0;
+	std::vector<uint8_t> data;
+};
+
+uint64_t readLE(const std::vector<uint8_t>& buf, size_t off, size_t width){
+	if(off + width > buf.size()) throw std::runtime_error("truncated ELF");
+	uint64_t value = 0;
+	for(size_t i = 0; i < width; i++) value |= static_cast<uint64_t>(buf[off + i]) << (8 * i);
+	return value;
+}
+
+FmtSection loadFmtSection(const std::string& path){
+	std::ifstream in(path, std::ios::binary);
+	if(!in) throw std::runtime_error("cannot open " + path);
+	std::vector<uint8_t> elf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	if(elf.size() < 16 || std::memcmp(elf.data(), "\x7F" "ELF", 4) != 0) throw std::runtime_error(path + " is not an ELF file");
+	if(elf[5] != 1) throw std::runtime_error("only little-endian ELF files are supported");
+	bool is64 = (elf[4] == 2);
+
+	uint64_t shoff = readLE(elf, is64 ? 0x28 : 0x20, is64 ? 8 : 4);
+	size_t shentsize = readLE(elf, is64 ? 0x3A : 0x2E, 2);
+	size_t shnum = readLE(elf, is64 ? 0x3C : 0x30, 2);
+	size_t shstrndx = readLE(elf, is64 ? 0x3E : 0x32, 2);
+
+	auto section = [&](size_t idx, uint64_t& name, uint64_t& addr, uint64_t& off, uint64_t& size){
+		size_t base = shoff + idx * shentsize;
+		name = readLE(elf, base, 4);
+		addr = readLE(elf, base + (is64 ? 0x10 : 0x0C), is64 ? 8 : 4);
+		off = readLE(elf, base + (is64 ? 0x18 : 0x10), is64 ? 8 : 4);
+		size = readLE(elf, base + (is64 ? 0x20 : 0x14), is64 ? 8 : 4);
+	};
+
+	uint64_t strName, strAddr, strOff, strSize;
+	section(shstrndx, strName, strAddr, strOff, strSize);
+
+	for(size_t i = 0; i < shnum; i++){
+		uint64_t name, addr, off, size;
+		section(i, name, addr, off, size);
+		if(strOff + name >= elf.size()) continue;
+
+		const char* secName = reinterpret_cast<const char*>(&elf[strOff + name]);
+		if(std::strcmp(secName, ".binlog_fmt") != 0) continue;
+		if(off + size > elf.size()) throw std::runtime_error("truncated .binlog_fmt section");
+
+		FmtSection fmt;
+		fmt.addr = addr;
+		fmt.data.assign(elf.begin() + off, elf.begin() + off + size);
+		return fmt;
+	}
+	throw std::runtime_error("no .binlog_fmt section in " + path);
+}
+
+
+/*
+ * ------------------------------------------------------------
+ * printf-style rendering from raw 32-bit argument words
+ * ------------------------------------------------------------
+ */
+std::string render(const char* fmt, const uint32_t* args, size_t nargs){
+	std::string out;
+	size_t argIdx = 0;
+	auto nextArg = [&](bool& ok) -> uint32_t {
+		ok = argIdx < nargs;
+		return ok ? args[argIdx++] : 0;
+	};
+
+	for(const char* p = fmt; *p; p++){
+		if(*p != '%'){ out += *p; continue; }
+		if(p[1] == '%'){ out += '%'; p++; continue; }
+
+		std::string spec = "%";
+		const char* q = p + 1;
+		bool ok = true;
+
+		while(*q && std::strchr("-+ #0", *q)) spec += *q++;
+		if(*q == '*'){ spec += std::to_string(static_cast<int32_t>(nextArg(ok))); q++; }
+		while(*q >= '0' && *q <= '9') spec += *q++;
+		if(*q == '.'){
+			spec += *q++;
+			if(*q == '*'){ spec += std::to_string(static_cast<int32_t>(nextArg(ok))); q++; }
+			while(*q >= '0' && *q <= '9') spec += *q++;
+		}
+		while(*q && std::strchr("hlLzjt", *q)) q++; //Every argument is one 32-bit word on the wire
+
+		char conv = *q;
+		if(conv == '\0') break;
+		p = q;
+
+		uint32_t raw = nextArg(ok);
+		if(!ok){ out += "<?>"; continue; }
+
+		char buf[128];
+		switch(conv){
+			case 'd': case 'i':
+				std::snprintf(buf, sizeof(buf), (spec + 'd').c_str(), static_cast<int32_t>(raw));
+				break;
+			case 'u': case 'o': case 'x': case 'X':
+				std::snprintf(buf, sizeof(buf), (spec + conv).c_str(), static_cast<unsigned>(raw));
+				break;
+			case 'c':
+				std::snprintf(buf, sizeof(buf), (spec + 'c').c_str(), static_cast<int>(raw & 0xFF));
+				break;
+			case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+				float f;
+				std::memcpy(&f, &raw, sizeof(f)); //LOG_F32() sends the IEEE-754 bit pattern
+				std::snprintf(buf, sizeof(buf), (spec + conv).c_str(), static_cast<double>(f));
+				break;
+			}
+			case 'p':
+				std::snprintf(buf, sizeof(buf), "0x%08x", static_cast<unsigned>(raw));
+				break;
+			case 's':
+				std::snprintf(buf, sizeof(buf), "<str@0x%08x>", static_cast<unsigned>(raw));
+				break;
+			default:
+				std::snprintf(buf, sizeof(buf), "<%%%c?>", conv);
+				break;
+		}
+		out += buf;
+	}
+	return out;
+}
+
+} //namespace
+
+
+
+int main(int argc, char** argv){
+	std::string elfPath, capturePath = "-";
+	double clockHz = 0.0;
+
+	for(int i = 1; i < argc; i++){
+		std::string arg = argv[i];
+		if(arg == "--clock" && i + 1 < argc) clockHz = std::atof(argv[++i]);
+		else if(elfPath.empty()) elfPath = arg;
+		else capturePath = arg;
+	}
+	if(elfPath.empty()){
+		std::fprintf(stderr, "usage: %s firmware.elf [capture.bin | -] [--clock HZ]\n", argv[0]);
+		return 2;
+	}
+
+	FmtSection fmt;
+	try{
+		fmt = loadFmtSection(elfPath);
+	}catch(const std::exception& e){
+		std::fprintf(stderr, "binlog_decode: %s\n", e.what());
+		return 1;
+	}
+
+	std::vector<uint8_t> stream;
+	if(capturePath == "-"){
+		stream.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+	}else{
+		std::ifstream in(capturePath, std::ios::binary);
+		if(!in){
+			std::fprintf(stderr, "binlog_decode: cannot open %s\n", capturePath.c_str());
+			return 1;
+		}
+		stream.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	size_t pos = 0, records = 0, skipped = 0;
+	while(pos + LOG_HEADER_SIZE <= stream.size()){
+		const uint8_t* r = &stream[pos];
+		uint8_t nargs = r[1];
+		uint16_t id = static_cast<uint16_t>(r[2] | (r[3] << 8));
+		size_t len = LOG_HEADER_SIZE + 4U * nargs;
+		size_t offset = id - (fmt.addr & 0xFFFF);
+
+		//Anything that does not look like a record start: slide by one byte and resync
+		if(r[0] != LOG_SYNC_BYTE || nargs > LOG_MAX_ARGS || offset >= fmt.data.size()){
+			pos++;
+			skipped++;
+			continue;
+		}
+		if(pos + len > stream.size()) break; //Capture ended mid-record
+
+		uint32_t ts = r[4] | (r[5] << 8) | (r[6] << 16) | (static_cast<uint32_t>(r[7]) << 24);
+		uint32_t args[LOG_MAX_ARGS];
+		for(uint8_t n = 0; n < nargs; n++){
+			const uint8_t* a = &r[LOG_HEADER_SIZE + 4U * n];
+			args[n] = a[0] | (a[1] << 8) | (a[2] << 16) | (static_cast<uint32_t>(a[3]) << 24);
+		}
+
+		const char* text = reinterpret_cast<const char*>(&fmt.data[offset]);
+		if(std::memchr(text, '\0', fmt.data.size() - offset) == nullptr){
+			pos++;
+			skipped++;
+			continue;
+		}
+
+		if(clockHz > 0.0) std::printf("[%12.6f] ", ts / clockHz);
+		else std::printf("[%10u] ", ts);
+		std::printf("%s\n", render(text, args, nargs).c_str());
+
+		pos += len;
+		records++;
+	}
+
+	std::fprintf(stderr, "binlog_decode: %zu records, %zu bytes skipped, %zu bytes left over\n",
+				 records, skipped, stream.size() - pos);
+	return 0;
+}
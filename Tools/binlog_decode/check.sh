@@ -0,0 +1,36 @@
+#!/bin/sh
+#
+# @file		check.sh
+# @brief	Decode test/capture.bin against test/fmt_fixture.c and compare with test/expected.txt
+#
+# 			capture.bin is a byte stream in the log.h wire format: two noise bytes, five records
+# 			(no arguments, signed/unsigned, %08X, LOG_F32 float, %s pointer with %%), a record with
+# 			an impossible argument count, and a record cut off by the end of the capture.
+# 			The decoder must resync over the garbage and report 6 skipped / 10 left-over bytes.
+#
+# 			Usage (from anywhere):	sh Tools/binlog_decode/check.sh
+# 			Exit status 0 on match.
+#
+#  Created on: Oct 17, 2026
+#      Author: dobao
+#
+
+set -e
+HERE=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+g++ -std=c++17 -O2 -Wall -o "$WORK/binlog_decode" "$HERE/binlog_decode.cpp"
+gcc -c -o "$WORK/fmt_fixture.o" "$HERE/test/fmt_fixture.c" #Relocatable ELF: .binlog_fmt at address 0, as in the firmware
+
+"$WORK/binlog_decode" "$WORK/fmt_fixture.o" "$HERE/test/capture.bin" > "$WORK/out.txt" 2> "$WORK/summary.txt"
+
+if ! diff -u "$HERE/test/expected.txt" "$WORK/out.txt"; then
+	echo "binlog_decode: output differs from test/expected.txt"
+	exit 1
+fi
+if ! grep -q "5 records, 6 bytes skipped, 10 bytes left over" "$WORK/summary.txt"; then
+	echo "binlog_decode: unexpected summary: $(cat "$WORK/summary.txt")"
+	exit 1
+fi
+echo "binlog_decode: all checks passed"
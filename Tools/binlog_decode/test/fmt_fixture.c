@@ -0,0 +1,21 @@
+/*
+ * @file	fmt_fixture.c
+ * @brief	Format strings for the binlog_decode check, laid out like the firmware's .binlog_fmt
+ * 			One array so the offsets (= string IDs in capture.bin) do not depend on the compiler:
+ * 				0	"boot"
+ * 				5	"adc=%u ch=%d"
+ * 				18	"reg 0x%08X"
+ * 				29	"temp %.2f C"
+ * 				41	"name %s load %u%%"
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+__attribute__((section(".binlog_fmt"), used))
+const char binlogFixtureFmt[] =
+		"boot\0"
+		"adc=%u ch=%d\0"
+		"reg 0x%08X\0"
+		"temp %.2f C\0"
+		"name %s load %u%%";
@@ -0,0 +1,621 @@
+/*
+ * @file	host_sim.c
+ * @brief	Register file, SPI shifter, GPIO/EXTI and DWT models for the host build
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_sim.h"
+#include "rcc.h"
+#include "exti.h"
+#include "dma.h"
+
+#define HOST_SIM_SPI_COUNT	5U
+#define HOST_SIM_GPIO_COUNT	6U
+
+#define SR_RXNE		(1U << 0)
+#define SR_TXE		(1U << 1)
+#define SR_CRCERR	(1U << 4)
+#define SR_OVR		(1U << 6)
+#define SR_BSY		(1U << 7)
+#define CR1_MSTR	(1U << 2)
+#define CR1_SPE		(1U << 6)
+#define CR1_DFF		(1U << 11)
+#define CR1_CRCNEXT	(1U << 12)
+#define CR1_CRCEN	(1U << 13)
+#define CR2_RXDMAEN	(1U << 0)
+#define CR2_TXDMAEN	(1U << 1)
+
+#define HOST_SIM_DMA_STREAMS	16U		//DMA1 S0-S7, DMA2 S0-S7
+#define DMA_DIR_P2M				0U		//SxCR.DIR
+#define DMA_DIR_M2P				1U
+
+/*
+ * ------------------------------------------------------------
+ * Register file
+ * ------------------------------------------------------------
+ */
+uint8_t hostSimPeriph[HOST_SIM_PERIPH_SIZE] __attribute__((aligned(4)));
+uint8_t hostSimCore[HOST_SIM_CORE_SIZE] __attribute__((aligned(4)));
+uint32_t hostSimPrimask;
+CoreDebug_Type hostSimCoreDebug;
+
+typedef struct{
+	const HOST_SIM_SpiDevice_t* device;
+	bool selected;
+
+	bool shifting;			//A frame is in the shift register
+	uint16_t shiftFrame;
+	uint8_t pollsLeft;
+	bool txFull;			//A second frame waits in the TX buffer (TXE = 0)
+	uint16_t txFrame;
+	uint16_t rxFrame;		//RX buffer, what a DR read returns
+	bool ovrSeen;			//SR read with OVR set, the next DR read clears it
+
+	bool crcFrame;			//The frame in the shift register is TXCRCR
+	bool crcAfterTx;		//TX DMA sent its last item: TXCRCR follows without CRCNEXT
+	uint32_t cr1;			//Last CR1 written, for the CRCEN edge
+	bool dmaActive;			//hostSpiDmaRun() is on the stack (DMA IRQ handlers write CR2 again)
+
+	uint32_t idlePolls;
+	HOST_SIM_SpiStats_t stats;
+}HostSimSpi_t;
+
+static HostSimSpi_t hostSpi[HOST_SIM_SPI_COUNT];
+static uint32_t hostOdr[HOST_SIM_GPIO_COUNT]; //Last ODR seen per port, for edge detection
+
+static uint32_t hostExtiPending;	//Lines raised while a handler runs, delivered after it returns
+static bool hostExtiActive;
+
+static DWT_Type hostDwt;
+static uint32_t hostDwtLast;
+static uint64_t hostDwtBase;
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------
+ */
+static volatile SPI_Register_Offset_t* hostSpiReg(SPI_Name_t SPIx){
+	switch(SPIx){
+		case my_SPI1: return SPI1_REG;
+		case my_SPI2: return SPI2_REG;
+		case my_SPI3: return SPI3_REG;
+		case my_SPI4: return SPI4_REG;
+		default: return SPI5_REG;
+	}
+}
+
+static volatile GPIO_Register_Offset_t* hostGpioReg(GPIO_PortName_t port){
+	switch(port){
+		case my_GPIOA: return GPIOA_REG;
+		case my_GPIOB: return GPIOB_REG;
+		case my_GPIOC: return GPIOC_REG;
+		case my_GPIOD: return GPIOD_REG;
+		case my_GPIOE: return GPIOE_REG;
+		default: return GPIOH_REG;
+	}
+}
+
+static int hostSpiIndex(volatile void* block){
+	for(int i = 0; i < (int)HOST_SIM_SPI_COUNT; i++){
+		if(block == (volatile void*)hostSpiReg((SPI_Name_t)i)) return i;
+	}
+	return -1;
+}
+
+static int hostGpioIndex(volatile void* block){
+	for(int i = 0; i < (int)HOST_SIM_GPIO_COUNT; i++){
+		if(block == (volatile void*)hostGpioReg((GPIO_PortName_t)i)) return i;
+	}
+	return -1;
+}
+
+static volatile DMA_Stream_Register_Offset_t* hostDmaStreamReg(uint8_t index){
+	volatile DMA_Register_Offset_t* dma = (index < 8U) ? DMA1_REG : DMA2_REG;
+	return &dma -> DMA_STREAM[index & 7U];
+}
+
+static uint64_t hostNanoseconds(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * SPI model
+ * ------------------------------------------------------------
+ */
+static uint8_t hostSpiExchangeByte(HostSimSpi_t* spi, uint8_t mosi){
+	if(spi -> device == NULL || !spi -> selected) return 0xFF; //MISO pulled up, nobody drives it
+	return spi -> device -> exchange(spi -> device -> context, mosi);
+}
+
+
+/*
+ * @brief	CRC calculator of the SPI: MSB first, init 0, no final XOR, CRC8 or CRC16 after CR1.DFF
+ */
+static uint16_t hostSpiCrc(uint16_t crc, uint16_t frame, uint16_t polynomial, uint8_t bits){
+	uint16_t top = (uint16_t)(1U << (bits - 1U));
+	for(int8_t i = (int8_t)(bits - 1U); i >= 0; i--){
+		bool feedback = ((crc & top) != 0) != (((frame >> i) & 1U) != 0);
+		crc = (uint16_t)(crc << 1);
+		if(feedback) crc ^= polynomial;
+	}
+	return (bits == 8U) ? (uint16_t)(crc & 0xFF) : crc;
+}
+
+
+static void hostSpiComplete(SPI_Name_t SPIx){
+	volatile SPI_Register_Offset_t* reg = hostSpiReg(SPIx);
+	HostSimSpi_t* spi = &hostSpi[SPIx];
+
+	bool selected = (spi -> device != NULL && spi -> selected);
+	uint8_t bits = (reg -> SPI_CR1 & CR1_DFF) ? 16U : 8U;
+	uint16_t rx;
+	if(bits == 16U){
+		rx = (uint16_t)(hostSpiExchangeByte(spi, (uint8_t)(spi -> shiftFrame >> 8)) << 8);
+		rx |= hostSpiExchangeByte(spi, (uint8_t)(spi -> shiftFrame & 0xFF));
+	}
+	else rx = hostSpiExchangeByte(spi, (uint8_t)spi -> shiftFrame);
+
+	spi -> stats.frames++;
+	if(!selected) spi -> stats.unselected++;
+
+	//Data frames feed both calculators, the CRC frame is compared against RXCRCR
+	bool wasCrc = spi -> crcFrame;
+	spi -> crcFrame = false;
+	if(reg -> SPI_CR1 & CR1_CRCEN){
+		uint16_t polynomial = (uint16_t)reg -> SPI_CRC;
+		if(wasCrc){
+			if(rx != (uint16_t)reg -> SPI_RXCRCR) reg -> SPI_SR |= SR_CRCERR;
+		}
+		else{
+			reg -> SPI_TXCRCR = hostSpiCrc((uint16_t)reg -> SPI_TXCRCR, spi -> shiftFrame, polynomial, bits);
+			reg -> SPI_RXCRCR = hostSpiCrc((uint16_t)reg -> SPI_RXCRCR, rx, polynomial, bits);
+		}
+	}
+
+	if(reg -> SPI_SR & SR_RXNE){
+		reg -> SPI_SR |= SR_OVR; //RM0383: the new frame is lost, DR keeps the unread one
+		spi -> stats.overruns++;
+	}
+	else{
+		spi -> rxFrame = rx;
+		reg -> SPI_SR |= SR_RXNE;
+	}
+
+	if(spi -> txFull){
+		spi -> shiftFrame = spi -> txFrame;
+		spi -> txFull = false;
+		spi -> pollsLeft = HOST_SIM_POLLS_PER_FRAME;
+	}
+	else if(!wasCrc && (reg -> SPI_CR1 & CR1_CRCEN) && ((reg -> SPI_CR1 & CR1_CRCNEXT) || spi -> crcAfterTx)){
+		spi -> shiftFrame = (uint16_t)reg -> SPI_TXCRCR; //Back to back with the last data frame
+		spi -> crcFrame = true;
+		spi -> crcAfterTx = false;
+		spi -> pollsLeft = HOST_SIM_POLLS_PER_FRAME;
+	}
+	else spi -> shifting = false;
+}
+
+
+/*
+ * @brief	One unit of bus time passes: called on every SR/DR read
+ */
+static void hostSpiAdvance(SPI_Name_t SPIx){
+	HostSimSpi_t* spi = &hostSpi[SPIx];
+	if(spi -> shifting && --spi -> pollsLeft == 0) hostSpiComplete(SPIx);
+}
+
+
+static void hostSpiRefreshStatus(SPI_Name_t SPIx){
+	volatile SPI_Register_Offset_t* reg = hostSpiReg(SPIx);
+	HostSimSpi_t* spi = &hostSpi[SPIx];
+
+	uint32_t sr = reg -> SPI_SR & ~(SR_TXE | SR_BSY);
+	if(!spi -> txFull) sr |= SR_TXE;
+	if(spi -> shifting) sr |= SR_BSY;
+	reg -> SPI_SR = sr;
+	reg -> SPI_DR = spi -> rxFrame;
+}
+
+
+static void hostSpiDataWritten(SPI_Name_t SPIx){
+	volatile SPI_Register_Offset_t* reg = hostSpiReg(SPIx);
+	HostSimSpi_t* spi = &hostSpi[SPIx];
+	uint16_t frame = (uint16_t)(reg -> SPI_DR & ((reg -> SPI_CR1 & CR1_DFF) ? 0xFFFF : 0xFF));
+
+	if(spi -> txFull) spi -> txFrame = frame; //Writing with TXE = 0 overwrites the waiting frame
+	else if(spi -> shifting || (reg -> SPI_CR1 & (CR1_SPE | CR1_MSTR)) != (CR1_SPE | CR1_MSTR)){
+		spi -> txFull = true; //No clock until SPE and MSTR are set
+		spi -> txFrame = frame;
+	}
+	else{
+		spi -> shifting = true;
+		spi -> shiftFrame = frame;
+		spi -> pollsLeft = HOST_SIM_POLLS_PER_FRAME;
+	}
+	spi -> idlePolls = 0;
+	hostSpiRefreshStatus(SPIx);
+}
+
+
+/*
+ * @brief	CR1 write: setting CRCEN clears both CRC registers
+ */
+static void hostSpiControlWritten(SPI_Name_t SPIx){
+	volatile SPI_Register_Offset_t* reg = hostSpiReg(SPIx);
+	HostSimSpi_t* spi = &hostSpi[SPIx];
+	uint32_t cr1 = reg -> SPI_CR1;
+
+	if((cr1 & CR1_CRCEN) && (spi -> cr1 & CR1_CRCEN) == 0){
+		reg -> SPI_TXCRCR = 0;
+		reg -> SPI_RXCRCR = 0;
+		spi -> crcAfterTx = false;
+	}
+	spi -> cr1 = cr1;
+}
+
+
+static void hostSpiRegRead(SPI_Name_t SPIx, volatile uint32_t* reg){
+	volatile SPI_Register_Offset_t* spiReg = hostSpiReg(SPIx);
+	HostSimSpi_t* spi = &hostSpi[SPIx];
+
+	if(reg != &spiReg -> SPI_SR && reg != &spiReg -> SPI_DR) return;
+
+	//A frame parked in the TX buffer starts once the peripheral is enabled as master
+	if(!spi -> shifting && spi -> txFull &&
+	   (spiReg -> SPI_CR1 & (CR1_SPE | CR1_MSTR)) == (CR1_SPE | CR1_MSTR)){
+		spi -> shifting = true;
+		spi -> shiftFrame = spi -> txFrame;
+		spi -> txFull = false;
+		spi -> pollsLeft = HOST_SIM_POLLS_PER_FRAME;
+	}
+
+	hostSpiAdvance(SPIx);
+	hostSpiRefreshStatus(SPIx);
+
+	if(reg == &spiReg -> SPI_SR){
+		if(!spi -> shifting && !spi -> txFull && (spiReg -> SPI_SR & SR_RXNE) == 0 &&
+		   ++spi -> idlePolls > HOST_SIM_HANG_POLLS){
+			fprintf(stderr, "host_sim: SPI%d polled with nothing on the bus (SPE/MSTR off or missing DR write)\n", SPIx + 1);
+			abort();
+		}
+		if(spiReg -> SPI_SR & SR_OVR) spi -> ovrSeen = true;
+	}
+	else{
+		//DR read: the value is already in place, the read itself empties the RX buffer
+		spiReg -> SPI_SR &= ~SR_RXNE;
+		if(spi -> ovrSeen){
+			spiReg -> SPI_SR &= ~SR_OVR;
+			spi -> ovrSeen = false;
+		}
+		spi -> idlePolls = 0;
+	}
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * DMA model (SPI request lines only)
+ * ------------------------------------------------------------
+ * A stream serves an SPI when it is enabled, its PAR is that SPI's DR and CR2 holds the matching
+ * DMAEN bit. The transfer runs to completion inside the CR2 write that enables the last request,
+ * and TC runs the stream IRQ handler on the spot, like the EXTI model. M0AR doubles as the memory
+ * pointer (the drivers rewrite it for every transfer), so buffers must sit below 4 GB: static
+ * storage in a -no-pie build.
+ */
+static void (* const hostDmaHandlers[HOST_SIM_DMA_STREAMS])(void) = {
+		DMA1_Stream0_IRQHandler, DMA1_Stream1_IRQHandler, DMA1_Stream2_IRQHandler, DMA1_Stream3_IRQHandler,
+		DMA1_Stream4_IRQHandler, DMA1_Stream5_IRQHandler, DMA1_Stream6_IRQHandler, DMA1_Stream7_IRQHandler,
+		DMA2_Stream0_IRQHandler, DMA2_Stream1_IRQHandler, DMA2_Stream2_IRQHandler, DMA2_Stream3_IRQHandler,
+		DMA2_Stream4_IRQHandler, DMA2_Stream5_IRQHandler, DMA2_Stream6_IRQHandler, DMA2_Stream7_IRQHandler
+};
+
+
+/*
+ * @return	Index of the enabled stream serving @p SPIx in direction @p dir, -1 if none
+ */
+static int hostDmaFind(SPI_Name_t SPIx, uint32_t dir){
+	uint32_t par = (uint32_t)(uintptr_t)&hostSpiReg(SPIx) -> SPI_DR;
+
+	for(uint8_t i = 0; i < HOST_SIM_DMA_STREAMS; i++){
+		volatile DMA_Stream_Register_Offset_t* stream = hostDmaStreamReg(i);
+		if((stream -> DMA_SxCR & DMA_SxCR_EN) && stream -> DMA_SxPAR == par &&
+		   ((stream -> DMA_SxCR >> 6) & 0x3U) == dir) return i;
+	}
+	return -1;
+}
+
+
+/*
+ * @brief	Step the memory side past one item
+ *
+ * @return	true when that was the last item: EN drops, the caller raises TC
+ */
+static bool hostDmaAdvance(uint8_t index){
+	volatile DMA_Stream_Register_Offset_t* stream = hostDmaStreamReg(index);
+	uint32_t itemSize = 1U << ((stream -> DMA_SxCR >> 13) & 0x3U); //MSIZE
+
+	if(stream -> DMA_SxCR & DMA_SxCR_MINC) stream -> DMA_SxM0AR += itemSize;
+	if(--stream -> DMA_SxNDTR != 0) return false;
+
+	stream -> DMA_SxCR &= ~DMA_SxCR_EN;
+	return true;
+}
+
+
+/*
+ * @brief	Set TCIF and run the stream IRQ handler (flags are write-1-to-clear, not modelled)
+ */
+static void hostDmaComplete(uint8_t index){
+	static const uint8_t FLAG_SHIFT[4] = {0, 6, 16, 22};
+	volatile DMA_Register_Offset_t* dma = (index < 8U) ? DMA1_REG : DMA2_REG;
+	volatile uint32_t* isr = ((index & 7U) < 4U) ? &dma -> DMA_LISR : &dma -> DMA_HISR;
+	uint32_t shift = FLAG_SHIFT[index & 3U];
+
+	*isr |= (uint32_t)DMA_FLAG_TCIF << shift;
+	hostDmaHandlers[index]();
+	*isr &= ~((uint32_t)DMA_FLAG_ALL << shift);
+}
+
+
+static uint16_t hostDmaLoad(uint8_t index){
+	volatile DMA_Stream_Register_Offset_t* stream = hostDmaStreamReg(index);
+	uintptr_t address = stream -> DMA_SxM0AR;
+	if(((stream -> DMA_SxCR >> 13) & 0x3U) == DMA_SIZE_16BITS) return *(const uint16_t*)address;
+	return *(const uint8_t*)address;
+}
+
+
+static void hostDmaStore(uint8_t index, uint16_t frame){
+	volatile DMA_Stream_Register_Offset_t* stream = hostDmaStreamReg(index);
+	uintptr_t address = stream -> DMA_SxM0AR;
+	if(((stream -> DMA_SxCR >> 13) & 0x3U) == DMA_SIZE_16BITS) *(uint16_t*)address = frame;
+	else *(uint8_t*)address = (uint8_t)frame;
+}
+
+
+/*
+ * @brief	Serve the DMA requests of @p SPIx until both sides go quiet
+ *
+ * 			RXNE is always drained before the next bus step, so a DMA transfer never overruns.
+ * 			A transfer started from a completion callback is picked up by the same loop.
+ */
+static void hostSpiDmaRun(SPI_Name_t SPIx){
+	volatile SPI_Register_Offset_t* reg = hostSpiReg(SPIx);
+	HostSimSpi_t* spi = &hostSpi[SPIx];
+	if(spi -> dmaActive) return;
+	spi -> dmaActive = true;
+
+	for(;;){
+		bool moved = false;
+
+		int rx = (reg -> SPI_CR2 & CR2_RXDMAEN) ? hostDmaFind(SPIx, DMA_DIR_P2M) : -1;
+		if(rx >= 0 && (reg -> SPI_SR & SR_RXNE)){
+			hostDmaStore((uint8_t)rx, spi -> rxFrame);
+			reg -> SPI_SR &= ~SR_RXNE;
+			if(hostDmaAdvance((uint8_t)rx)) hostDmaComplete((uint8_t)rx);
+			continue; //The handler may have started the next transfer
+		}
+
+		int tx = (reg -> SPI_CR2 & CR2_TXDMAEN) ? hostDmaFind(SPIx, DMA_DIR_M2P) : -1;
+		if(tx >= 0 && !spi -> txFull){
+			reg -> SPI_DR = hostDmaLoad((uint8_t)tx);
+			hostSpiDataWritten(SPIx);
+			if(hostDmaAdvance((uint8_t)tx)){
+				if(reg -> SPI_CR1 & CR1_CRCEN) spi -> crcAfterTx = true;
+				hostDmaComplete((uint8_t)tx);
+			}
+			moved = true;
+		}
+
+		if(spi -> shifting){
+			hostSpiAdvance(SPIx);
+			moved = true;
+		}
+		if(!moved) break;
+	}
+	spi -> dmaActive = false;
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * GPIO / EXTI model
+ * ------------------------------------------------------------
+ */
+static void hostRunExtiHandler(uint8_t line){
+	static void (* const handlers[5])(void) = {EXTI0_IRQHandler, EXTI1_IRQHandler, EXTI2_IRQHandler,
+												EXTI3_IRQHandler, EXTI4_IRQHandler};
+	if(line <= 4) handlers[line]();
+	else if(line <= 9) EXTI9_5_IRQHandler();
+	else EXTI15_10_IRQHandler();
+
+	EXTI_REG -> PR &= ~(1U << line); //rc_w1 is not modelled: the handler's write only set the bit again
+}
+
+
+/*
+ * @brief	Edge on an EXTI line: set PR and, when unmasked, run the handler to completion
+ *
+ * 			An edge raised from inside a handler (e.g. a device output changing when the handler
+ * 			releases chip select) is tail-chained after it, as the NVIC would at equal priority.
+ */
+static void hostRaiseExti(uint8_t line){
+	EXTI_REG -> PR |= (1U << line);
+	if((EXTI_REG -> IMR & (1U << line)) == 0) return;
+
+	hostExtiPending |= (1U << line);
+	if(hostExtiActive) return;
+
+	hostExtiActive = true;
+	while(hostExtiPending != 0){
+		uint8_t next = (uint8_t)__builtin_ctz(hostExtiPending);
+		hostExtiPending &= ~(1U << next);
+		hostRunExtiHandler(next);
+	}
+	hostExtiActive = false;
+}
+
+
+static void hostGpioOutputChanged(GPIO_PortName_t port){
+	uint32_t odr = hostGpioReg(port) -> ODR & 0xFFFF;
+	uint32_t changed = odr ^ hostOdr[port];
+	hostOdr[port] = odr;
+	if(changed == 0) return;
+
+	for(int i = 0; i < (int)HOST_SIM_SPI_COUNT; i++){
+		HostSimSpi_t* spi = &hostSpi[i];
+		if(spi -> device == NULL || spi -> device -> nssPort != port) continue;
+		if((changed & (1U << spi -> device -> nssPin)) == 0) continue;
+
+		spi -> selected = ((odr & (1U << spi -> device -> nssPin)) == 0);
+		if(spi -> device -> select != NULL) spi -> device -> select(spi -> device -> context, spi -> selected);
+	}
+}
+
+
+static void hostGpioRegWritten(GPIO_PortName_t port, volatile uint32_t* reg){
+	volatile GPIO_Register_Offset_t* gpio = hostGpioReg(port);
+
+	if(reg == &gpio -> BSRR){
+		uint32_t bsrr = gpio -> BSRR;
+		uint32_t odr = gpio -> ODR & ~(bsrr >> 16);
+		gpio -> ODR = odr | (bsrr & 0xFFFF); //BSx wins over BRx
+		gpio -> BSRR = 0;					 //Write-only, reads as 0
+	}
+	else if(reg != &gpio -> ODR) return;
+
+	hostGpioOutputChanged(port);
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Driver hooks (SIM_REG_READ / SIM_REG_WRITTEN)
+ * ------------------------------------------------------------
+ */
+void HOST_SIM_regRead(volatile void* block, volatile uint32_t* reg){
+	int spi = hostSpiIndex(block);
+	if(spi >= 0) hostSpiRegRead((SPI_Name_t)spi, reg);
+}
+
+
+void HOST_SIM_regWritten(volatile void* block, volatile uint32_t* reg){
+	int spi = hostSpiIndex(block);
+	if(spi >= 0){
+		volatile SPI_Register_Offset_t* spiReg = hostSpiReg((SPI_Name_t)spi);
+		if(reg == &spiReg -> SPI_DR) hostSpiDataWritten((SPI_Name_t)spi);
+		else if(reg == &spiReg -> SPI_CR1) hostSpiControlWritten((SPI_Name_t)spi);
+		else if(reg == &spiReg -> SPI_CR2) hostSpiDmaRun((SPI_Name_t)spi);
+		return;
+	}
+
+	int port = hostGpioIndex(block);
+	if(port >= 0) hostGpioRegWritten((GPIO_PortName_t)port, reg);
+}
+
+
+DWT_Type* HOST_SIM_dwt(void){
+	uint32_t hclkMhz = RCC_getHCLKFreq() / 1000000U;
+	uint64_t now = hostNanoseconds() * hclkMhz / 1000U;
+
+	if(hostDwt.CYCCNT != hostDwtLast) hostDwtBase = now - hostDwt.CYCCNT; //Software wrote CYCCNT
+	if(hostDwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) hostDwt.CYCCNT = (uint32_t)(now - hostDwtBase);
+	hostDwtLast = hostDwt.CYCCNT;
+	return &hostDwt;
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Power-on state: registers at their reset values, no devices attached
+ */
+void HOST_SIM_reset(void){
+	if((uintptr_t)hostSimPeriph > UINT32_MAX){
+		fprintf(stderr, "host_sim: DMA addresses are 32-bit, link with -no-pie\n");
+		abort();
+	}
+
+	memset(hostSimPeriph, 0, sizeof(hostSimPeriph));
+	memset(hostSimCore, 0, sizeof(hostSimCore));
+	memset(hostSpi, 0, sizeof(hostSpi));
+	memset(hostOdr, 0, sizeof(hostOdr));
+	hostExtiPending = 0;
+	hostExtiActive = false;
+	hostSimPrimask = 0;
+	hostSimCoreDebug.DEMCR = 0;
+	hostDwt = (DWT_Type){0};
+	hostDwtLast = 0;
+
+	for(int i = 0; i < (int)HOST_SIM_SPI_COUNT; i++) hostSpiReg((SPI_Name_t)i) -> SPI_SR = SR_TXE;
+	RCC_REG -> RCC_CR = 0x00000083;		//HSION | HSIRDY, HSITRIM = 16
+}
+
+
+/*
+ * @brief	Put a device on @p SPIx; its chip select follows the ODR bit of device->nssPin
+ */
+void HOST_SIM_attachSpiDevice(SPI_Name_t SPIx, const HOST_SIM_SpiDevice_t* device){
+	if(SPIx > my_SPI5) return;
+	hostSpi[SPIx].device = device;
+	hostSpi[SPIx].selected = (device != NULL) && ((hostGpioReg(device -> nssPort) -> ODR & (1U << device -> nssPin)) == 0);
+}
+
+
+HOST_SIM_SpiStats_t HOST_SIM_getSpiStats(SPI_Name_t SPIx){
+	if(SPIx > my_SPI5) return (HOST_SIM_SpiStats_t){0};
+	return hostSpi[SPIx].stats;
+}
+
+
+/*
+ * @brief	Drive an input pin from a device model
+ *
+ * 			A rising/falling edge on a line routed to this port through SYSCFG_EXTICR sets EXTI_PR
+ * 			and, when unmasked in IMR, runs the EXTI IRQ handler before this returns.
+ */
+void HOST_SIM_setInput(GPIO_PortName_t port, GPIO_Pin_t pin, bool level){
+	volatile GPIO_Register_Offset_t* gpio = hostGpioReg(port);
+	uint32_t mask = 1U << pin;
+	bool old = (gpio -> IDR & mask) != 0;
+
+	if(level) gpio -> IDR |= mask;
+	else gpio -> IDR &= ~mask;
+	if(old == level) return;
+
+	uint32_t portCode = (port == my_GPIOH) ? 7U : (uint32_t)port;
+	uint32_t routed = (SYSCFG_REG -> SYSCFG_EXTICR[pin / 4] >> ((pin % 4) * 4)) & 0xF;
+	if(routed != portCode) return;
+
+	if((level && (EXTI_REG -> RTSR & mask)) || (!level && (EXTI_REG -> FTSR & mask))) hostRaiseExti((uint8_t)pin);
+}
+
+
+bool HOST_SIM_getOutput(GPIO_PortName_t port, GPIO_Pin_t pin){
+	return (hostGpioReg(port) -> ODR & (1U << pin)) != 0;
+}
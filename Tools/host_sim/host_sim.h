@@ -0,0 +1,67 @@
+/*
+ * @file	host_sim.h
+ * @brief	Register-level STM32F411 simulator for running the drivers on Linux
+ * 			Every *_REG pointer lands in a host register file (see REG_ADDR in registerAddress.h).
+ * 			On top of the plain memory the simulator models:
+ * 				SPI		one frame in flight plus the TX buffer; TXE/RXNE/BSY/OVR follow the frame as
+ * 						the driver polls SR, the frame is exchanged with the device whose chip
+ * 						select is low when it completes. Hardware CRC (TXCRCR/RXCRCR, CRCNEXT,
+ * 						CRCERR) runs on every frame while CRCEN is set.
+ * 				DMA		streams whose PAR is an SPI DR follow TXDMAEN/RXDMAEN; a transfer runs to
+ * 						completion inside the CR2 write and TC calls the stream IRQ handler.
+ * 						Buffers must be static and the program linked with -no-pie (M0AR is 32-bit).
+ * 				GPIO	BSRR folds into ODR, ODR edges on a chip-select pin reach the device,
+ * 						inputs driven by a device model raise EXTI lines and run the IRQ handler
+ * 				DWT		CYCCNT follows the host clock, scaled to HCLK
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef HOST_SIM_H_
+#define HOST_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "spi.h"
+#include "gpio_write_read.h"
+
+#define HOST_SIM_PERIPH_SIZE	0x00080000UL	//0x4000 0000 - 0x4007 FFFF
+#define HOST_SIM_CORE_SIZE		0x00001000UL	//0xE000 E000 - 0xE000 EFFF (NVIC, SCB)
+
+#define HOST_SIM_POLLS_PER_FRAME	2U			//SR/DR reads a frame takes to shift
+#define HOST_SIM_HANG_POLLS			1000000U	//RXNE/BSY polls with nothing on the bus before aborting
+
+/*
+ * Slave device on a simulated SPI bus. Each frame byte is exchanged MSB frame first
+ * (16-bit frames are two exchanges, high byte first).
+ */
+typedef struct{
+	void (*select)(void* context, bool selected);	//Chip select edge (may be NULL)
+	uint8_t (*exchange)(void* context, uint8_t mosi);	//One byte while selected, returns MISO
+	void* context;
+	GPIO_PortName_t nssPort;
+	GPIO_Pin_t nssPin;
+}HOST_SIM_SpiDevice_t;
+
+typedef struct{
+	uint32_t frames;		//Frames shifted
+	uint32_t unselected;	//Frames shifted with no device selected (MISO reads 0xFF)
+	uint32_t overruns;		//Frames completed while RXNE was still set (OVR)
+}HOST_SIM_SpiStats_t;
+
+
+/*
+ * --------------------------------------------------------
+ * Public API
+ * --------------------------------------------------------
+ */
+void HOST_SIM_reset(void);
+void HOST_SIM_attachSpiDevice(SPI_Name_t SPIx, const HOST_SIM_SpiDevice_t* device);
+HOST_SIM_SpiStats_t HOST_SIM_getSpiStats(SPI_Name_t SPIx);
+
+void HOST_SIM_setInput(GPIO_PortName_t port, GPIO_Pin_t pin, bool level);
+bool HOST_SIM_getOutput(GPIO_PortName_t port, GPIO_Pin_t pin);
+
+#endif /* HOST_SIM_H_ */
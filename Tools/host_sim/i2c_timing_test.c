@@ -0,0 +1,122 @@
+/*
+ * @file	i2c_timing_test.c
+ * @brief	Host checks for the I2C timing solver (Core/Src/i2c_timing.c)
+ *
+ * 			Compares FREQ / CCR / TRISE / FLTR and the achieved SCL against values worked out
+ * 			by hand from RM0383 18.6.8 - 18.6.10 for the clock trees this board uses, and checks
+ * 			that unreachable combinations are refused. Exit status is the number of failed checks.
+ *
+ * 			Build (from the repository root):
+ * 				gcc -std=gnu11 -O2 -Wall -DHOST_SIM -ITools/host_sim/include -ICore/Inc \
+ * 					-o i2c_timing_test Tools/host_sim/i2c_timing_test.c Core/Src/i2c_timing.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include <stdio.h>
+
+#include "i2c_timing.h"
+
+static int failures;
+
+#define CHECK(cond, ...)	do{ \
+								if(!(cond)){ \
+									failures++; \
+									printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+									printf(__VA_ARGS__); \
+									printf("\n"); \
+								} \
+							}while(0)
+
+typedef struct{
+	uint32_t pclk1;
+	I2C_CCR_Mode_t mode;
+	uint32_t scl;
+	uint8_t freq;
+	uint16_t ccr;
+	uint8_t trise;
+	uint32_t achieved;
+}TimingCase_t;
+
+static const TimingCase_t CASES[] = {
+		/* RCC_init() tree: PCLK1 = 50MHz */
+		{50000000U, I2C_SM_100K,                  100000U, 50, 250, 51, 100000U},
+		{50000000U, I2C_FM_400K_DUTY_2LOW_1HIGH,  400000U, 50,  42, 16, 396825U},
+		{50000000U, I2C_FM_400K_DUTY_16LOW_9HIGH, 400000U, 50,   5, 16, 400000U},
+		/* Reset tree: HSI 16MHz, APB1 /1 */
+		{16000000U, I2C_SM_100K,                  100000U, 16,  80, 17, 100000U},
+		{16000000U, I2C_FM_400K_DUTY_2LOW_1HIGH,  400000U, 16,  14,  5, 380952U},
+		/* 84MHz core, APB1 /2 */
+		{42000000U, I2C_FM_400K_DUTY_2LOW_1HIGH,  400000U, 42,  35, 13, 400000U},
+		{42000000U, I2C_FM_400K_DUTY_16LOW_9HIGH, 400000U, 42,   5, 13, 336000U},
+		/* Slow buses and the CCR floors */
+		{50000000U, I2C_SM_100K,                   10000U, 50, 2500, 51, 10000U},
+		{ 2000000U, I2C_SM_100K,                  100000U,  2,  10,  3, 100000U},
+		{ 4000000U, I2C_FM_400K_DUTY_16LOW_9HIGH, 400000U,  4,   1,  2, 160000U},
+};
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Checks
+ * ------------------------------------------------------------
+ */
+static void testTable(void){
+	for(unsigned i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++){
+		const TimingCase_t* c = &CASES[i];
+		I2C_Timing_t t;
+		I2C_Status_t status = I2C_computeTiming(c -> pclk1, c -> mode, c -> scl, true, 0, &t);
+
+		CHECK(status == I2C_OK, "case %u refused", i);
+		if(status != I2C_OK) continue;
+		CHECK(t.freq == c -> freq, "case %u FREQ %u, expected %u", i, t.freq, c -> freq);
+		CHECK(t.ccr == c -> ccr, "case %u CCR %u, expected %u", i, t.ccr, c -> ccr);
+		CHECK(t.trise == c -> trise, "case %u TRISE %u, expected %u", i, t.trise, c -> trise);
+		CHECK(t.sclFreq == c -> achieved, "case %u SCL %lu, expected %lu", i,
+			  (unsigned long)t.sclFreq, (unsigned long)c -> achieved);
+		CHECK(t.sclFreq <= c -> scl, "case %u SCL %lu above the request", i, (unsigned long)t.sclFreq);
+		CHECK(t.fastMode == (c -> mode != I2C_SM_100K), "case %u F/S", i);
+		CHECK(t.duty == (c -> mode == I2C_FM_400K_DUTY_16LOW_9HIGH), "case %u DUTY", i);
+	}
+}
+
+
+static void testFilters(void){
+	I2C_Timing_t t;
+
+	CHECK(I2C_computeTiming(50000000U, I2C_SM_100K, 100000U, true, 0, &t) == I2C_OK &&
+		  !t.analogFilterOff && t.digitalFilter == 0, "default filters");
+	CHECK(I2C_computeTiming(50000000U, I2C_SM_100K, 100000U, false, 15, &t) == I2C_OK &&
+		  t.analogFilterOff && t.digitalFilter == 15, "analog off, DNF 15");
+	CHECK(I2C_computeTiming(50000000U, I2C_SM_100K, 100000U, true, 16, &t) == I2C_ERROR, "DNF 16 accepted");
+}
+
+
+static void testRejected(void){
+	I2C_Timing_t t = { .ccr = 0xABC };
+
+	CHECK(I2C_computeTiming(1000000U, I2C_SM_100K, 100000U, true, 0, &t) == I2C_ERROR, "PCLK1 1MHz accepted");
+	CHECK(I2C_computeTiming(3000000U, I2C_FM_400K_DUTY_2LOW_1HIGH, 400000U, true, 0, &t) == I2C_ERROR,
+		  "fast mode below 4MHz accepted");
+	CHECK(I2C_computeTiming(54000000U, I2C_SM_100K, 100000U, true, 0, &t) == I2C_ERROR, "PCLK1 54MHz accepted");
+	CHECK(I2C_computeTiming(50000000U, I2C_SM_100K, 400000U, true, 0, &t) == I2C_ERROR, "400kHz in standard mode");
+	CHECK(I2C_computeTiming(50000000U, I2C_FM_400K_DUTY_16LOW_9HIGH, 1000000U, true, 0, &t) == I2C_ERROR,
+		  "1MHz in fast mode");
+	CHECK(I2C_computeTiming(50000000U, I2C_SM_100K, 1000U, true, 0, &t) == I2C_ERROR, "CCR overflow accepted");
+	CHECK(I2C_computeTiming(50000000U, I2C_SM_100K, 0, true, 0, &t) == I2C_ERROR, "0Hz accepted");
+	CHECK(I2C_computeTiming(50000000U, I2C_SM_100K, 100000U, true, 0, NULL) == I2C_ERROR, "NULL output");
+	CHECK(t.ccr == 0xABC, "refused call wrote the output");
+}
+
+
+
+int main(void){
+	testTable();
+	testFilters();
+	testRejected();
+
+	printf("%s (%d failed)\n", failures ? "FAILED" : "All checks passed", failures);
+	return failures;
+}
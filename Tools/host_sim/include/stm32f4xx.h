@@ -0,0 +1,69 @@
+/*
+ * @file	stm32f4xx.h
+ * @brief	Host stand-in for the CMSIS device header (Tools/host_sim only)
+ * 			Found before Drivers/CMSIS on the include path of the host build. Provides the few
+ * 			CMSIS names the drivers use: SET/RESET, PRIMASK intrinsics and the DWT cycle counter.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef HOST_SIM_STM32F4XX_H_
+#define HOST_SIM_STM32F4XX_H_
+
+#include <stdint.h>
+
+typedef enum{RESET = 0U, SET = !RESET}FlagStatus, ITStatus;
+typedef enum{DISABLE = 0U, ENABLE = !DISABLE}FunctionalState;
+
+#define __IO	volatile
+
+
+/*
+ * PRIMASK: interrupts are delivered synchronously by the simulator, masking only records state
+ */
+extern uint32_t hostSimPrimask;
+
+static inline uint32_t __get_PRIMASK(void){ return hostSimPrimask; }
+static inline void __set_PRIMASK(uint32_t primask){ hostSimPrimask = primask; }
+static inline void __disable_irq(void){ hostSimPrimask = 1U; }
+static inline void __enable_irq(void){ hostSimPrimask = 0U; }
+static inline void __NOP(void){}
+static inline void __DSB(void){}
+static inline void __ISB(void){}
+static inline void __DMB(void){}
+
+
+/*
+ * DWT cycle counter: CYCCNT follows the host monotonic clock scaled to HCLK on every access
+ */
+typedef struct{
+	volatile uint32_t CTRL;
+	volatile uint32_t CYCCNT;
+}DWT_Type;
+
+typedef struct{
+	volatile uint32_t DEMCR;
+}CoreDebug_Type;
+
+DWT_Type* HOST_SIM_dwt(void);
+extern CoreDebug_Type hostSimCoreDebug;
+
+#define DWT							(HOST_SIM_dwt())
+#define CoreDebug					(&hostSimCoreDebug)
+#define CoreDebug_DEMCR_TRCENA_Msk	(1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk		(1UL << 0)
+
+
+/*
+ * DMA_SxCR bits used by dma.c and the DMA model in host_sim.c
+ */
+#define DMA_SxCR_EN		(1UL << 0)
+#define DMA_SxCR_DMEIE	(1UL << 1)
+#define DMA_SxCR_TEIE	(1UL << 2)
+#define DMA_SxCR_HTIE	(1UL << 3)
+#define DMA_SxCR_TCIE	(1UL << 4)
+#define DMA_SxCR_CIRC	(1UL << 8)
+#define DMA_SxCR_MINC	(1UL << 10)
+
+#endif /* HOST_SIM_STM32F4XX_H_ */
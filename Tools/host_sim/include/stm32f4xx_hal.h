@@ -0,0 +1,22 @@
+/*
+ * @file	stm32f4xx_hal.h
+ * @brief	Host stand-in for the HAL umbrella header (Tools/host_sim only)
+ * 			The drivers only borrow the RCC clock-enable macros from the HAL; the simulated
+ * 			peripherals are always clocked.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef HOST_SIM_STM32F4XX_HAL_H_
+#define HOST_SIM_STM32F4XX_HAL_H_
+
+#include "stm32f4xx.h"
+
+#define __HAL_RCC_SPI1_CLK_ENABLE()		((void)0)
+#define __HAL_RCC_SPI2_CLK_ENABLE()		((void)0)
+#define __HAL_RCC_SPI3_CLK_ENABLE()		((void)0)
+#define __HAL_RCC_SPI4_CLK_ENABLE()		((void)0)
+#define __HAL_RCC_SPI5_CLK_ENABLE()		((void)0)
+
+#endif /* HOST_SIM_STM32F4XX_HAL_H_ */
@@ -0,0 +1,270 @@
+/*
+ * @file	l3gd20_model.c
+ * @brief	L3GD20 register, auto-increment and FIFO behaviour (datasheet DocID022116, sections 5 and 7)
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include <string.h>
+
+#include "l3gd20_model.h"
+#include "l3gd20.h"
+
+#define MODEL_FIFO_MODE(fifoCtrl)	(((fifoCtrl) >> 5) & 0x7)
+#define MODEL_MODE_BYPASS			0U
+#define MODEL_MODE_FIFO				1U
+#define MODEL_MODE_STREAM			2U
+
+/*
+ * ------------------------------------------------------------
+ * Model state
+ * ------------------------------------------------------------
+ */
+typedef struct{
+	uint8_t regs[0x40];
+	uint8_t fifo[L3GD20_FIFO_DEPTH][L3GD20_SAMPLE_BYTES];
+	uint8_t fifoHead;		//Oldest sample
+	uint8_t fifoLevel;
+
+	bool selected;
+	bool haveCommand;		//First byte of the transaction seen
+	bool read;
+	bool autoIncrement;
+	uint8_t address;
+
+	GPIO_PortName_t int2Port;
+	GPIO_Pin_t int2Pin;
+
+	L3GD20_MODEL_Stats_t stats;
+}L3GD20_Model_t;
+
+static L3GD20_Model_t model;
+static HOST_SIM_SpiDevice_t modelDevice;
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------
+ */
+static bool modelFifoActive(void){
+	return (model.regs[CTRL_REG5] & L3GD20_FIFO_ENABLE) && MODEL_FIFO_MODE(model.regs[FIFO_CTRL_REG]) != MODEL_MODE_BYPASS;
+}
+
+
+static uint8_t modelFifoSrc(void){
+	uint8_t src = (uint8_t)(model.fifoLevel & L3GD20_FIFO_FSS_MASK);
+	uint8_t watermark = model.regs[FIFO_CTRL_REG] & 0x1F;
+
+	if(watermark != 0 && model.fifoLevel >= watermark) src |= L3GD20_FIFO_WTM_STT;
+	if(model.fifoLevel == L3GD20_FIFO_DEPTH) src |= L3GD20_FIFO_OVRN_STT;
+	if(model.fifoLevel == 0) src |= L3GD20_FIFO_EMPTY_STT;
+	return src;
+}
+
+
+/*
+ * @brief	Drive INT2 from the CTRL_REG3 I2_xxx enables
+ * 			Called only between transactions so the MCU never sees the pin move mid-transfer
+ */
+static void modelUpdateInt2(void){
+	uint8_t ctrl3 = model.regs[CTRL_REG3];
+	uint8_t src = modelFifoSrc();
+	bool level = false;
+
+	if((ctrl3 & L3GD20_INT2_DATAREADY_ENABLE) && (model.regs[STATUS_REG] & L3GD20_XYZDATA_AV_STT)) level = true;
+	if(modelFifoActive()){
+		if((ctrl3 & L3GD20_INT2_WATERMARK_ENABLE) && (src & L3GD20_FIFO_WTM_STT)) level = true;
+		if((ctrl3 & L3GD20_INT2_FIFO_OVERRUN_ENABLE) && (src & L3GD20_FIFO_OVRN_STT)) level = true;
+		if((ctrl3 & L3GD20_INT2_FIFO_EMPTY_ENABLE) && (src & L3GD20_FIFO_EMPTY_STT)) level = true;
+	}
+	HOST_SIM_setInput(model.int2Port, model.int2Pin, level);
+}
+
+
+static void modelFifoClear(void){
+	model.fifoHead = 0;
+	model.fifoLevel = 0;
+}
+
+
+/*
+ * @brief	OUT_X_L..OUT_Z_H read: from the FIFO head when the FIFO runs, else the output registers
+ *			Reading OUT_Z_H pops the sample.
+ */
+static uint8_t modelReadOutput(uint8_t address){
+	uint8_t index = (uint8_t)(address - OUT_X_L);
+
+	if(!modelFifoActive() || model.fifoLevel == 0) return model.regs[address];
+
+	uint8_t value = model.fifo[model.fifoHead][index];
+	if(address == OUT_Z_H){
+		model.fifoHead = (uint8_t)((model.fifoHead + 1U) % L3GD20_FIFO_DEPTH);
+		model.fifoLevel--;
+	}
+	return value;
+}
+
+
+static uint8_t modelReadReg(uint8_t address){
+	model.stats.reads++;
+
+	if(address >= OUT_X_L && address <= OUT_Z_H){
+		uint8_t value = modelReadOutput(address);
+		if(address == OUT_Z_H) model.regs[STATUS_REG] = 0; //All axes consumed
+		return value;
+	}
+	if(address == FIFO_SRC_REG) return modelFifoSrc();
+	return model.regs[address];
+}
+
+
+static void modelWriteReg(uint8_t address, uint8_t value){
+	model.stats.writes++;
+
+	bool writable = (address >= CTRL_REG1 && address <= REFERENCE) || address == FIFO_CTRL_REG ||
+					address == INT1_CFG || (address >= INT1_TSH_XH && address <= INT1_DURATION);
+	if(!writable) return;
+
+	uint8_t old = model.regs[address];
+	model.regs[address] = value;
+
+	//Any trip through bypass mode (or FIFO_EN going low) restarts the FIFO empty
+	if(address == FIFO_CTRL_REG && MODEL_FIFO_MODE(value) == MODEL_MODE_BYPASS) modelFifoClear();
+	if(address == CTRL_REG5 && (old & L3GD20_FIFO_ENABLE) && !(value & L3GD20_FIFO_ENABLE)) modelFifoClear();
+}
+
+
+/*
+ * @brief	Next register for a multi-byte access
+ * 			In FIFO/stream mode the pointer wraps OUT_Z_H -> OUT_X_L so the whole FIFO reads as
+ * 			one burst; otherwise it simply counts up within the 6-bit address space.
+ */
+static uint8_t modelNextAddress(uint8_t address){
+	if(address == OUT_Z_H && modelFifoActive()) return OUT_X_L;
+	return (uint8_t)((address + 1U) & L3GD20_SPI_ADDR_MASK);
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * SPI device callbacks
+ * ------------------------------------------------------------
+ */
+static void modelSelect(void* context, bool selected){
+	(void)context;
+	model.selected = selected;
+	model.haveCommand = false;
+
+	if(selected) model.stats.transactions++;
+	else modelUpdateInt2();
+}
+
+
+static uint8_t modelExchange(void* context, uint8_t mosi){
+	(void)context;
+
+	if(!model.haveCommand){
+		model.haveCommand = true;
+		model.read = (mosi & L3GD20_SPI_READ) != 0;
+		model.autoIncrement = (mosi & L3GD20_SPI_MULTIBYTE) != 0;
+		model.address = mosi & L3GD20_SPI_ADDR_MASK;
+		return 0xFF; //SDO is high-Z during the command byte
+	}
+
+	uint8_t miso = 0xFF;
+	if(model.read) miso = modelReadReg(model.address);
+	else modelWriteReg(model.address, mosi);
+
+	if(model.autoIncrement) model.address = modelNextAddress(model.address);
+	return miso;
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	Power-on reset of the model and attach it to @p SPIx with chip select on nssPort/nssPin
+ */
+void L3GD20_MODEL_init(SPI_Name_t SPIx, GPIO_PortName_t nssPort, GPIO_Pin_t nssPin,
+					   GPIO_PortName_t int2Port, GPIO_Pin_t int2Pin){
+	memset(&model, 0, sizeof(model));
+	model.regs[WHO_AM_I] = I_AM_L3GD20;
+	model.regs[CTRL_REG1] = L3GD20_AXES_ENABLE; //Power-down with all axes enabled
+	model.int2Port = int2Port;
+	model.int2Pin = int2Pin;
+
+	modelDevice = (HOST_SIM_SpiDevice_t){ .select = modelSelect, .exchange = modelExchange, .context = NULL,
+										  .nssPort = nssPort, .nssPin = nssPin };
+	HOST_SIM_attachSpiDevice(SPIx, &modelDevice);
+	HOST_SIM_setInput(int2Port, int2Pin, false);
+}
+
+
+/*
+ * @brief	One ODR period elapses: a new X/Y/Z sample is converted
+ *
+ * 			Ignored in power-down. The sample lands in the output registers and, when the FIFO
+ * 			runs, in the FIFO (FIFO mode stops when full, stream mode drops the oldest).
+ * 			INT2 is updated straight away unless a transaction is in progress.
+ */
+void L3GD20_MODEL_pushSample(int16_t x, int16_t y, int16_t z){
+	if((model.regs[CTRL_REG1] & L3GD20_ACTIVE) == 0) return;
+
+	uint8_t raw[L3GD20_SAMPLE_BYTES];
+	int16_t axes[3] = {x, y, z};
+	bool bigEndian = (model.regs[CTRL_REG4] & L3GD20_BIG_ENDIAN) != 0;
+	for(uint8_t i = 0; i < 3; i++){
+		uint8_t lo = (uint8_t)((uint16_t)axes[i] & 0xFF);
+		uint8_t hi = (uint8_t)((uint16_t)axes[i] >> 8);
+		raw[2 * i] = bigEndian ? hi : lo;
+		raw[2 * i + 1] = bigEndian ? lo : hi;
+	}
+	memcpy(&model.regs[OUT_X_L], raw, sizeof(raw));
+
+	uint8_t status = model.regs[STATUS_REG];
+	if(status & L3GD20_XYZDATA_AV_STT) status |= 0xF0; //Previous sample never read: XYZOR + ZOR/YOR/XOR
+	model.regs[STATUS_REG] = status | 0x0F;
+
+	if(modelFifoActive()){
+		uint8_t mode = MODEL_FIFO_MODE(model.regs[FIFO_CTRL_REG]);
+
+		if(model.fifoLevel == L3GD20_FIFO_DEPTH){
+			model.stats.fifoOverruns++;
+			if(mode == MODEL_MODE_STREAM){
+				model.fifoHead = (uint8_t)((model.fifoHead + 1U) % L3GD20_FIFO_DEPTH);
+				model.fifoLevel--;
+			}
+		}
+		if(model.fifoLevel < L3GD20_FIFO_DEPTH){
+			uint8_t slot = (uint8_t)((model.fifoHead + model.fifoLevel) % L3GD20_FIFO_DEPTH);
+			memcpy(model.fifo[slot], raw, sizeof(raw));
+			model.fifoLevel++;
+		}
+	}
+
+	if(!model.selected) modelUpdateInt2();
+}
+
+
+uint8_t L3GD20_MODEL_getReg(uint8_t reg){
+	return model.regs[reg & L3GD20_SPI_ADDR_MASK];
+}
+
+
+uint8_t L3GD20_MODEL_fifoLevel(void){
+	return model.fifoLevel;
+}
+
+
+L3GD20_MODEL_Stats_t L3GD20_MODEL_getStats(void){
+	return model.stats;
+}
@@ -0,0 +1,36 @@
+/*
+ * @file	l3gd20_model.h
+ * @brief	L3GD20 gyroscope register model on a simulated SPI bus (Tools/host_sim only)
+ * 			Register file with WHO_AM_I = 0xD4 and the CTRL reset values, the SPI command byte
+ * 			(RW bit 7, MS auto-increment bit 6), STATUS_REG, and the 32-sample FIFO in bypass,
+ * 			FIFO and stream mode with FIFO_SRC and the INT2 watermark/overrun/empty/DRDY output.
+ * 			Samples only appear when the test pushes them; filters and INT1 are not modelled.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#ifndef L3GD20_MODEL_H_
+#define L3GD20_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "host_sim.h"
+
+typedef struct{
+	uint32_t transactions;	//Chip-select assertions
+	uint32_t reads;			//Register bytes read
+	uint32_t writes;		//Register bytes written (read-only targets included)
+	uint32_t fifoOverruns;	//Samples overwritten (stream) or refused (FIFO mode) while full
+}L3GD20_MODEL_Stats_t;
+
+void L3GD20_MODEL_init(SPI_Name_t SPIx, GPIO_PortName_t nssPort, GPIO_Pin_t nssPin,
+					   GPIO_PortName_t int2Port, GPIO_Pin_t int2Pin);
+void L3GD20_MODEL_pushSample(int16_t x, int16_t y, int16_t z);
+
+uint8_t L3GD20_MODEL_getReg(uint8_t reg);
+uint8_t L3GD20_MODEL_fifoLevel(void);
+L3GD20_MODEL_Stats_t L3GD20_MODEL_getStats(void);
+
+#endif /* L3GD20_MODEL_H_ */
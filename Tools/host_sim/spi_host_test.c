@@ -0,0 +1,395 @@
+/*
+ * @file	spi_host_test.c
+ * @brief	Runs the unmodified SPI and L3GD20 drivers against the host simulator
+ *
+ * 			Checks SPI_readReceivedData, SPI_burstRead, SPI_write2Device, SPI_transfer8/16, the
+ * 			L3GD20 init + FIFO stream path (INT2 on PE1 -> EXTI1 -> drain), hardware CRC (polled and
+ * 			DMA) and an SPI_BUS round trip, then times the polled transfer paths. Exit status is the
+ * 			number of failed checks, so CI can gate on it.
+ *
+ * 			Build (from the repository root):
+ * 				gcc -std=gnu11 -O2 -Wall -no-pie -DHOST_SIM -ITools/host_sim/include -ITools/host_sim -ICore/Inc \
+ * 					-o spi_host_test Tools/host_sim/host_sim.c Tools/host_sim/l3gd20_model.c Tools/host_sim/spi_host_test.c \
+ * 					Core/Src/spi.c Core/Src/spi_bus.c Core/Src/gpio_write_read.c Core/Src/exti.c Core/Src/dma.c \
+ * 					Core/Src/rcc.c Core/Src/timer.c Core/Src/flash.c Core/Src/l3gd2.c
+ * 			Usage:	spi_host_test [iterations]
+ *
+ * 			Timings are host nanoseconds per call through the register model: they compare driver
+ * 			code paths (register accesses, flag polls) with each other, not with SCK on the board.
+ * 			The SPI IRQ state machine is not simulated.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_sim.h"
+#include "l3gd20_model.h"
+#include "l3gd20.h"
+#include "spi_bus.h"
+
+static int failures;
+
+#define CHECK(cond, ...)	do{ \
+								if(!(cond)){ \
+									failures++; \
+									printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+									printf(__VA_ARGS__); \
+									printf("\n"); \
+								} \
+							}while(0)
+
+static const SPI_GPIO_Config_t GYRO = {
+		.SPIx = my_SPI1,
+		.sckPin = my_GPIO_PIN_5, .sckPort = my_GPIOA,
+		.nssPin = my_GPIO_PIN_3, .nssPort = my_GPIOE,
+		.mosiPin = my_GPIO_PIN_7, .mosiPort = my_GPIOA,
+		.misoPin = my_GPIO_PIN_6, .misoPort = my_GPIOA
+};
+
+static const SPI_GPIO_Config_t LOOP = {
+		.SPIx = my_SPI2,
+		.sckPin = my_GPIO_PIN_13, .sckPort = my_GPIOB,
+		.nssPin = my_GPIO_PIN_12, .nssPort = my_GPIOB,
+		.mosiPin = my_GPIO_PIN_15, .mosiPort = my_GPIOB,
+		.misoPin = my_GPIO_PIN_14, .misoPort = my_GPIOB
+};
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------
+ */
+
+/*
+ * @brief	MISO echoes MOSI one byte late, so every frame after the first reads back the previous one
+ */
+static uint8_t loopbackExchange(void* context, uint8_t mosi){
+	uint8_t* last = context;
+	uint8_t miso = *last;
+	*last = mosi;
+	return miso;
+}
+
+
+/*
+ * CRC-8 slave (polynomial 0x07, the SPI calculator's rules): answers 0xA0 + n for @p len frames,
+ * then its own CRC of those, and keeps the CRC frame the master sent for comparison
+ */
+typedef struct{
+	uint16_t len;
+	uint16_t count;
+	uint8_t txCrc;		//Over MISO
+	uint8_t rxCrc;		//Over MOSI
+	uint8_t masterCrc;	//CRC frame received from the master
+	bool corrupt;		//Flip one bit of the slave CRC
+}CrcSlave_t;
+
+static uint8_t crc8(uint8_t crc, uint8_t data){
+	crc ^= data;
+	for(uint8_t i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+	return crc;
+}
+
+static void crcSlaveSelect(void* context, bool selected){
+	CrcSlave_t* slave = context;
+	if(!selected) return;
+	slave -> count = 0;
+	slave -> txCrc = 0;
+	slave -> rxCrc = 0;
+}
+
+static uint8_t crcSlaveExchange(void* context, uint8_t mosi){
+	CrcSlave_t* slave = context;
+	if(slave -> count++ < slave -> len){
+		uint8_t miso = (uint8_t)(0xA0 + slave -> count - 1U);
+		slave -> rxCrc = crc8(slave -> rxCrc, mosi);
+		slave -> txCrc = crc8(slave -> txCrc, miso);
+		return miso;
+	}
+	slave -> masterCrc = mosi;
+	return slave -> corrupt ? (uint8_t)(slave -> txCrc ^ 0x01) : slave -> txCrc;
+}
+
+
+static volatile uint8_t transferDone;
+static volatile bool transferFailed;
+static SPI_BusTransaction_t busChain[3];
+
+/*
+ * @brief	DMA/bus completion; the first bus transaction queues busChain from the IRQ
+ */
+static void transferCallback(SPI_Name_t SPIx, bool ok, void* context){
+	transferDone++;
+	if(!ok) transferFailed = true;
+	if(context == busChain){
+		for(uint8_t i = 0; i < 3; i++){
+			if(!SPI_BUS_submit(SPIx, &busChain[i])) transferFailed = true;
+		}
+	}
+}
+
+
+static void busInit(SPI_GPIO_Config_t config){
+	SPI_GPIO_init(config);
+	writePin(config.nssPin, config.nssPort, BSRR, my_GPIO_PIN_SET); //Deselect before the first transfer
+	SPI_basicConfigInit(config, STM32_MASTER, DFF_8BITS, FPCLK_DIV2, SOFTWARE_SLAVE_ENABLE, SPI_ENABLE);
+}
+
+
+static uint64_t nowNs(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static void report(const char* name, uint64_t start, uint32_t iterations, uint32_t bytes){
+	double ns = (double)(nowNs() - start) / iterations;
+	printf("  %-34s %9.1f ns/call  %7.2f ns/byte\n", name, ns, ns / bytes);
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Checks
+ * ------------------------------------------------------------
+ */
+static void testRegisterAccess(void){
+	CHECK((uint8_t)SPI_readReceivedData(GYRO, WHO_AM_I) == I_AM_L3GD20, "WHO_AM_I via SPI_readReceivedData");
+
+	uint8_t ctrl[5] = {0};
+	SPI_burstRead(GYRO, CTRL_REG1, ctrl, sizeof(ctrl));
+	CHECK(ctrl[0] == L3GD20_AXES_ENABLE && ctrl[1] == 0 && ctrl[4] == 0, "CTRL_REG1..5 reset values (got %02X)", ctrl[0]);
+
+	SPI_write2Device(GYRO, REFERENCE, 0x5A);
+	uint8_t ref = 0;
+	SPI_burstRead(GYRO, REFERENCE, &ref, 1);
+	CHECK(ref == 0x5A && L3GD20_MODEL_getReg(REFERENCE) == 0x5A, "REFERENCE write/read back (got %02X)", ref);
+
+	SPI_write2Device(GYRO, WHO_AM_I, 0x00);
+	CHECK(L3GD20_MODEL_getReg(WHO_AM_I) == I_AM_L3GD20, "WHO_AM_I must stay read-only");
+}
+
+
+static void testInitAndBurst(void){
+	CHECK(L3GD20_init(GYRO, L3GD20_ODR760HZ_BW100HZ, L3GD20_FS_500DPS), "L3GD20_init");
+	CHECK(L3GD20_MODEL_getReg(CTRL_REG1) == (L3GD20_ODR760HZ_BW100HZ | L3GD20_ACTIVE | L3GD20_AXES_ENABLE),
+		  "CTRL_REG1 after init (got %02X)", L3GD20_MODEL_getReg(CTRL_REG1));
+	CHECK(L3GD20_MODEL_getReg(CTRL_REG4) == L3GD20_FS_500DPS, "CTRL_REG4 after init");
+
+	L3GD20_MODEL_pushSample(1000, -2000, 3000);
+	uint8_t burst[L3GD20_STATUS_XYZ_BURST_LEN];
+	SPI_burstRead(GYRO, STATUS_REG, burst, sizeof(burst));
+	int16_t x = (int16_t)(burst[1] | (burst[2] << 8));
+	int16_t y = (int16_t)(burst[3] | (burst[4] << 8));
+	int16_t z = (int16_t)(burst[5] | (burst[6] << 8));
+	CHECK(burst[0] & L3GD20_XYZDATA_AV_STT, "STATUS_REG ZYXDA before the read");
+	CHECK(x == 1000 && y == -2000 && z == 3000, "STATUS+XYZ burst (got %d %d %d)", x, y, z);
+	CHECK(L3GD20_MODEL_getReg(STATUS_REG) == 0, "STATUS_REG cleared once OUT_Z_H was read");
+}
+
+
+static void testFifoStream(void){
+	const uint8_t WATERMARK = 8;
+	const uint16_t PUSHED = 20;
+
+	CHECK(L3GD20_streamStart(WATERMARK, my_GPIO_PIN_1, my_GPIOE), "L3GD20_streamStart");
+	for(uint16_t i = 0; i < PUSHED; i++) L3GD20_MODEL_pushSample((int16_t)i, (int16_t)(-i), (int16_t)(i * 10));
+
+	L3GD20_Sample_t samples[32];
+	uint16_t n = L3GD20_read(samples, 32);
+	L3GD20_Stats_t stats = L3GD20_getStats();
+
+	//Two watermark interrupts drain 16 samples, the last 4 wait below the watermark
+	CHECK(n == 16, "samples drained by the INT2 handler (got %u)", n);
+	CHECK(stats.drains == 2 && stats.fifoOverruns == 0, "drains/overruns (got %lu/%lu)",
+		  (unsigned long)stats.drains, (unsigned long)stats.fifoOverruns);
+	CHECK(L3GD20_MODEL_fifoLevel() == PUSHED - 16, "FIFO level left in the model (got %u)", L3GD20_MODEL_fifoLevel());
+
+	bool ordered = true;
+	for(uint16_t i = 0; i < n; i++){
+		if(samples[i].x != (int16_t)i || samples[i].y != (int16_t)(-i) || samples[i].z != (int16_t)(i * 10)) ordered = false;
+	}
+	CHECK(ordered, "FIFO samples in order through the OUT_Z_H -> OUT_X_L wrap");
+
+	L3GD20_streamStop();
+	CHECK(L3GD20_MODEL_fifoLevel() == 0, "bypass mode empties the FIFO");
+}
+
+
+static void testTransfers(void){
+	uint8_t tx[9] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99};
+	uint8_t rx[9];
+
+	SPI_transfer8(LOOP, tx, rx, sizeof(tx));
+	CHECK(memcmp(&rx[1], tx, sizeof(tx) - 1) == 0, "SPI_transfer8 loopback");
+
+	memset(rx, 0, sizeof(rx));
+	SPI_transfer16(LOOP, tx, rx, sizeof(tx), SPI_PACK_BIG_ENDIAN); //4 words + 1 trailing byte
+	CHECK(memcmp(&rx[1], tx, sizeof(tx) - 1) == 0, "SPI_transfer16 big-endian matches the 8-bit wire order");
+	CHECK((SPI_readRegister(my_SPI2, SPI_CR1) & (1U << 11)) == 0, "DFF back to 8 bits");
+}
+
+
+static void testCrc(const HOST_SIM_SpiDevice_t* loopback){
+	static CrcSlave_t slave;
+	static const HOST_SIM_SpiDevice_t device = { .select = crcSlaveSelect, .exchange = crcSlaveExchange, .context = &slave,
+												 .nssPort = my_GPIOB, .nssPin = my_GPIO_PIN_12 };
+	static const uint8_t tx[6] = {0x01, 0x00, 0xFF, 0x5A, 0xC3, 0x7E};
+	static uint8_t rx[6];
+	const uint8_t expected[6] = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+
+	HOST_SIM_attachSpiDevice(my_SPI2, &device);
+	slave.len = sizeof(tx);
+	CHECK(SPI_CRC_enable(my_SPI2, 0x07), "SPI_CRC_enable");
+
+	CHECK(SPI_transferCRC(LOOP, tx, rx, sizeof(tx)), "polled CRC transfer, matching slave CRC");
+	CHECK(memcmp(rx, expected, sizeof(rx)) == 0, "polled CRC data frames");
+	CHECK(slave.masterCrc == slave.rxCrc, "master CRC frame (got %02X, want %02X)", slave.masterCrc, slave.rxCrc);
+
+	slave.corrupt = true;
+	CHECK(!SPI_transferCRC(LOOP, tx, rx, sizeof(tx)), "polled CRC transfer, corrupted slave CRC");
+	CHECK(readSPI(4, my_SPI2, SPI_SR) == 0, "CRCERR cleared after the mismatch");
+
+	//DMA: the hardware appends TXCRCR after the last TX item by itself
+	slave.corrupt = false;
+	memset(rx, 0, sizeof(rx));
+	transferDone = 0;
+	transferFailed = false;
+	SPI_DMA_init(LOOP);
+	CHECK(SPI_DMA_transfer(my_SPI2, tx, rx, sizeof(tx), transferCallback, NULL), "SPI_DMA_transfer with CRC");
+	CHECK(transferDone == 1 && !transferFailed && !SPI_DMA_busy(my_SPI2), "DMA CRC transfer completed and matched");
+	CHECK(memcmp(rx, expected, sizeof(rx)) == 0 && slave.masterCrc == slave.rxCrc, "DMA CRC data and CRC frame");
+
+	SPI_CRCStats_t stats = SPI_CRC_getStats(my_SPI2);
+	CHECK(stats.transfers == 3 && stats.errors == 1, "CRC stats (got %lu/%lu)",
+		  (unsigned long)stats.transfers, (unsigned long)stats.errors);
+
+	SPI_CRC_disable(my_SPI2);
+	HOST_SIM_attachSpiDevice(my_SPI2, loopback);
+}
+
+
+/*
+ * @brief	Two devices on the loopback chip select: 8-bit mode 0 and 16-bit mode 3
+ */
+static void testBus(void){
+	static const uint8_t tx8[8] = {0x10, 0x21, 0x32, 0x43, 0x54, 0x65, 0x76, 0x87};
+	static const uint16_t tx16[4] = {0x1234, 0x5678, 0x9ABC, 0xDEF0};
+	static uint8_t rx8[8], rx8b[8];
+	static uint16_t rx16[4];
+	const SPI_BusDevice_t bytes = { .nssPin = my_GPIO_PIN_12, .nssPort = my_GPIOB, .baudRate = FPCLK_DIV4,
+									.clockMode = SPI_CLOCK_MODE0, .frameSize = DFF_8BITS };
+	const SPI_BusDevice_t words = { .nssPin = my_GPIO_PIN_12, .nssPort = my_GPIOB, .baudRate = FPCLK_DIV8,
+									.clockMode = SPI_CLOCK_MODE3, .frameSize = DFF_16BITS };
+
+	CHECK(SPI_BUS_init(LOOP), "SPI_BUS_init");
+	int8_t a = SPI_BUS_addDevice(my_SPI2, &bytes);
+	int8_t b = SPI_BUS_addDevice(my_SPI2, &words);
+	CHECK(a == 0 && b == 1, "device handles (got %d %d)", a, b);
+
+	busChain[0] = (SPI_BusTransaction_t){ .device = b, .txBuf = tx16, .rxBuf = rx16, .len = 4, .callback = transferCallback };
+	busChain[1] = (SPI_BusTransaction_t){ .device = a, .txBuf = tx8, .rxBuf = rx8b, .len = 8, .callback = transferCallback };
+	busChain[2] = (SPI_BusTransaction_t){ .device = a, .txBuf = NULL, .rxBuf = NULL, .len = 8, .callback = transferCallback };
+	const SPI_BusTransaction_t first = { .device = a, .txBuf = tx8, .rxBuf = rx8, .len = 8,
+										 .callback = transferCallback, .context = busChain };
+
+	transferDone = 0;
+	transferFailed = false;
+	CHECK(SPI_BUS_submit(my_SPI2, &first), "SPI_BUS_submit");
+	CHECK(transferDone == 4 && !transferFailed && SPI_BUS_idle(my_SPI2), "bus ran 4 transactions (got %u)", transferDone);
+
+	//MISO echoes MOSI one byte late, across transactions and frame sizes
+	CHECK(memcmp(&rx8[1], tx8, sizeof(tx8) - 1) == 0, "bus 8-bit round trip");
+	bool wordsOk = (rx16[0] == (uint16_t)((tx8[7] << 8) | (tx16[0] >> 8)));
+	for(uint8_t i = 1; i < 4; i++) wordsOk &= (rx16[i] == (uint16_t)(((tx16[i - 1] & 0xFF) << 8) | (tx16[i] >> 8)));
+	CHECK(wordsOk, "bus 16-bit round trip (got %04X %04X)", rx16[0], rx16[1]);
+	CHECK(rx8b[0] == (tx16[3] & 0xFF) && memcmp(&rx8b[1], tx8, sizeof(tx8) - 1) == 0, "bus 8-bit after the 16-bit device");
+
+	SPI_BusStats_t stats = SPI_BUS_getStats(my_SPI2);
+	CHECK(stats.transactions == 4 && stats.errors == 0, "bus transactions/errors (got %lu/%lu)",
+		  (unsigned long)stats.transactions, (unsigned long)stats.errors);
+	CHECK(stats.cr1Writes == 3 && stats.cr1Skipped == 1, "CR1 rewritten only on device switches (got %lu/%lu)",
+		  (unsigned long)stats.cr1Writes, (unsigned long)stats.cr1Skipped);
+	CHECK(stats.queueHighWater == 2, "queued from the completion IRQ (high water %u)", stats.queueHighWater);
+}
+
+
+
+/*
+ * ------------------------------------------------------------
+ * Benchmarks
+ * ------------------------------------------------------------
+ */
+static void benchmark(uint32_t iterations){
+	uint8_t buffer[64];
+	uint64_t start;
+
+	printf("Benchmark (%lu iterations)\n", (unsigned long)iterations);
+
+	start = nowNs();
+	for(uint32_t i = 0; i < iterations; i++) (void)SPI_readReceivedData(GYRO, WHO_AM_I);
+	report("SPI_readReceivedData (1 reg)", start, iterations, 1);
+
+	start = nowNs();
+	for(uint32_t i = 0; i < iterations; i++) SPI_burstRead(GYRO, STATUS_REG, buffer, L3GD20_STATUS_XYZ_BURST_LEN);
+	report("SPI_burstRead (STATUS + XYZ)", start, iterations, L3GD20_STATUS_XYZ_BURST_LEN);
+
+	start = nowNs();
+	for(uint32_t i = 0; i < iterations; i++){
+		for(uint8_t r = 0; r < L3GD20_STATUS_XYZ_BURST_LEN; r++) buffer[r] = (uint8_t)SPI_readReceivedData(GYRO, (char)(STATUS_REG + r));
+	}
+	report("7 x SPI_readReceivedData", start, iterations, L3GD20_STATUS_XYZ_BURST_LEN);
+
+	start = nowNs();
+	for(uint32_t i = 0; i < iterations; i++) SPI_transfer8(LOOP, buffer, buffer, sizeof(buffer));
+	report("SPI_transfer8 (64 B)", start, iterations, sizeof(buffer));
+
+	start = nowNs();
+	for(uint32_t i = 0; i < iterations; i++) SPI_transfer16(LOOP, buffer, buffer, sizeof(buffer), SPI_PACK_BIG_ENDIAN);
+	report("SPI_transfer16 (64 B)", start, iterations, sizeof(buffer));
+}
+
+
+
+int main(int argc, char** argv){
+	uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 20000U;
+	uint8_t loopLast = 0xFF;
+	const HOST_SIM_SpiDevice_t loopback = { .select = NULL, .exchange = loopbackExchange, .context = &loopLast,
+											.nssPort = my_GPIOB, .nssPin = my_GPIO_PIN_12 };
+
+	HOST_SIM_reset();
+	busInit(GYRO);
+	busInit(LOOP);
+	L3GD20_MODEL_init(my_SPI1, my_GPIOE, my_GPIO_PIN_3, my_GPIOE, my_GPIO_PIN_1);
+	HOST_SIM_attachSpiDevice(my_SPI2, &loopback);
+
+	testRegisterAccess();
+	testInitAndBurst();
+	testFifoStream();
+	testTransfers();
+	testCrc(&loopback);
+	testBus();
+
+	HOST_SIM_SpiStats_t spi1 = HOST_SIM_getSpiStats(my_SPI1);
+	HOST_SIM_SpiStats_t spi2 = HOST_SIM_getSpiStats(my_SPI2);
+	CHECK(spi1.unselected == 0 && spi2.unselected == 0, "frames clocked with chip select high");
+	CHECK(spi1.overruns == 0 && spi2.overruns == 0, "receive overruns (SPI1 %lu, SPI2 %lu)",
+		  (unsigned long)spi1.overruns, (unsigned long)spi2.overruns);
+	printf("SPI1: %lu frames, %lu overruns  SPI2: %lu frames, %lu overruns\n",
+		   (unsigned long)spi1.frames, (unsigned long)spi1.overruns, (unsigned long)spi2.frames, (unsigned long)spi2.overruns);
+	printf("%s (%d failed)\n", failures ? "FAILED" : "All checks passed", failures);
+
+	if(iterations > 0) benchmark(iterations);
+	return failures;
+}
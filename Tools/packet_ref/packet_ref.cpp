@@ -0,0 +1,290 @@
+/*
+ * @file	packet_ref.cpp
+ * @brief	Host reference for the COBS + CRC32 packet link in Core/Src/packet.c
+ *
+ * 			Build:	gcc -std=c11 -O2 -Wall -I../../Core/Inc -c ../../Core/Src/packet_cobs.c
+ * 					g++ -std=c++17 -O2 -Wall -I../../Core/Inc -o packet_ref packet_ref.cpp packet_cobs.o
+ * 			Usage:	packet_ref vectors							check the codec against known vectors
+ * 					packet_ref encode SEQ TYPE [HEXPAYLOAD]		print one wire frame as hex
+ * 					packet_ref decode [capture.bin | -]			print every packet in a byte stream
+ *
+ * 			The CRC matches the STM32 CRC unit fed by CRC_computeBytes(): bytes are packed
+ * 			little-endian into 32-bit words with a zero-padded tail, which is the same as a
+ * 			byte-wise CRC-32/MPEG-2 over every word with its bytes reversed.
+ * 			COBS is not reimplemented: the firmware codec (Core/Src/packet_cobs.c) is linked in.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: dobao
+ */
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "packet_cobs.h"
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+/*
+ * ------------------------------------------------------------
+ * CRC-32/MPEG-2 (poly 0x04C11DB7, init 0xFFFFFFFF, no reflection, no final XOR)
+ * ------------------------------------------------------------
+ */
+uint32_t crc32Mpeg2(const Bytes& data){
+	uint32_t crc = 0xFFFFFFFFu;
+	for(uint8_t byte : data){
+		crc ^= static_cast<uint32_t>(byte) << 24;
+		for(int bit = 0; bit < 8; bit++) crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : (crc << 1);
+	}
+	return crc;
+}
+
+uint32_t crc32Stm32(const Bytes& data){
+	Bytes swapped;
+	for(size_t i = 0; i < data.size(); i += 4){
+		uint8_t word[4] = {0, 0, 0, 0};
+		for(size_t k = 0; k < 4 && i + k < data.size(); k++) word[k] = data[i + k];
+		swapped.insert(swapped.end(), {word[3], word[2], word[1], word[0]});
+	}
+	return crc32Mpeg2(swapped);
+}
+
+
+/*
+ * ------------------------------------------------------------
+ * COBS, thin wrappers around PACKET_cobsEncode()/PACKET_cobsDecode()
+ * ------------------------------------------------------------
+ */
+Bytes cobsEncode(const Bytes& in){
+	Bytes out(PACKET_COBS_MAX(in.size()));
+	out.resize(PACKET_cobsEncode(in.data(), static_cast<uint16_t>(in.size()), out.data()));
+	return out;
+}
+
+bool cobsDecode(const Bytes& in, Bytes& out, size_t outCap = PACKET_RAW_MAX){
+	out.assign(outCap, 0);
+	uint16_t outLen = 0;
+	if(!PACKET_cobsDecode(in.data(), static_cast<uint16_t>(in.size()), out.data(), static_cast<uint16_t>(outCap), &outLen)){
+		out.clear();
+		return false;
+	}
+	out.resize(outLen);
+	return true;
+}
+
+
+/*
+ * ------------------------------------------------------------
+ * Packet framing
+ * ------------------------------------------------------------
+ */
+Bytes buildFrame(uint8_t seq, uint8_t type, const Bytes& payload){
+	Bytes raw = {seq, type};
+	raw.insert(raw.end(), payload.begin(), payload.end());
+	uint32_t crc = crc32Stm32(raw);
+	for(int i = 0; i < 4; i++) raw.push_back(static_cast<uint8_t>(crc >> (8 * i)));
+
+	Bytes frame = cobsEncode(raw);
+	frame.push_back(0x00);
+	return frame;
+}
+
+std::string toHex(const Bytes& data){
+	std::string s;
+	char buf[4];
+	for(uint8_t b : data){
+		std::snprintf(buf, sizeof(buf), "%02X", b);
+		if(!s.empty()) s += ' ';
+		s += buf;
+	}
+	return s;
+}
+
+bool parseHex(const std::string& text, Bytes& out){
+	std::string digits;
+	for(char c : text) if(!std::isspace(static_cast<unsigned char>(c))) digits += c;
+	if(digits.size() % 2) return false;
+	for(size_t i = 0; i < digits.size(); i += 2){
+		char* end = nullptr;
+		std::string pair = digits.substr(i, 2);
+		long v = std::strtol(pair.c_str(), &end, 16);
+		if(*end != '\0') return false;
+		out.push_back(static_cast<uint8_t>(v));
+	}
+	return true;
+}
+
+
+/*
+ * ------------------------------------------------------------
+ * Known-answer vectors
+ * ------------------------------------------------------------
+ */
+int runVectors(){
+	int failures = 0;
+	auto check = [&](const char* name, bool ok){
+		std::printf("%-40s %s\n", name, ok ? "PASS" : "FAIL");
+		if(!ok) failures++;
+	};
+
+	//CRC-32/MPEG-2 catalogue check value
+	Bytes check9 = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	check("crc32/mpeg-2 \"123456789\"", crc32Mpeg2(check9) == 0x0376E6E7u);
+
+	//STM32 word packing: one word fed as 0x04030201 is MPEG-2 over 04 03 02 01
+	check("crc32/stm32 word packing", crc32Stm32({0x01, 0x02, 0x03, 0x04}) == crc32Mpeg2({0x04, 0x03, 0x02, 0x01}));
+	check("crc32/stm32 zero-padded tail", crc32Stm32({0x01, 0x02, 0x03, 0x04, 0x05}) ==
+										  crc32Stm32({0x01, 0x02, 0x03, 0x04, 0x05, 0x00, 0x00, 0x00}));
+
+	//COBS examples from the original Cheshire/Baker paper and common references
+	struct CobsVector{ const char* name; Bytes raw; Bytes enc; };
+	std::vector<CobsVector> cobs = {
+		{"cobs 00",          {0x00},                   {0x01, 0x01}},
+		{"cobs 00 00",       {0x00, 0x00},             {0x01, 0x01, 0x01}},
+		{"cobs 00 11 00",    {0x00, 0x11, 0x00},       {0x01, 0x02, 0x11, 0x01}},
+		{"cobs 11 22 00 33", {0x11, 0x22, 0x00, 0x33}, {0x03, 0x11, 0x22, 0x02, 0x33}},
+		{"cobs 11 22 33 44", {0x11, 0x22, 0x33, 0x44}, {0x05, 0x11, 0x22, 0x33, 0x44}},
+		{"cobs 11 00 00 00", {0x11, 0x00, 0x00, 0x00}, {0x02, 0x11, 0x01, 0x01, 0x01}},
+	};
+
+	Bytes run254, run254Enc = {0xFF};
+	for(int i = 1; i <= 254; i++){ run254.push_back(static_cast<uint8_t>(i)); run254Enc.push_back(static_cast<uint8_t>(i)); }
+	cobs.push_back({"cobs 01..FE (254 bytes)", run254, run254Enc});
+
+	Bytes run255 = run254, run255Enc = run254Enc;
+	run255.push_back(0xFF);
+	run255Enc.insert(run255Enc.end(), {0x02, 0xFF});
+	cobs.push_back({"cobs 01..FF (255 bytes)", run255, run255Enc});
+
+	for(const auto& v : cobs){
+		Bytes decoded;
+		check(v.name, cobsEncode(v.raw) == v.enc && cobsDecode(v.enc, decoded, 0xFFFF) && decoded == v.raw);
+	}
+
+	Bytes bad;
+	check("cobs rejects embedded zero", !cobsDecode({0x03, 0x11, 0x00}, bad));
+	check("cobs rejects overrun code", !cobsDecode({0x05, 0x11, 0x22}, bad));
+
+	//[02 41]*129 + 01 fits in PACKET_ENCODED_MAX but expands to 258 bytes, past rxRaw
+	Bytes oversize;
+	for(int i = 0; i < 129; i++) oversize.insert(oversize.end(), {0x02, 0x41});
+	oversize.push_back(0x01);
+	check("cobs oversize frame fits rx buffer", oversize.size() <= PACKET_ENCODED_MAX);
+	check("cobs rejects frame above PACKET_RAW_MAX", !cobsDecode(oversize, bad, PACKET_RAW_MAX));
+	check("cobs oversize frame decodes to 258", cobsDecode(oversize, bad, 0xFFFF) && bad.size() == 258);
+	check("cobs accepts frame of exactly outCap", cobsDecode(oversize, bad, 258) && bad.size() == 258);
+	check("cobs rejects implied zero past outCap", !cobsDecode({0x02, 0x41, 0x01}, bad, 1));
+
+	//Round trip every payload length through the full frame path
+	bool roundTrip = true;
+	for(size_t len = 0; len <= PACKET_MAX_PAYLOAD && roundTrip; len++){
+		Bytes payload;
+		for(size_t i = 0; i < len; i++) payload.push_back(static_cast<uint8_t>((i * 37) & 0xFF)); //Includes zeros
+		Bytes frame = buildFrame(static_cast<uint8_t>(len), 0x42, payload), raw;
+		frame.pop_back();
+		roundTrip = cobsDecode(frame, raw) && raw.size() == len + PACKET_OVERHEAD &&
+					Bytes(raw.begin() + 2, raw.end() - 4) == payload;
+	}
+	check("frame round trip, payload 0..250", roundTrip);
+
+	std::printf("%d failure(s)\n", failures);
+	return failures ? 1 : 0;
+}
+
+
+/*
+ * ------------------------------------------------------------
+ * Stream decoder (same rules as PACKET_rxChunk()/PACKET_processFrame())
+ * ------------------------------------------------------------
+ */
+int decodeStream(std::istream& in){
+	Bytes stream((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	Bytes frame, raw;
+	int expected = -1;
+	bool overflow = false;
+	size_t good = 0, crcErrors = 0, framingErrors = 0, overflows = 0, gaps = 0;
+
+	for(uint8_t byte : stream){
+		if(byte != 0){
+			if(frame.size() < PACKET_ENCODED_MAX) frame.push_back(byte);
+			else overflow = true;
+			continue;
+		}
+		if(overflow){
+			overflows++;
+			overflow = false;
+			frame.clear();
+			continue;
+		}
+		if(frame.empty()) continue;
+
+		if(!cobsDecode(frame, raw) || raw.size() < PACKET_OVERHEAD){
+			framingErrors++;
+		}else{
+			Bytes body(raw.begin(), raw.end() - 4);
+			uint32_t rxCrc = raw[raw.size() - 4] | (raw[raw.size() - 3] << 8) |
+							 (raw[raw.size() - 2] << 16) | (static_cast<uint32_t>(raw[raw.size() - 1]) << 24);
+			if(crc32Stm32(body) != rxCrc){
+				crcErrors++;
+			}else{
+				if(expected >= 0 && raw[0] != expected) gaps += static_cast<uint8_t>(raw[0] - expected);
+				expected = static_cast<uint8_t>(raw[0] + 1);
+				good++;
+				std::printf("seq=%3u type=0x%02X len=%3zu  %s\n", raw[0], raw[1], body.size() - 2,
+							toHex(Bytes(body.begin() + 2, body.end())).c_str());
+			}
+		}
+		frame.clear();
+	}
+
+	std::fprintf(stderr, "packet_ref: %zu packets, %zu CRC errors, %zu framing errors, %zu overflows, %zu missing\n",
+				 good, crcErrors, framingErrors, overflows, gaps);
+	return 0;
+}
+
+} //namespace
+
+
+
+int main(int argc, char** argv){
+	std::string cmd = (argc > 1) ? argv[1] : "vectors";
+
+	if(cmd == "vectors") return runVectors();
+
+	if(cmd == "encode" && argc >= 4){
+		Bytes payload;
+		if(argc >= 5 && !parseHex(argv[4], payload)){
+			std::fprintf(stderr, "packet_ref: bad hex payload\n");
+			return 2;
+		}
+		if(payload.size() > PACKET_MAX_PAYLOAD){
+			std::fprintf(stderr, "packet_ref: payload above %u bytes\n", PACKET_MAX_PAYLOAD);
+			return 2;
+		}
+		uint8_t seq = static_cast<uint8_t>(std::strtoul(argv[2], nullptr, 0));
+		uint8_t type = static_cast<uint8_t>(std::strtoul(argv[3], nullptr, 0));
+		std::printf("%s\n", toHex(buildFrame(seq, type, payload)).c_str());
+		return 0;
+	}
+
+	if(cmd == "decode"){
+		if(argc < 3 || std::string(argv[2]) == "-") return decodeStream(std::cin);
+		std::ifstream in(argv[2], std::ios::binary);
+		if(!in){
+			std::fprintf(stderr, "packet_ref: cannot open %s\n", argv[2]);
+			return 1;
+		}
+		return decodeStream(in);
+	}
+
+	std::fprintf(stderr, "usage: %s vectors | encode SEQ TYPE [HEXPAYLOAD] | decode [capture.bin | -]\n", argv[0]);
+	return 2;
+}